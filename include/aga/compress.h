@@ -0,0 +1,55 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#ifndef AGA_COMPRESS_H
+#define AGA_COMPRESS_H
+
+#include <aga/environment.h>
+#include <aga/result.h>
+
+/*
+ * NOTE: A plain LZSS -- the encoded stream is a sequence of groups of a flag
+ * 		 Byte followed by eight items, the flag's bits being taken LSB first.
+ * 		 A set bit marks a literal byte, a clear bit marks a little endian
+ * 		 16-bit back reference holding `distance - 1' in its low 12 bits
+ * 		 And `length - AGA_LZ_MIN_MATCH' in its high 4 bits. The stream has no
+ * 		 Header -- the decoded size is stored alongside it (`RawSize').
+ * 		 This keeps decoding cheap enough to do on the fly as data is read.
+ */
+
+#define AGA_LZ_WINDOW (4096)
+#define AGA_LZ_MIN_MATCH (3)
+#define AGA_LZ_MAX_MATCH (18)
+
+/* Worst case encoded size of `n' bytes -- all literals. */
+#define AGA_COMPRESS_BOUND(n) ((n) + (n) / 8 + 1)
+
+/* Output must have space for `AGA_COMPRESS_BOUND(size)' bytes. */
+enum aga_result aga_compress(const void*, aga_size_t, void*, aga_size_t*);
+
+/* Decodes incrementally so input can be fed through as it is read. */
+struct aga_decompressor {
+	aga_uchar_t* out;
+	aga_size_t size;
+	aga_size_t pos;
+
+	unsigned flags;
+	unsigned bits; /* Items remaining under the current flag byte. */
+
+	/* Set if the input ran out halfway through a back reference. */
+	aga_bool_t partial;
+	aga_uchar_t low;
+};
+
+enum aga_result aga_decompressor_new(
+		struct aga_decompressor*, void*, aga_size_t);
+
+enum aga_result aga_decompressor_feed(
+		struct aga_decompressor*, const void*, aga_size_t);
+
+/* Checks that the stream ended cleanly having filled the whole output. */
+enum aga_result aga_decompressor_end(struct aga_decompressor*);
+
+#endif
@@ -40,8 +40,20 @@ struct aga_config_node {
 extern const char* aga_config_debug_file;
 
 enum aga_result aga_config_new(void*, aga_size_t, struct aga_config_node*);
+
+/* As `aga_config_new' but parses text already in memory. */
+enum aga_result aga_config_new_buffer(
+		const void*, aga_size_t, struct aga_config_node*);
 enum aga_result aga_config_delete(struct aga_config_node*);
 
+#ifdef AGA_DEVBUILD
+/*
+ * Parses the file at `path' a number of times from a stream and then from
+ * Memory, and logs how long the parser itself took for each.
+ */
+enum aga_result aga_config_bench(const char*, aga_size_t);
+#endif
+
 aga_bool_t aga_config_variable(
 		const char*, struct aga_config_node*, enum aga_config_node_type, void*);
 
@@ -29,6 +29,12 @@ enum aga_result aga_draw_pop(void);
 
 enum aga_result aga_draw_fidelity(aga_bool_t);
 
+/*
+ * Whether GL 1.1 features (vertex arrays, texture objects) are available --
+ * We still run against 1.0 implementations. Needs a current context.
+ */
+aga_bool_t aga_draw_have_gl11(void);
+
 /* NOTE: Outputs pointer to static string storage. */
 enum aga_result aga_renderer_string(const char**);
 
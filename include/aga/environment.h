@@ -63,6 +63,12 @@
 # if __has_include(<dirent.h>)
 #  define AGA_HAVE_DIRENT
 # endif
+# if __has_include(<sys/mman.h>)
+#  define AGA_HAVE_SYS_MMAN
+# endif
+# if __has_include(<pthread.h>)
+#  define AGA_HAVE_PTHREAD
+# endif
 #endif
 
 /* Epsilon when comparing floats in transforms. */
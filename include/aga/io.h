@@ -18,6 +18,22 @@
 # define AGA_HAVE_SPAWN
 #endif
 
+#if defined(AGA_HAVE_SYS_MMAN) && defined(AGA_HAVE_UNISTD)
+# define AGA_NIXMAP
+# define AGA_HAVE_MAP
+#elif defined(_WIN32)
+# define AGA_WINMAP
+# define AGA_HAVE_MAP
+#endif
+
+#if defined(AGA_HAVE_UNISTD)
+# define AGA_NIXPREAD
+# define AGA_HAVE_PREAD
+#elif defined(_WIN32)
+# define AGA_WINPREAD
+# define AGA_HAVE_PREAD
+#endif
+
 #define AGA_COPY_ALL ((aga_size_t) -1)
 
 enum aga_file_attribute_type {
@@ -68,9 +84,27 @@ enum aga_result aga_file_attribute(
 
 enum aga_result aga_file_read(void*, aga_size_t, void*);
 
+/*
+ * Reads `size' bytes from an absolute offset in `fp' without using or moving
+ * The stdio stream position.
+ * NOTE: Under Windows this moves the underlying OS file pointer, and without
+ * 		 `AGA_HAVE_PREAD' this falls back to a seek and read under a lock. In
+ * 		 Either case `fp' should be a handle dedicated to offset reads.
+ */
+enum aga_result aga_file_read_offset(void*, aga_size_t, void*, aga_size_t);
+
 /* TODO: File writes should be devbuild only. */
 enum aga_result aga_file_print_characters(int, aga_size_t, void*);
 
+#ifdef AGA_HAVE_MAP
+/*
+ * Maps the first `size' bytes of an open file read-only. The mapping remains
+ * Valid after the file is closed.
+ */
+enum aga_result aga_file_map(void*, aga_size_t, void**);
+enum aga_result aga_file_unmap(void*, aga_size_t);
+#endif
+
 #ifdef AGA_HAVE_SPAWN
 enum aga_result aga_process_spawn(const char*, char**, const char*);
 #endif
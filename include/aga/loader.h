@@ -0,0 +1,90 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#ifndef AGA_LOADER_H
+#define AGA_LOADER_H
+
+#include <aga/environment.h>
+#include <aga/result.h>
+
+#if defined(AGA_HAVE_PTHREAD)
+# define AGA_NIXTHREAD
+# define AGA_HAVE_THREADS
+#elif defined(_WIN32)
+# define AGA_WINTHREAD
+# define AGA_HAVE_THREADS
+#endif
+
+struct aga_resource;
+struct aga_resource_pack;
+
+/*
+ * Invoked from `aga_resource_loader_poll' (i.e. on the main thread). On
+ * Success the resource has been acquired on behalf of the callee.
+ */
+typedef void (*aga_resource_callback_t)(
+		struct aga_resource*, enum aga_result, void*);
+
+struct aga_resource_request {
+	struct aga_resource* resource;
+	aga_resource_callback_t callback;
+	void* pass;
+
+	/* Written by the worker. */
+	void* data;
+	enum aga_result result;
+
+	struct aga_resource_request* next;
+};
+
+/*
+ * NOTE: Requests are serviced on a worker thread using positional reads
+ * 		 (`aga_resource_read') so the main thread's stream position is never
+ * 		 Disturbed. Where we don't have threads requests are serviced synchronously
+ * 		 During `aga_resource_loader_poll'.
+ */
+struct aga_resource_loader {
+	struct aga_resource_pack* pack;
+
+	struct aga_resource_request* pending;
+	struct aga_resource_request* pending_tail;
+	struct aga_resource_request* complete;
+	struct aga_resource_request* complete_tail;
+
+	aga_size_t outstanding; /* Requests which are yet to be dispatched. */
+
+	aga_bool_t die;
+	void* sync; /* Platform thread state. */
+};
+
+enum aga_result aga_resource_loader_new(
+		struct aga_resource_loader*, struct aga_resource_pack*);
+
+/* Undispatched requests are discarded without calling back. */
+enum aga_result aga_resource_loader_delete(struct aga_resource_loader*);
+
+/*
+ * Queues a load of `path'. If the resource is already resident the callback
+ * Is invoked before this returns.
+ */
+enum aga_result aga_resource_request(
+		struct aga_resource_loader*, const char*, aga_resource_callback_t,
+		void*);
+
+/*
+ * Withdraws one undispatched request made with `callback' and `pass' without
+ * Calling back. Gives `AGA_RESULT_MISSING_KEY' if there's none left waiting
+ * (i.e. it's already being serviced or has completed).
+ */
+enum aga_result aga_resource_cancel(
+		struct aga_resource_loader*, aga_resource_callback_t, void*);
+
+/* Installs completed loads and runs their callbacks. */
+enum aga_result aga_resource_loader_poll(struct aga_resource_loader*);
+
+/* Blocks until every outstanding request has been dispatched. */
+enum aga_result aga_resource_loader_wait(struct aga_resource_loader*);
+
+#endif
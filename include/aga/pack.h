@@ -11,12 +11,92 @@
 #include <aga/result.h>
 
 #define AGA_PACK_MAGIC (0xA6AU)
+#define AGA_PACK_DIRECTORY_MAGIC (0xA6EU)
+#define AGA_SCENE_MAGIC (0xA66U)
+
+/* Default bytes of unreferenced resource data kept around for reuse. */
+#define AGA_RESOURCE_CACHE_BUDGET (16 * 1024 * 1024)
 
 struct aga_resource_pack;
 
+enum aga_resource_encoding {
+	AGA_ENCODING_NONE,
+	AGA_ENCODING_LZSS /* See `aga/compress.h'. */
+};
+
+/*
+ * NOTE: Packs with `AGA_PACK_DIRECTORY_MAGIC' are laid out as:
+ * 		 - `struct aga_resource_pack_header'.
+ * 		 - `struct aga_resource_pack_directory'.
+ * 		 - `conf_size' bytes of SGML config tree (as in legacy packs).
+ * 		 - `len' x `struct aga_resource_pack_entry'.
+ * 		 - `strings' bytes of NUL-terminated resource paths.
+ * 		 - `cells' x `struct aga_resource_pack_cell'.
+ * 		 - Resource data.
+ * 		 Legacy packs with `AGA_PACK_MAGIC' have only the config tree.
+ */
 struct aga_resource_pack_header {
+	aga_uint_t size; /* Size of everything between this and resource data. */
+	aga_uint_t magic;
+};
+
+struct aga_resource_pack_directory {
+	aga_uint_t len;
+	aga_uint_t strings;
+	aga_uint_t conf_size;
+	aga_uint_t cells;
+};
+
+struct aga_resource_pack_entry {
+	aga_uint_t name; /* Offset into string pool. */
+	aga_uint_t offset; /* Offset into pack data fields. */
 	aga_uint_t size;
+	aga_uint_t conf; /* Offset of this entry's `<item>' in the config tree. */
+	aga_uint_t conf_size;
+	aga_uint_t encoding; /* `enum aga_resource_encoding'. */
+	aga_uint_t raw_size; /* Decoded size if encoded, otherwise `size'. */
+	aga_uint_t hash; /* Changes whenever the entry's content could. */
+};
+
+/*
+ * NOTE: A cell is a contiguous run of entries (and so of data) which belong
+ * 		 To one square of the world -- the build orders each cell's objects,
+ * 		 Models and textures together so a cell can be streamed in a single
+ * 		 Forward read. Cells are sorted on `x' and then `z'.
+ */
+struct aga_resource_pack_cell {
+	aga_sint_t x;
+	aga_sint_t z;
+	aga_uint_t first; /* Index of the cell's first entry. */
+	aga_uint_t count;
+};
+
+/*
+ * NOTE: A scene is a single pack entry carrying a set of objects and
+ * 		 Everything they draw with back-to-back, so a level can be brought
+ * 		 In with one read rather than a seek per object, model and texture.
+ * 		 Laid out as:
+ * 		 - `struct aga_scene_header'.
+ * 		 - `len' x `struct aga_scene_entry' -- the first `objects' of which
+ * 		   Are the scene's objects.
+ * 		 - `strings' bytes of NUL-terminated resource paths.
+ * 		 - Each member's metadata (as in the pack config tree) and data.
+ * 		 Offsets are from the start of the scene.
+ */
+struct aga_scene_header {
 	aga_uint_t magic;
+	aga_uint_t objects;
+	aga_uint_t len;
+	aga_uint_t strings;
+};
+
+struct aga_scene_entry {
+	aga_uint_t name; /* Offset into string pool. */
+	aga_uint_t offset;
+	aga_uint_t size;
+	aga_uint_t conf;
+	aga_uint_t conf_size;
+	aga_uint_t hash; /* The member's `hash' in the pack it was built for. */
 };
 
 struct aga_resource {
@@ -24,27 +104,86 @@ struct aga_resource {
 	aga_size_t offset; /* Offset into pack data fields, not `data' member. */
 
 	void* data;
-	aga_size_t size;
+	aga_size_t size; /* Size of `data' -- i.e. after decoding. */
+
+	/*
+	 * NOTE: Encoded resources are decoded into their own allocation on load
+	 * 		 And can't be streamed or read positionally.
+	 */
+	enum aga_resource_encoding encoding;
+	aga_size_t stored_size; /* Bytes occupied in the pack. */
+	aga_uint_t hash; /* From the pack directory -- 0 in legacy packs. */
 
 	struct aga_resource_pack* pack;
 
+	const char* path;
+
+	/* Use `aga_resource_conf' rather than reading `conf' directly. */
 	struct aga_config_node* conf;
+	aga_size_t conf_offset; /* Absolute offset into the pack. */
+	aga_size_t conf_size;
+	struct aga_config_node conf_root; /* Owns `conf' for directory packs. */
+
+	/* Links in the pack's eviction list while unreferenced and resident. */
+	struct aga_resource* lru_prev;
+	struct aga_resource* lru_next;
 };
 
 struct aga_resource_pack {
+	const char* path;
 	void* fp;
 	aga_size_t size;
 	aga_size_t data_offset;
 
-	/* TODO: This should eventually be a hashmap. */
+	/*
+	 * NOTE: If non-null the whole pack is mapped read-only here and resource
+	 * 		 Data points directly into the mapping, otherwise resources are
+	 * 		 Read into their own allocations. `fp' is kept open either way for
+	 * 		 Stream consumers.
+	 */
+	void* map;
+
+	/*
+	 * NOTE: A second handle reserved for `aga_resource_read' -- positional
+	 * 		 Reads never see or move the stream position of `fp', so they are
+	 * 		 Safe to issue from the loader thread (Given `AGA_HAVE_PREAD').
+	 */
+	void* read_fp;
+
 	struct aga_resource* db;
 	aga_size_t len; /* Alias for `pack->root.children->len'. */
 
+	/*
+	 * NOTE: Open-addressed table of `db' entries keyed on path. Always a power
+	 * 		 Of two in size and never more than half full so probe sequences
+	 * 		 Stay short and always terminate on an empty slot.
+	 */
+	struct aga_resource** index;
+	aga_size_t index_len;
+
+	void* directory; /* Entry table and string pool for directory packs. */
+
+	/* Points into `directory' -- empty for packs without a world layout. */
+	struct aga_resource_pack_cell* cells;
+	aga_size_t cell_count;
+
+	/*
+	 * NOTE: Unreferenced resources keep their data until the sweep finds
+	 * 		 More than `budget' bytes resident, at which point the least
+	 * 		 Recently released are evicted first. `lru_head' is the most
+	 * 		 Recently released. Data pointing into a mapping isn't ours and
+	 * 		 Is never counted or evicted.
+	 */
+	aga_size_t budget;
+	aga_size_t resident; /* Bytes of resource data we have allocated. */
+	struct aga_resource* lru_head;
+	struct aga_resource* lru_tail;
+
 #ifndef NDEBUG
 	aga_size_t outstanding_refs;
 #endif
 
-	struct aga_config_node root;
+	struct aga_config_node root; /* Only populated for legacy packs. */
 };
 
 /*
@@ -57,20 +196,72 @@ extern struct aga_resource_pack* aga_global_pack;
 enum aga_result aga_resource_pack_new(const char*, struct aga_resource_pack*);
 enum aga_result aga_resource_pack_delete(struct aga_resource_pack*);
 
+enum aga_result aga_resource_pack_lookup_raw(
+		struct aga_resource_pack*, const char*, struct aga_resource**);
+
+/* Just wraps `aga_resource_pack_lookup_raw' with verbose EH. */
 enum aga_result aga_resource_pack_lookup(
 		struct aga_resource_pack*, const char*, struct aga_resource**);
 
+/* Gives `AGA_RESULT_MISSING_KEY' if the pack has no such cell. */
+enum aga_result aga_resource_pack_cell(
+		struct aga_resource_pack*, aga_sint_t, aga_sint_t,
+		struct aga_resource_pack_cell**);
+
+/* Evicts unreferenced resources until the pack is within its budget. */
 enum aga_result aga_resource_pack_sweep(struct aga_resource_pack*);
 
 /* Also counts as an acquire - i.e. initial refcount is 1. */
 enum aga_result aga_resource_new(
 		struct aga_resource_pack*, const char*, struct aga_resource**);
 
+/* Encoded resources can't be streamed and give `AGA_RESULT_BAD_OP'. */
 enum aga_result aga_resource_stream(
 		struct aga_resource_pack*, const char*, void**, aga_size_t*);
 
 enum aga_result aga_resource_seek(struct aga_resource*, void**);
 
+/*
+ * Reads `size' bytes from `offset' into the resource's data without using any
+ * Shared stream position. Reads extending past the end of the resource give
+ * `AGA_RESULT_EOF' and leave the output undefined. Encoded resources give
+ * `AGA_RESULT_BAD_OP'.
+ */
+enum aga_result aga_resource_read(
+		struct aga_resource*, aga_size_t, void*, aga_size_t);
+
+/*
+ * Reads (and decodes) a resource's data into a new buffer without touching
+ * The resource itself. For unencoded resources in mapped packs this instead
+ * Points into the mapping and must not be freed.
+ */
+enum aga_result aga_resource_load(struct aga_resource*, void**);
+
+/*
+ * Installs data from `aga_resource_load' as the resource's own. Takes
+ * Ownership of the data and discards it if the resource is already resident.
+ * The caller should acquire the resource straight after.
+ */
+enum aga_result aga_resource_adopt(struct aga_resource*, void*);
+
+/* Frees data from `aga_resource_load' which is not going to be adopted. */
+void aga_resource_discard(struct aga_resource*, void*);
+
+/*
+ * Gets the entry's metadata node (`Offset', `Size', `Width' etc.), parsing it
+ * From the pack on first use. Moves the pack stream position.
+ */
+enum aga_result aga_resource_conf(
+		struct aga_resource*, struct aga_config_node**);
+
+/*
+ * Makes every member of a resident scene resident in turn, along with its
+ * Metadata, so nothing it names goes back to the pack. Members which are
+ * Already resident are left be. Gives `AGA_RESULT_BAD_PARAM' for malformed
+ * Scenes.
+ */
+enum aga_result aga_resource_scene(struct aga_resource*);
+
 /*
  * NOTE: You should ensure that you acquire after any potential error
  * 		 Conditions during object init, and before any potential error
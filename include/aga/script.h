@@ -19,6 +19,8 @@ struct aga_sound_device;
 struct aga_window_device;
 struct aga_window;
 struct aga_resource_pack;
+struct aga_resource_loader;
+struct aga_zone;
 struct aga_buttons;
 
 struct aga_script_userdata {
@@ -30,6 +32,8 @@ struct aga_script_userdata {
 	struct aga_window_device* window_device;
 	struct aga_window* window;
 	struct aga_resource_pack* resource_pack;
+	struct aga_resource_loader* resource_loader; /* Null if unavailable. */
+	struct aga_zone* zone; /* Null if unavailable. */
 	struct aga_buttons* buttons;
 	aga_ulong_t* dt;
 };
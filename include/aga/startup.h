@@ -15,6 +15,10 @@ struct aga_settings {
 #ifdef AGA_DEVBUILD
 	aga_bool_t compile;
 	const char* build_file;
+	aga_size_t jobs; /* Concurrent conversions during a build. */
+
+	const char* bench_file; /* Config file to time parses of -- see `-b'. */
+	aga_size_t bench_runs;
 #endif
 
 	const char* title;
@@ -37,6 +41,11 @@ struct aga_settings {
 
 	aga_bool_t mipmap_default;
 
+	aga_size_t cache_budget;
+
+	float zone_cell_size;
+	aga_size_t zone_radius;
+
 	float fov;
 
 	aga_bool_t verbose;
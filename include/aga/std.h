@@ -69,6 +69,9 @@
 # ifdef AGA_HAVE_DIRENT
 #  include <dirent.h>
 # endif
+# ifdef AGA_HAVE_SYS_MMAN
+#  include <sys/mman.h>
+# endif
 # ifdef _WIN32
 #  include <io.h>
 #  include <direct.h>
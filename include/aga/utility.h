@@ -55,6 +55,9 @@ aga_bool_t aga_streql(const char*, const char*);
 aga_bool_t aga_strneql(const char*, const char*, aga_size_t);
 aga_size_t aga_strlen(const char*);
 
+/* NOTE: Not stable across versions - don't write this out to disk. */
+aga_size_t aga_strhash(const char*);
+
 aga_slong_t aga_strtol(const char*);
 double aga_strtod(const char*);
 
@@ -0,0 +1,71 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#ifndef AGA_ZONE_H
+#define AGA_ZONE_H
+
+#include <aga/environment.h>
+#include <aga/result.h>
+
+/* World units along each side of a cell if the project doesn't say. */
+#define AGA_ZONE_CELL_SIZE (64.0f)
+
+/* Cells kept resident either side of the camera's own. */
+#define AGA_ZONE_RADIUS (1)
+
+struct aga_resource_pack;
+struct aga_resource_pack_cell;
+struct aga_resource_loader;
+
+struct aga_zone;
+
+struct aga_zone_cell {
+	struct aga_zone* zone;
+	struct aga_resource_pack_cell* cell;
+	aga_bool_t wanted;
+};
+
+/*
+ * NOTE: The zone keeps every pack cell within `radius' cells of the camera
+ * 		 (Counting diagonals) referenced -- entering a cell's range queues
+ * 		 Its entries with the loader in pack order and leaving it drops our
+ * 		 References, after which the cache budget decides when the data
+ * 		 Actually goes. Cells are walked in pack order too so a move which
+ * 		 Brings in several cells still only ever reads forward.
+ */
+struct aga_zone {
+	struct aga_resource_pack* pack;
+	struct aga_resource_loader* loader;
+
+	float cell_size;
+	aga_size_t radius;
+
+	aga_bool_t placed;
+	aga_sint_t x; /* The camera's cell. */
+	aga_sint_t z;
+
+	struct aga_zone_cell* cells; /* One per pack cell. */
+	aga_bool_t* held; /* One per pack entry -- whether we have a ref. */
+	aga_size_t pending; /* Requests yet to call back. */
+};
+
+enum aga_result aga_zone_new(
+		struct aga_zone*, struct aga_resource_pack*,
+		struct aga_resource_loader*, float, aga_size_t);
+
+/* Waits out any loads still in flight before letting go of everything. */
+enum aga_result aga_zone_delete(struct aga_zone*);
+
+/* Recentres the zone on a world position, loading and unloading cells. */
+enum aga_result aga_zone_update(struct aga_zone*, float, float);
+
+/* Gets the pack cell (if any) covering a world position. */
+enum aga_result aga_zone_cell(
+		struct aga_zone*, float, float, struct aga_resource_pack_cell**);
+
+/* Whether a world position lies inside the zone's current range. */
+aga_bool_t aga_zone_resident(struct aga_zone*, float, float);
+
+#endif
@@ -38,6 +38,9 @@ aga_bool_t agan_settransmat(struct py_object*, aga_bool_t);
 struct py_object* agan_scriptconf(
 		struct aga_config_node*, aga_bool_t, struct py_object*);
 
+/* Converts a single config value to its Python equivalent. */
+struct py_object* agan_scriptvalue(struct aga_config_node*);
+
 aga_bool_t aga_arg_list(const struct py_object*, enum py_type);
 aga_bool_t aga_vararg_list(const struct py_object*, enum py_type, aga_size_t);
 aga_bool_t aga_vararg_list_typed(
@@ -8,6 +8,8 @@
 
 #include <agan/agan.h>
 
+#include <aga/config.h>
+
 /*
  * Defines the world-object type used by script glue. Game objects typically
  * Consist of a world-object and behaviours ascribed in script land. We should
@@ -22,6 +24,56 @@ struct aga_vertex {
 	float pos[3];
 };
 
+/*
+ * Version 3 model vertices -- colour is taken from the object so isn't
+ * Stored. Followed in the artefact by the index buffer.
+ */
+struct aga_model_vertex {
+	float uv[2];
+	float norm[3];
+	float pos[3];
+};
+
+/*
+ * Version 4 model vertices -- positions and UVs are quantised against the
+ * Model's extents (`MinX' etc. and `MinU' etc. in its conf) and normals are
+ * Scaled to signed bytes. Expanded back to `aga_model_vertex' on load.
+ */
+struct aga_packed_vertex {
+	aga_ushort_t pos[3];
+	aga_schar_t norm[3];
+	aga_uchar_t pad;
+	aga_ushort_t uv[2];
+};
+
+/*
+ * Models can carry simplified LOD levels as extra index buffers over the
+ * Same vertices (`Lods' and `Lod1Indices' etc. in their conf).
+ */
+#define AGA_MODEL_LODS (2)
+
+/*
+ * How texels are stored in the pack -- see `aga_texture_formats' for the
+ * Names used in conf. Everything but `AGA_FORMAT_AUTO' is also a storage
+ * Format, paletted textures lead with a 256 entry RGBA palette.
+ */
+enum aga_texture_format {
+	AGA_FORMAT_AUTO = 0, /* Build only -- picked from the image's content. */
+	AGA_FORMAT_RGBA8888,
+	AGA_FORMAT_RGB888,
+	AGA_FORMAT_RGB565,
+	AGA_FORMAT_RGBA4444,
+	AGA_FORMAT_LUMINANCE,
+	AGA_FORMAT_PALETTED
+};
+
+#define AGA_PALETTE_SIZE (256 * 4)
+
+extern const char* aga_texture_formats[AGA_FORMAT_PALETTED + 1];
+
+/* Bytes per texel as stored. */
+aga_size_t aga_texture_format_size(enum aga_texture_format);
+
 struct agan_lightdata {
 	float ambient[4];
 	float diffuse[4];
@@ -42,13 +94,33 @@ struct agan_lightdata {
 };
 
 /*
- * TODO: Central object/light registry and distribute handles. Spatializing
- * 		 This makes it easier to do streaming/chunking and means we can ensure
- * 		 Sequential reads -- which is super important if we want to run off CD
- * 		 Media. Maybe add a separate file type in packs which represent
- * 		 Contiguous interleaved objects to avoid needing to seek over
- * 		 Intermediate structures or rely on pack ordering at an application
- * 		 Maintainer level.
+ * NOTE: Models and textures are shared between every object using the same
+ * 		 Pack path (and, for textures, the same sampling settings) -- each is
+ * 		 Built into one GL name the first time it's used and freed once the
+ * 		 Last object using it goes away.
+ */
+struct agan_shared {
+	char* path;
+	aga_uint_t flags; /* Must also match to share, see `agan_mkobj_texture'. */
+
+	/*
+	 * A display list for models, for textures a texture object where we have
+	 * GL 1.1 or else a display list which uploads the texture.
+	 */
+	aga_uint_t name;
+	aga_size_t refcount;
+
+	float min_extent[3];
+	float max_extent[3];
+
+	struct agan_shared* next;
+};
+
+/*
+ * NOTE: Objects built with `CellX'/`CellZ' are packed contiguously with the
+ * 		 Models and textures of their cell and streamed in around the camera
+ * 		 (See `aga/zone.h') so large worlds only ever read the pack forward.
+ * TODO: Distribute handles from the registry rather than raw pointers.
  */
 struct agan_object {
 	struct py_object* transform;
@@ -58,12 +130,66 @@ struct agan_object {
 
 	char* modelpath;
 
-	aga_uint_t drawlist;
+	struct agan_shared* model;
+	struct agan_shared* texture;
+
+	/* Drawn in place of `model' past the matching distance from the eye. */
+	struct agan_shared* lods[AGA_MODEL_LODS];
+	float lod_distance[AGA_MODEL_LODS];
+	struct agan_shared* billboard;
+	float billboard_distance;
+
 	float min_extent[3];
 	float max_extent[3];
+
+	/* Every live object is registered for `agan_putvis'. */
+	struct agan_object* prev;
+	struct agan_object* next;
+
+	/* World space bounds as of the transform in `vis_trans'. */
+	aga_bool_t vis_valid;
+	double vis_trans[9];
+	float world_min[3];
+	float world_max[3];
+
+	/*
+	 * Parsed on first use by `agan_getobjconf' and held until dropped --
+	 * Edits made to it (i.e. by the editor) stick until then.
+	 */
+	struct aga_config_node conf;
+	aga_bool_t conf_valid;
+	aga_uint_t conf_generation; /* Bumped each time `conf' is dropped. */
 };
 
-enum aga_result agan_getobjconf(struct agan_object*, struct aga_config_node*);
+/*
+ * NOTE: A batch is static scenery baked down to one display list per texture
+ * 		 -- each member's transform is applied to its vertices up front so
+ * 		 Drawing the lot costs a bind and a list call per texture. The batch
+ * 		 Holds its own references so members can be killed once batched.
+ */
+struct agan_batch_part {
+	struct agan_shared* texture;
+	aga_uint_t name;
+};
+
+struct agan_batch {
+	struct agan_batch_part* parts;
+	aga_size_t len;
+
+	/* Members' models -- those we couldn't bake are called from the lists. */
+	struct agan_shared** models;
+	aga_size_t model_count;
+
+	float min_extent[3];
+	float max_extent[3];
+};
+
+/* The tree given back stays owned by the object. */
+enum aga_result agan_getobjconf(struct agan_object*, struct aga_config_node**);
+
+/* Drops cached conf so that it's reparsed from the pack on next use. */
+enum aga_result agan_dropobjconf(struct agan_object*);
+enum aga_result agan_dropobjconfs(void);
 
 enum aga_result agan_obj_register(struct py_env*);
 
@@ -79,13 +205,50 @@ struct py_object* agan_putobj(
 struct py_object* agan_killobj(
 		struct py_env* env, struct py_object*, struct py_object*);
 
+/*
+ * NOTE: Makes every object in a scene (see `aga/pack.h') and gives back the
+ * 		 List of them -- the scene is read once and nothing it names is read
+ * 		 From the pack again while it stays cached.
+ */
+struct py_object* agan_loadscene(
+		struct py_env* env, struct py_object*, struct py_object*);
+
 struct py_object* agan_objtrans(
 		struct py_env* env, struct py_object*, struct py_object*);
 
 struct py_object* agan_objconf(
 		struct py_env* env, struct py_object*, struct py_object*);
 
+struct py_object* agan_dropconf(
+		struct py_env* env, struct py_object*, struct py_object*);
+
+/*
+ * NOTE: A prop is a conf lookup resolved once up front -- `getprop' only
+ * 		 Walks the tree again if the object's conf has been dropped since.
+ * 		 Props must be killed before the object they were made from.
+ */
+struct py_object* agan_mkprop(
+		struct py_env* env, struct py_object*, struct py_object*);
+
+struct py_object* agan_getprop(
+		struct py_env* env, struct py_object*, struct py_object*);
+
+struct py_object* agan_killprop(
+		struct py_env* env, struct py_object*, struct py_object*);
+
 struct py_object* agan_objind(
 		struct py_env* env, struct py_object*, struct py_object*);
 
+struct py_object* agan_putvis(
+		struct py_env* env, struct py_object*, struct py_object*);
+
+struct py_object* agan_mkbatch(
+		struct py_env* env, struct py_object*, struct py_object*);
+
+struct py_object* agan_putbatch(
+		struct py_env* env, struct py_object*, struct py_object*);
+
+struct py_object* agan_killbatch(
+		struct py_env* env, struct py_object*, struct py_object*);
+
 #endif
@@ -22,4 +22,29 @@ struct py_object* agan_die(
 struct py_object* agan_dt(
 		struct py_env*, struct py_object*, struct py_object*);
 
+/*
+ * NOTE: A completed `prefetch' holds a reference to the resource until a
+ * 		 Matching `unfetch' -- which withdraws the prefetch instead if it's
+ * 		 Still in flight. Unfetching what wasn't prefetched is an error.
+ */
+struct py_object* agan_prefetch(
+		struct py_env*, struct py_object*, struct py_object*);
+
+struct py_object* agan_fetched(
+		struct py_env*, struct py_object*, struct py_object*);
+
+struct py_object* agan_unfetch(
+		struct py_env*, struct py_object*, struct py_object*);
+
+/* Forgets every prefetch -- for when the pack they were made in goes away. */
+void agan_dropfetches(void);
+
+/*
+ * NOTE: Lists the pack entries streamed with the cell covering a world XZ
+ * 		 Position -- empty outside any cell. Scripts can make objects from
+ * 		 These as `fetched' reports them resident.
+ */
+struct py_object* agan_getcell(
+		struct py_env*, struct py_object*, struct py_object*);
+
 #endif
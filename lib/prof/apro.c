@@ -97,6 +97,8 @@ const char* apro_section_name(enum apro_section section) {
 		case APRO_CEVAL_CODE_EVAL: return "CEVAL";
 		case APRO_CEVAL_CODE_EVAL_FALLING: return "CEVAL_FALLING";
 		case APRO_RES_SWEEP: return "RES_SWEEP";
+		case APRO_RES_POLL: return "RES_POLL";
+		case APRO_CONF_PARSE: return "CONF_PARSE";
 		case APRO_SCRIPTGLUE_GETKEY: return "AGAN_GETKEY";
 		case APRO_SCRIPTGLUE_GETMOTION: return "AGAN_GETMOTION";
 		case APRO_SCRIPTGLUE_SETCURSOR: return "AGAN_SETCURSOR";
@@ -114,12 +116,21 @@ const char* apro_section_name(enum apro_section section) {
 		case APRO_SCRIPTGLUE_GETCONF: return "AGAN_GETCONF";
 		case APRO_SCRIPTGLUE_LOG: return "AGAN_LOG";
 		case APRO_SCRIPTGLUE_DIE: return "AGAN_DIE";
+		case APRO_SCRIPTGLUE_PREFETCH: return "AGAN_PREFETCH";
+		case APRO_SCRIPTGLUE_FETCHED: return "AGAN_FETCHED";
+		case APRO_SCRIPTGLUE_UNFETCH: return "AGAN_UNFETCH";
+		case APRO_SCRIPTGLUE_GETCELL: return "AGAN_GETCELL";
 		case APRO_SCRIPTGLUE_MKOBJ: return "AGAN_MKOBJ";
 		case APRO_SCRIPTGLUE_INOBJ: return "AGAN_INOBJ";
 		case APRO_SCRIPTGLUE_PUTOBJ: return "AGAN_PUTOBJ";
 		case APRO_SCRIPTGLUE_KILLOBJ: return "AGAN_KILLOBJ";
+		case APRO_SCRIPTGLUE_LOADSCENE: return "AGAN_LOADSCENE";
 		case APRO_SCRIPTGLUE_OBJTRANS: return "AGAN_OBJTRANS";
 		case APRO_SCRIPTGLUE_OBJCONF: return "AGAN_OBJCONF";
+		case APRO_SCRIPTGLUE_GETPROP: return "AGAN_GETPROP";
+		case APRO_SCRIPTGLUE_MKBATCH: return "AGAN_MKBATCH";
+		case APRO_SCRIPTGLUE_PUTBATCH: return "AGAN_PUTBATCH";
+		case APRO_SCRIPTGLUE_PUTVIS: return "AGAN_PUTVIS";
 		case APRO_SCRIPTGLUE_BITAND: return "AGAN_BITAND";
 		case APRO_SCRIPTGLUE_BITSHL: return "AGAN_BITSHL";
 		case APRO_SCRIPTGLUE_RANDNORM: return "AGAN_RANDNORM";
@@ -31,6 +31,9 @@ enum apro_section {
 	APRO_CEVAL_CODE_EVAL_FALLING, /* Falling edge for ceval code eval. */
 
 	APRO_RES_SWEEP, /* Resource pack sweep. */
+	APRO_RES_POLL, /* Resource loader completion dispatch. */
+
+	APRO_CONF_PARSE, /* Config tree parsing (object conf, scenes etc.). */
 
 	/* Scriptglue calls */
 	APRO_SCRIPTGLUE_GETKEY,
@@ -52,13 +55,22 @@ enum apro_section {
 	APRO_SCRIPTGLUE_GETCONF,
 	APRO_SCRIPTGLUE_LOG,
 	APRO_SCRIPTGLUE_DIE,
+	APRO_SCRIPTGLUE_PREFETCH,
+	APRO_SCRIPTGLUE_FETCHED,
+	APRO_SCRIPTGLUE_UNFETCH,
+	APRO_SCRIPTGLUE_GETCELL,
 
 	APRO_SCRIPTGLUE_MKOBJ,
 	APRO_SCRIPTGLUE_INOBJ,
 	APRO_SCRIPTGLUE_PUTOBJ,
 	APRO_SCRIPTGLUE_KILLOBJ,
+	APRO_SCRIPTGLUE_LOADSCENE,
 	APRO_SCRIPTGLUE_OBJTRANS,
 	APRO_SCRIPTGLUE_OBJCONF,
+	APRO_SCRIPTGLUE_GETPROP,
+	APRO_SCRIPTGLUE_MKBATCH,
+	APRO_SCRIPTGLUE_PUTBATCH,
+	APRO_SCRIPTGLUE_PUTVIS,
 
 	APRO_SCRIPTGLUE_BITAND,
 	APRO_SCRIPTGLUE_BITSHL,
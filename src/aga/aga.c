@@ -11,6 +11,8 @@
 #include <aga/log.h>
 #include <aga/error.h>
 #include <aga/pack.h>
+#include <aga/loader.h>
+#include <aga/zone.h>
 #include <aga/midi.h>
 #include <aga/io.h>
 #include <aga/render.h>
@@ -50,6 +52,8 @@ int main(int argc, char** argv) {
 	struct aga_settings opts;
 
 	struct aga_resource_pack pack;
+	struct aga_resource_loader loader;
+	struct aga_zone zone;
 
 	struct aga_sound_device snd;
 	struct aga_midi_device midi;
@@ -90,6 +94,8 @@ int main(int argc, char** argv) {
 	userdata.window_device = &env;
 	userdata.window = &win;
 	userdata.resource_pack = &pack;
+	userdata.resource_loader = 0;
+	userdata.zone = 0;
 	userdata.buttons = &buttons;
 	userdata.dt = &dt;
 
@@ -104,14 +110,33 @@ int main(int argc, char** argv) {
 		aga_log(__FILE__, "Bye-bye!");
 		return 0;
 	}
+
+	if(opts.bench_file) {
+		result = aga_config_bench(opts.bench_file, opts.bench_runs);
+		aga_error_check_soft(__FILE__, "aga_config_bench", result);
+		aga_log(__FILE__, "Bye-bye!");
+		return 0;
+	}
 #endif
 
 	result = aga_resource_pack_new(opts.respack, &pack);
 	aga_error_check_soft(__FILE__, "aga_resource_pack_new", result);
+	if(!result) {
+		result = aga_resource_loader_new(&loader, &pack);
+		aga_error_check_soft(__FILE__, "aga_resource_loader_new", result);
+		if(!result) userdata.resource_loader = &loader;
+	}
 
 	result = aga_settings_parse_config(&opts, &pack);
 	aga_error_check_soft(__FILE__, "aga_settings_parse_config", result);
 
+	if(userdata.resource_loader) {
+		result = aga_zone_new(
+				&zone, &pack, &loader, opts.zone_cell_size, opts.zone_radius);
+		aga_error_check_soft(__FILE__, "aga_zone_new", result);
+		if(!result) userdata.zone = &zone;
+	}
+
 	aga_log(__FILE__, "Initializing systems...");
 
 	result = aga_window_device_new(&env, opts.display);
@@ -233,6 +258,16 @@ int main(int argc, char** argv) {
 			}
 			apro_stamp_end(APRO_SCRIPT_UPDATE);
 
+			if(userdata.resource_loader) {
+				apro_stamp_start(APRO_RES_POLL);
+				{
+					result = aga_resource_loader_poll(&loader);
+					aga_error_check_soft(
+							__FILE__, "aga_resource_loader_poll", result);
+				}
+				apro_stamp_end(APRO_RES_POLL);
+			}
+
 			apro_stamp_start(APRO_RES_SWEEP);
 			{
 				result = aga_resource_pack_sweep(&pack);
@@ -314,6 +349,16 @@ int main(int argc, char** argv) {
 	result = aga_window_device_delete(&env);
 	aga_error_check_soft(__FILE__, "aga_window_device_delete", result);
 
+	if(userdata.zone) {
+		result = aga_zone_delete(&zone);
+		aga_error_check_soft(__FILE__, "aga_zone_delete", result);
+	}
+
+	if(userdata.resource_loader) {
+		result = aga_resource_loader_delete(&loader);
+		aga_error_check_soft(__FILE__, "aga_resource_loader_delete", result);
+	}
+
 	result = aga_resource_pack_delete(&pack);
 	aga_error_check_soft(__FILE__, "aga_resource_pack_delete", result);
 
@@ -8,15 +8,19 @@
 #include <aga/log.h>
 #include <aga/pack.h>
 #include <aga/config.h>
+#define AGA_WANT_UNIX
+#define AGA_WANT_MATH
 #include <aga/std.h>
 #include <aga/error.h>
 #include <aga/io.h>
 #include <aga/utility.h>
+#include <aga/compress.h>
 
 /* TODO: For `struct vertex' definition -- move elsewhere. */
 #include <agan/object.h>
 
 #define AGA_RAWPATH (".raw")
+#define AGA_LZPATH (".lz")
 #define AGA_PY_END ("\n\xFF")
 /* TODO: Pass this through properly to `aga_build_X'. */
 #define AGA_BUILD_FNAME ("<build>")
@@ -45,11 +49,40 @@ enum aga_file_kind {
 	AGA_KIND_SGML,
 	AGA_KIND_PY,
 	AGA_KIND_WAV,
-	AGA_KIND_MIDI
+	AGA_KIND_MIDI,
+
+	AGA_KIND_SCENE /* Assembled from other artefacts -- see `aga/pack.h'. */
+};
+
+enum aga_build_option {
+	AGA_BUILD_OVERDRAW = 1 << 0, /* Order model triangles against overdraw. */
+	AGA_BUILD_QUANTISE = 1 << 1, /* Emit quantised (version 4) models. */
+	AGA_BUILD_MIPMAP = 1 << 2, /* Store a full mip chain with textures. */
+	AGA_BUILD_MIP_BOX = 1 << 3, /* Filter mip levels with a box, not a tent. */
+
+	/* The `enum aga_texture_format' textures are stored in. */
+	AGA_BUILD_FORMAT_SHIFT = 4,
+	AGA_BUILD_FORMAT_MASK = 7 << AGA_BUILD_FORMAT_SHIFT,
+
+	/* How many LOD levels to generate for models. */
+	AGA_BUILD_LOD_SHIFT = 7,
+	AGA_BUILD_LOD_MASK = 3 << AGA_BUILD_LOD_SHIFT
+};
+
+struct aga_build_input {
+	const char* path;
+	enum aga_file_kind kind;
+	aga_bool_t recurse;
+	aga_bool_t compress; /* Store the artefact LZSS encoded in the pack. */
+	aga_uint_t options; /* `enum aga_build_option' flags for the converter. */
+
+	/* Which world cell the input's files are streamed with, if any. */
+	aga_bool_t celled;
+	aga_sint_t cell_x;
+	aga_sint_t cell_z;
 };
 
-typedef enum aga_result (*aga_input_iterfn_t)(
-		const char*, enum aga_file_kind, aga_bool_t, void*);
+typedef enum aga_result (*aga_input_iterfn_t)(struct aga_build_input*, void*);
 
 static enum aga_result aga_build_open_config(
 		const char* path, struct aga_config_node* root) {
@@ -79,9 +112,7 @@ static enum aga_result aga_build_open_config(
 	return AGA_RESULT_OK;
 }
 
-static enum aga_result aga_build_open_output(
-		struct aga_config_node* root, void** fp, const char** out_path) {
-
+static const char* aga_build_output_path(struct aga_config_node* root) {
 	static const char* output = "Output";
 
 	enum aga_result result;
@@ -97,8 +128,10 @@ static enum aga_result aga_build_open_output(
 		path = "agapack.raw";
 	}
 
-	*out_path = path;
+	return path;
+}
 
+static enum aga_result aga_build_open_output(const char* path, void** fp) {
 	aga_log(__FILE__, "Writing output file `%s'...", path);
 
 	if(!(*fp = fopen(path, "wb"))) {
@@ -133,6 +166,17 @@ static enum aga_result aga_fprintf_add(
 	return AGA_RESULT_OK;
 }
 
+static enum aga_result aga_build_write(
+		void* fp, const void* data, aga_size_t size) {
+
+	if(fwrite(data, 1, size, fp) < size) {
+		if(ferror(fp)) return aga_error_system(__FILE__, "fwrite");
+		else return AGA_RESULT_EOF;
+	}
+
+	return AGA_RESULT_OK;
+}
+
 /*
 static enum aga_result aga_build_input_file(
 		void* fp, const char* path, enum aga_file_kind kind) {
@@ -146,11 +190,45 @@ static enum aga_result aga_build_input_file(
 }
  */
 
-static enum aga_result aga_build_python(void* out, void* in) {
+/*
+ * NOTE: What we know about an artefact beyond its bytes. Converters fill
+ * 		 This in as they go and it is carried in memory (or in the build
+ * 		 Cache, for inputs which didn't need converting this time) through to
+ * 		 The pack -- artefacts are just their data with nothing appended.
+ */
+struct aga_build_meta {
+	aga_size_t raw_size;
+
+	/* How the entry is stored in the pack -- `stored_size' 0 if unknown. */
+	enum aga_resource_encoding encoding;
+	aga_size_t stored_size;
+
+	/* `AGA_KIND_TIFF'. */
+	aga_uint_t width;
+	aga_uint_t height;
+	aga_uint_t levels; /* Mip levels stored one after another from 0. */
+	enum aga_texture_format format;
+
+	/* `AGA_KIND_OBJ'. */
+	aga_uint_t model_version;
+	float extent[6];
+	float uv_extent[4];
+	aga_uint_t vertices;
+	aga_uint_t indices;
+	aga_uint_t index_size;
+	aga_uint_t lods;
+	aga_uint_t lod_indices[AGA_MODEL_LODS];
+};
+
+static enum aga_result aga_build_python(
+		void* out, void* in, struct aga_build_meta* meta) {
+
 	enum aga_result result;
 
 	size_t written;
 
+	(void) meta;
+
 	if((result = aga_file_copy(out, in, AGA_COPY_ALL))) return result;
 
 	written = fwrite(AGA_PY_END, 1, sizeof(AGA_PY_END) - 1, out);
@@ -161,481 +239,2948 @@ static enum aga_result aga_build_python(void* out, void* in) {
 	return AGA_RESULT_OK;
 }
 
-static enum aga_result aga_build_obj(void* out, void* in) {
-	enum aga_result result = AGA_RESULT_OK;
+/*
+ * NOTE: Corners are welded when every attribute matches exactly -- unlike
+ * 		 `glmWeld' (which is quadratic, and only compares positions so it
+ * 		 Would merge across hard edges and UV seams) this hashes the whole
+ * 		 Vertex so stays linear on large meshes.
+ */
+struct aga_build_weld {
+	struct aga_model_vertex* verts;
+	aga_uint_t len;
 
-	GLMmodel* model;
-	float extent[6];
+	aga_uint_t* table; /* Open-addressed, holds `verts' index + 1. */
+	aga_size_t mask;
+};
 
-	unsigned i, j;
-	GLMgroup* group;
+static aga_size_t aga_build_weld_hash(const struct aga_model_vertex* v) {
+	const aga_uchar_t* p = (const aga_uchar_t*) v;
 
-	if(!(model = glmReadOBJFile(AGA_BUILD_FNAME, in))) {
-		/* TODO: Handle different EH. */
-		return AGA_RESULT_OOM;
+	aga_size_t hash = 2166136261U;
+	aga_size_t i;
+
+	for(i = 0; i < sizeof(struct aga_model_vertex); ++i) {
+		hash ^= p[i];
+		hash *= 16777619U;
 	}
 
-	/* TODO: Put this epsilon somewhere configurable. */
-	/* TODO: This hangs? (Or takes a *really* long time on sponza or smth.) */
-	/* glmWeld(model, 0.0001f); */
-	glmExtent(model, extent);
+	return hash;
+}
 
-	group = model->groups;
-	while(group) {
-		const GLMtriangle* tris = model->tris;
-		const GLMmaterial* mats = model->mats;
-		const float* norms = model->norms;
-		const float* uvs = model->uvs;
-		const float* verts = model->verts;
+static aga_uint_t aga_build_weld_add(
+		struct aga_build_weld* weld, const struct aga_model_vertex* v) {
 
-		for(i = 0; i < group->ntris; i++) {
-			const GLMtriangle* t = &tris[group->tris[i]];
-			const GLMmaterial* mat = &mats[group->material];
+	aga_size_t i = aga_build_weld_hash(v) & weld->mask;
 
-			struct aga_vertex v;
+	for(; weld->table[i]; i = (i + 1) & weld->mask) {
+		aga_uint_t ind = weld->table[i] - 1;
 
-			if(mat) aga_memcpy(v.col, mat->diffuse, sizeof(v.col));
-			else aga_memset(v.col, 0, sizeof(v.col));
+		if(!memcmp(&weld->verts[ind], v, sizeof(*v))) return ind;
+	}
 
-			for(j = 0; j < 3; ++j) {
-				aga_memcpy(v.norm, &norms[3 * t->n_inds[j]], sizeof(v.norm));
-				aga_memcpy(v.uv, &uvs[2 * t->t_inds[j]], sizeof(v.uv));
-				aga_memcpy(v.pos, &verts[3 * t->v_inds[j]], sizeof(v.pos));
+	weld->verts[weld->len] = *v;
+	weld->table[i] = ++weld->len;
 
-				if(fwrite(&v, sizeof(v), 1, out) < 1) {
-					if(ferror(out)) {
-						return aga_error_system(__FILE__, "fwrite");
-					}
+	return weld->len - 1;
+}
 
-					return AGA_RESULT_EOF;
-				}
-			}
-		}
+/*
+ * NOTE: Reorders triangles for the post-transform vertex cache using Tom
+ * 		 Forsyth's linear-speed method -- each step greedily emits the best
+ * 		 Scoring triangle touching a simulated LRU cache. Vertices score
+ * 		 Higher the more recently they were used and the fewer triangles they
+ * 		 Have left so we don't strand them. Where nothing in the cache has
+ * 		 Triangles left we restart from the next unemitted triangle rather
+ * 		 Than searching the whole mesh, keeping this linear on large meshes.
+ */
+#define AGA_BUILD_VCACHE_SIZE (32)
 
-		group = group->next;
-	}
+struct aga_build_vcache_vertex {
+	int position; /* -1 if not in the cache. */
+	float score;
 
-	if(fwrite(extent, sizeof(float), AGA_LEN(extent), out) < AGA_LEN(extent)) {
-		if(ferror(out)) {
-			result = aga_error_system(__FILE__, "fwrite");
-			goto cleanup;
-		}
+	/* This vertex's unemitted triangles are `adj[first...first+active)'. */
+	aga_uint_t first;
+	aga_uint_t active;
+};
 
-		result = AGA_RESULT_EOF;
-		goto cleanup;
-	}
+static float aga_build_vcache_score(int position, aga_uint_t active) {
+	float score = 0.0f;
 
-	cleanup: {
-		glmDelete(model);
-	}
+	if(!active) return -1.0f;
 
-	return result;
+	if(position >= 0) {
+		/*
+		 * The last triangle's vertices get a fixed score so we don't favour
+		 * Simply stripping along from it.
+		 */
+		if(position < 3) score = 0.75f;
+		else {
+			score = (float) (position - 3) / (AGA_BUILD_VCACHE_SIZE - 3);
+			score = 1.0f - score;
+			score = score * (float) sqrt(score);
+		}
+	}
 
+	return score + 2.0f / (float) sqrt(active);
 }
 
-static enum aga_result aga_build_tiff(void* out, void* in) {
-	/* NOTE: TIFF wants this -- this is kind of evil. */
-	static char msg[1024];
+static enum aga_result aga_build_vcache_optimise(
+		aga_uint_t* inds, aga_size_t count, aga_uint_t nverts) {
 
 	enum aga_result result = AGA_RESULT_OK;
 
-	int fd;
-
-	TIFF* tiff;
-	TIFFRGBAImage img = { 0 };
-
-	aga_size_t size, count;
-	void* raster = 0;
-
-	aga_uint_t width;
-
-	if((fd = fileno(in)) == -1) return aga_error_system(__FILE__, "fileno");
-
-	if(!(tiff = TIFFFdOpen(fd, AGA_BUILD_FNAME, "r"))) return AGA_RESULT_ERROR;
-
-	if(!TIFFRGBAImageBegin(&img, tiff, 0, msg)) {
-		aga_log(__FILE__, "err: Failed to read TIFF file: %s", msg);
-		result = AGA_RESULT_ERROR;
+	struct aga_build_vcache_vertex* verts;
+	aga_uint_t* adj;
+	aga_uint_t* out;
+	float* scores;
+	aga_uchar_t* emitted;
+
+	aga_uint_t cache[AGA_BUILD_VCACHE_SIZE + 3];
+	aga_uint_t next[AGA_BUILD_VCACHE_SIZE + 3];
+	aga_size_t cache_len = 0, next_len;
+
+	aga_size_t ntris = count / 3;
+	aga_size_t cursor = 0, n;
+	aga_size_t i, j, k;
+	long best = -1;
+
+	if(!ntris) return AGA_RESULT_OK;
+
+	verts = aga_calloc(nverts, sizeof(struct aga_build_vcache_vertex));
+	adj = aga_malloc(count * sizeof(aga_uint_t));
+	out = aga_malloc(count * sizeof(aga_uint_t));
+	scores = aga_malloc(ntris * sizeof(float));
+	emitted = aga_calloc(ntris, sizeof(aga_uchar_t));
+	if(!verts || !adj || !out || !scores || !emitted) {
+		result = AGA_RESULT_OOM;
 		goto cleanup;
 	}
 
-	count = img.width * img.height;
-	size = 4 * count;
-	if(!(raster = aga_malloc(size))) {
-		result = aga_error_system(__FILE__, "aga_malloc");
-		goto cleanup;
-	}
+	for(i = 0; i < count; ++i) verts[inds[i]].active++;
 
-	if(!TIFFRGBAImageGet(&img, raster, img.width, img.height)) {
-		result = AGA_RESULT_ERROR;
-		goto cleanup;
+	for(i = 0, n = 0; i < nverts; ++i) {
+		verts[i].first = (aga_uint_t) n;
+		n += verts[i].active;
+		verts[i].active = 0;
 	}
 
-	if(fwrite(raster, 4, count, out) < count) {
-		if(ferror(out)) {
-			result = aga_error_system(__FILE__, "fwrite");
-			goto cleanup;
-		}
+	for(i = 0; i < count; ++i) {
+		struct aga_build_vcache_vertex* v = &verts[inds[i]];
 
-		result = AGA_RESULT_EOF;
-		goto cleanup;
+		adj[v->first + v->active++] = (aga_uint_t) (i / 3);
 	}
 
-	width = img.width;
-	if(fwrite(&width, sizeof(width), 1, out) < 1) {
-		if(ferror(out)) {
-			result = aga_error_system(__FILE__, "fwrite");
-			goto cleanup;
-		}
-
-		result = AGA_RESULT_EOF;
-		goto cleanup;
+	for(i = 0; i < nverts; ++i) {
+		verts[i].position = -1;
+		verts[i].score = aga_build_vcache_score(-1, verts[i].active);
 	}
 
-	cleanup: {
-		aga_free(raster);
-		TIFFRGBAImageEnd(&img);
-		TIFFClose(tiff, 0);
+	for(i = 0; i < ntris; ++i) {
+		scores[i] = verts[inds[3 * i + 0]].score;
+		scores[i] += verts[inds[3 * i + 1]].score;
+		scores[i] += verts[inds[3 * i + 2]].score;
 	}
 
-	return result;
-}
+	for(n = 0; n < ntris; ++n) {
+		aga_uint_t* tri;
+		float best_score = -1.0f;
 
-static aga_bool_t aga_build_path_matches_kind(
-		const char* path, enum aga_file_kind kind) {
+		if(best == -1) {
+			while(emitted[cursor]) ++cursor;
+			best = (long) cursor;
+		}
 
-	/*
-	 * TODO: Reduce all paths to within basic FAT restrictions -- including our
-	 * 		 Source tree!
-	 */
-	static const char* kind_exts[] = {
-			"", /* AGA_KIND_NONE */
-			".raw", /* AGA_KIND_RAW */
-			".tiff", /* AGA_KIND_TIFF */
-			".obj", /* AGA_KIND_OBJ */
-			".sgml", /* AGA_KIND_SGML */
-			".py", /* AGA_KIND_PY */
-			".wav", /* AGA_KIND_WAV */
-			".mid" /* AGA_KIND_MIDI */
-	};
+		tri = &inds[3 * best];
+		emitted[best] = AGA_TRUE;
+		aga_memcpy(&out[3 * n], tri, 3 * sizeof(aga_uint_t));
 
-	/* TODO: `strcasecmp'? */
-	const char* ext = strrchr(path, '.');
-	if(!ext || !aga_streql(ext, kind_exts[kind])) return AGA_FALSE;
+		next_len = 0;
 
-	return AGA_TRUE;
-}
+		for(i = 0; i < 3; ++i) {
+			struct aga_build_vcache_vertex* v = &verts[tri[i]];
 
-static enum aga_result aga_build_input_file(
-		const char* path, enum aga_file_kind kind) {
+			for(j = v->first; j < v->first + v->active; ++j) {
+				if(adj[j] == (aga_uint_t) best) {
+					adj[j] = adj[v->first + --v->active];
+					break;
+				}
+			}
 
-	static aga_fixed_buf_t outpath = { 0 };
+			/* Degenerate triangles name a vertex more than once. */
+			for(j = 0; j < next_len && next[j] != tri[i]; ++j) continue;
+			if(j == next_len) next[next_len++] = tri[i];
+		}
 
-	enum aga_result result = AGA_RESULT_OK;
+		for(i = 0; i < cache_len; ++i) {
+			for(j = 0; j < next_len && next[j] != cache[i]; ++j) continue;
+			if(j == next_len) next[next_len++] = cache[i];
+		}
 
-	void* in;
-	void* out;
+		for(i = 0; i < next_len; ++i) {
+			struct aga_build_vcache_vertex* v = &verts[next[i]];
 
-	/*
-	 * Input kinds which are handled as "raw" need a special case when
-	 * Looking for the resultant artefact files -- we just redirect to the
-	 * Original because there is no need to produce any output whatsoever.
-	 */
-	if(kind == AGA_KIND_SGML || kind == AGA_KIND_RAW) return AGA_RESULT_OK;
+			v->position = i < AGA_BUILD_VCACHE_SIZE ? (int) i : -1;
+			v->score = aga_build_vcache_score(v->position, v->active);
+		}
 
-	/* Skip input files which don't match kind. */
-	if(!aga_build_path_matches_kind(path, kind)) return AGA_RESULT_OK;
+		best = -1;
 
-	strcpy(outpath, path);
-	strcat(outpath, AGA_RAWPATH);
+		for(i = 0; i < next_len; ++i) {
+			struct aga_build_vcache_vertex* v = &verts[next[i]];
 
-	if(!(in = fopen(path, "rb"))) {
-		return aga_error_system_path(__FILE__, "fopen", path);
-	}
+			for(j = v->first; j < v->first + v->active; ++j) {
+				aga_uint_t t = adj[j];
 
-	if(!(out = fopen(outpath, "wb"))) {
-		return aga_error_system_path(__FILE__, "fopen", path);
-	}
+				scores[t] = 0.0f;
+				for(k = 0; k < 3; ++k) {
+					scores[t] += verts[inds[3 * t + k]].score;
+				}
 
-	/* TODO: Leaky error states. */
-	switch(kind) {
-		default: {
-			aga_log(
-					__FILE__,
-					"err: Unknown or unimplemented input kind for `%s'", path);
-			break;
+				if(scores[t] > best_score) {
+					best_score = scores[t];
+					best = (long) t;
+				}
+			}
 		}
 
-		case AGA_KIND_PY: result = aga_build_python(out, in); break;
+		cache_len = next_len;
+		if(cache_len > AGA_BUILD_VCACHE_SIZE) cache_len = AGA_BUILD_VCACHE_SIZE;
+		aga_memcpy(cache, next, cache_len * sizeof(aga_uint_t));
+	}
+
+	aga_memcpy(inds, out, ntris * 3 * sizeof(aga_uint_t));
+
+	cleanup: {
+		aga_free(emitted);
+		aga_free(scores);
+		aga_free(out);
+		aga_free(adj);
+		aga_free(verts);
 
-		case AGA_KIND_OBJ: result = aga_build_obj(out, in); break;
-		case AGA_KIND_TIFF: result = aga_build_tiff(out, in); break;
+		return result;
+	}
+}
 
 /*
-		case AGA_KIND_WAV: break;
-		case AGA_KIND_MIDI: break;
+ * NOTE: Optional overdraw pass after Sander et al. -- the cache-ordered
+ * 		 Triangles are cut into clusters wherever the (FIFO) cache would
+ * 		 Have been flushed anyway, and clusters facing out from the centre
+ * 		 Of the mesh are drawn first so they tend to occlude the rest. Cuts
+ * 		 Only land on full misses so the cache efficiency is kept.
  */
-	}
+#define AGA_BUILD_CLUSTER_MIN (64)
 
-	if(result) return result;
+struct aga_build_cluster {
+	aga_size_t start;
+	aga_size_t len;
+	float key;
+};
 
-	if(fclose(in) == EOF) return aga_error_system(__FILE__, "fclose");
+static int aga_build_cluster_cmp(const void* a, const void* b) {
+	const struct aga_build_cluster* ca = a;
+	const struct aga_build_cluster* cb = b;
 
-	if(fclose(out) == EOF) return aga_error_system(__FILE__, "fclose");
+	if(ca->key > cb->key) return -1;
+	if(ca->key < cb->key) return 1;
 
-	return AGA_RESULT_OK;
+	/* Keep ties in cache order. */
+	return ca->start < cb->start ? -1 : ca->start > cb->start;
 }
 
-static enum aga_result aga_build_input_dir(const char* path, void* pass) {
-	enum aga_file_kind* kind = pass;
+static enum aga_result aga_build_overdraw_optimise(
+		aga_uint_t* inds, aga_size_t count,
+		const struct aga_model_vertex* verts, aga_uint_t nverts) {
 
-	return aga_build_input_file(path, *kind);
-}
+	enum aga_result result = AGA_RESULT_OK;
 
-static enum aga_result aga_build_input(
-		const char* path, enum aga_file_kind kind, aga_bool_t recurse,
-		void* pass) {
+	struct aga_build_cluster* clusters;
+	aga_size_t* stamps;
+	aga_uint_t* out = 0;
+	aga_size_t len = 0;
+	aga_size_t time = AGA_BUILD_VCACHE_SIZE + 1;
 
-	enum aga_result result;
-	union aga_file_attribute attr;
+	float centre[3] = { 0.0f, 0.0f, 0.0f };
+	aga_size_t ntris = count / 3;
+	aga_size_t i, j, k;
 
-	(void) pass;
+	if(!ntris) return AGA_RESULT_OK;
 
-	if((result = aga_file_attribute_path(path, AGA_FILE_TYPE, &attr))) {
-		return result;
+	clusters = aga_malloc(ntris * sizeof(struct aga_build_cluster));
+	stamps = aga_calloc(nverts, sizeof(aga_size_t));
+	if(!clusters || !stamps) {
+		result = AGA_RESULT_OOM;
+		goto cleanup;
 	}
 
-	if(attr.type == AGA_FILE_DIRECTORY) {
-		return aga_directory_iterate(
-				path, aga_build_input_dir, recurse, &kind, AGA_TRUE);
+	for(i = 0; i < count; ++i) {
+		for(j = 0; j < 3; ++j) centre[j] += verts[inds[i]].pos[j];
 	}
-	else return aga_build_input_file(path, kind);
-}
-
-struct aga_build_conf_pass {
-	void* fp;
-	enum aga_file_kind kind;
-	aga_size_t offset;
-};
 
-static enum aga_result aga_build_conf_file(
-		const char* path, enum aga_file_kind kind, void* fp,
-		aga_size_t* offset) {
+	for(j = 0; j < 3; ++j) centre[j] /= (float) count;
 
-	aga_fixed_buf_t outpath = { 0 };
+	for(i = 0; i < ntris; ++i) {
+		aga_size_t misses = 0;
 
-	enum aga_result result;
+		for(j = 0; j < 3; ++j) {
+			aga_uint_t v = inds[3 * i + j];
 
-	union aga_file_attribute attr;
+			if(time - stamps[v] > AGA_BUILD_VCACHE_SIZE) {
+				stamps[v] = time++;
+				++misses;
+			}
+		}
 
-	/* Skip input files which don't match kind. */
-	if(!aga_build_path_matches_kind(path, kind)) return AGA_RESULT_OK;
+		if(!len || (misses == 3 &&
+				clusters[len - 1].len >= AGA_BUILD_CLUSTER_MIN)) {
 
-	strcpy(outpath, path);
+			clusters[len].start = i;
+			clusters[len].len = 0;
+			++len;
+		}
 
-	/* Use the base file as the input for SGML/RAW inputs. */
-	if(kind != AGA_KIND_SGML && kind != AGA_KIND_RAW) {
-		strcat(outpath, AGA_RAWPATH);
+		clusters[len - 1].len++;
 	}
 
-	result = aga_fprintf_add(fp, 1, "<item name=\"%s\">\n", outpath); \
-    if (result) return result;
-
-	/* Unpleasant but neccesary. */
-#define agab_(indent, name, type, fmt, param) \
-        do { \
-            result = aga_fprintf_add( \
-                    fp, indent, \
-                    "<item name=\"%s\" type=\"%s\">\n", name, type); \
-            if(result) return result; \
-            \
-            result = aga_fprintf_add(fp, indent + 1, fmt "\n", param); \
-            if(result) return result; \
-            \
-            result = aga_fprintf_add(fp, indent, "</item>\n"); \
-            if(result) return result; \
-		} while(0)
-	{
-		/*
-		 * TODO: Sort out:
-		 *		  - `%zu' did not exist until C99.
-		 *		  - `%llu' should not be used on non "modern Windows" machines.
-		 *				- Same goes for `long long' in general.
-		 *
-		 *		 Might need to make our own equivalent of `inttypes.h'.
-		 */
-		agab_(2, "Offset", "Integer", "%zu", *offset);
-
-		result = aga_file_attribute_path(outpath, AGA_FILE_LENGTH, &attr);
-		if(result) return result;
-
-		*offset += attr.length;
-		agab_(2, "Size", "Integer", "%zu", attr.length);
-
-		switch(kind) {
-			default: break;
+	for(i = 0; i < len; ++i) {
+		struct aga_build_cluster* cluster = &clusters[i];
 
-			/*
-			 * TODO: More formally document these "tails" in a comment at the
-			 * 		 Top of this file.
-			 */
-			case AGA_KIND_TIFF: {
-				aga_uint_t width;
+		float mid[3] = { 0.0f, 0.0f, 0.0f };
+		float norm[3] = { 0.0f, 0.0f, 0.0f };
+		float mag;
 
-				result = aga_path_tail(outpath, sizeof(width), &width);
-				if(result) return result;
+		for(j = cluster->start; j < cluster->start + cluster->len; ++j) {
+			const float* a = verts[inds[3 * j + 0]].pos;
+			const float* b = verts[inds[3 * j + 1]].pos;
+			const float* c = verts[inds[3 * j + 2]].pos;
 
-				*offset -= sizeof(width);
-				agab_(2, "Width", "Integer", "%u", width);
+			float e0[3], e1[3];
 
-				break;
+			for(k = 0; k < 3; ++k) {
+				mid[k] += (a[k] + b[k] + c[k]) / 3.0f;
+				e0[k] = b[k] - a[k];
+				e1[k] = c[k] - a[k];
 			}
 
-			case AGA_KIND_OBJ: {
-				float extents[6];
-
-				result = aga_path_tail(outpath, sizeof(extents), extents);
-				if(result) return result;
-
-				*offset -= sizeof(extents);
-				agab_(2, "MinX", "Float", "%f", extents[0]);
-				agab_(2, "MinY", "Float", "%f", extents[1]);
-				agab_(2, "MinZ", "Float", "%f", extents[2]);
-				agab_(2, "MaxX", "Float", "%f", extents[3]);
-				agab_(2, "MaxY", "Float", "%f", extents[4]);
-				agab_(2, "MaxZ", "Float", "%f", extents[5]);
+			/* Unnormalised so larger triangles weigh more. */
+			norm[0] += e0[1] * e1[2] - e0[2] * e1[1];
+			norm[1] += e0[2] * e1[0] - e0[0] * e1[2];
+			norm[2] += e0[0] * e1[1] - e0[1] * e1[0];
+		}
 
-				/*
-				 * Mark model as version 2 -- we started discarding model
-				 * vertex colouration.
-				 */
-				agab_(2, "Version", "Integer", "%u", 2);
+		mag = (float) sqrt(
+				norm[0] * norm[0] + norm[1] * norm[1] + norm[2] * norm[2]);
 
-				break;
+		cluster->key = 0.0f;
+		if(mag > 0.0f) {
+			for(k = 0; k < 3; ++k) {
+				mid[k] = mid[k] / (float) cluster->len - centre[k];
+				cluster->key += mid[k] * norm[k] / mag;
 			}
 		}
 	}
-#undef agab_
 
-	result = aga_fprintf_add(fp, 1, "</item>\n"); \
-	if(result) return result;
-
-	return AGA_RESULT_OK;
-}
+	qsort(clusters, len, sizeof(struct aga_build_cluster),
+			aga_build_cluster_cmp);
 
-static enum aga_result aga_build_conf_dir(const char* path, void* pass) {
-	struct aga_build_conf_pass* conf_pass = pass;
+	if(!(out = aga_malloc(count * sizeof(aga_uint_t)))) {
+		result = AGA_RESULT_OOM;
+		goto cleanup;
+	}
 
-	return aga_build_conf_file(
-			path, conf_pass->kind, conf_pass->fp, &conf_pass->offset);
-}
+	for(i = 0, k = 0; i < len; ++i) {
+		aga_size_t size = 3 * clusters[i].len * sizeof(aga_uint_t);
 
-static enum aga_result aga_build_conf(
-		const char* path, enum aga_file_kind kind, aga_bool_t recurse,
-		void* pass) {
+		aga_memcpy(&out[k], &inds[3 * clusters[i].start], size);
+		k += 3 * clusters[i].len;
+	}
 
-	enum aga_result result;
-	union aga_file_attribute attr;
+	aga_memcpy(inds, out, count * sizeof(aga_uint_t));
 
-	struct aga_build_conf_pass* conf_pass = pass;
+	cleanup: {
+		aga_free(out);
+		aga_free(stamps);
+		aga_free(clusters);
 
-	if((result = aga_file_attribute_path(path, AGA_FILE_TYPE, &attr))) {
 		return result;
 	}
-
-	if(attr.type == AGA_FILE_DIRECTORY) {
-		conf_pass->kind = kind;
-
-		return aga_directory_iterate(
-				path, aga_build_conf_dir, recurse, conf_pass, AGA_TRUE);
-	}
-	else {
-		return aga_build_conf_file(
-			path, kind, conf_pass->fp, &conf_pass->offset);
-	}
 }
 
-static enum aga_result aga_build_pack_file(
-		const char* path, enum aga_file_kind kind, void* fp) {
+/*
+ * Lays vertices out in the order the (reordered) indices first use them so
+ * Fetches walk forward through the buffer.
+ */
+static enum aga_result aga_build_vfetch_optimise(
+		aga_uint_t* inds, aga_size_t count, struct aga_model_vertex* verts,
+		aga_uint_t nverts) {
 
-	aga_fixed_buf_t outpath = { 0 };
+	struct aga_model_vertex* out;
+	aga_uint_t* remap;
+	aga_uint_t len = 0;
+	aga_size_t i;
 
-	enum aga_result result;
+	out = aga_malloc((nverts + 1) * sizeof(struct aga_model_vertex));
+	remap = aga_malloc((nverts + 1) * sizeof(aga_uint_t));
+	if(!out || !remap) {
+		aga_free(remap);
+		aga_free(out);
 
-	union aga_file_attribute attr;
+		return AGA_RESULT_OOM;
+	}
 
-	void* in;
-	aga_size_t size;
+	for(i = 0; i < nverts; ++i) remap[i] = (aga_uint_t) -1;
 
-	/* Skip input files which don't match kind. */
-	if(!aga_build_path_matches_kind(path, kind)) return AGA_RESULT_OK;
+	for(i = 0; i < count; ++i) {
+		aga_uint_t v = inds[i];
 
-	strcpy(outpath, path);
+		if(remap[v] == (aga_uint_t) -1) {
+			out[len] = verts[v];
+			remap[v] = len++;
+		}
 
-	/* Use the base file as the input for SGML/RAW inputs. */
-	if(kind != AGA_KIND_SGML && kind != AGA_KIND_RAW) {
-		strcat(outpath, AGA_RAWPATH);
+		inds[i] = remap[v];
 	}
 
-	if((result = aga_file_attribute_path(outpath, AGA_FILE_LENGTH, &attr))) {
-		return result;
-	}
+	aga_memcpy(verts, out, len * sizeof(struct aga_model_vertex));
 
-	size = attr.length;
+	aga_free(remap);
+	aga_free(out);
 
-	switch(kind) {
-		default: break;
+	return AGA_RESULT_OK;
+}
 
-		/* TODO: Structurize file tails. */
-		case AGA_KIND_TIFF: size -= sizeof(aga_uint_t); break;
-		case AGA_KIND_OBJ: size -= sizeof(float[6]); break;
-	}
+static aga_ushort_t aga_build_quantise(float v, float min, float max) {
+	float f;
 
-	if(!(in = fopen(outpath, "rb"))) {
-		return aga_error_system_path(__FILE__, "fopen", outpath);
+	if(max <= min) return 0;
+
+	f = (v - min) / (max - min) * 65535.0f + 0.5f;
+
+	if(f < 0.0f) return 0;
+	if(f > 65535.0f) return 0xFFFF;
+
+	return (aga_ushort_t) f;
+}
+
+static aga_schar_t aga_build_quantise_norm(float n) {
+	if(n > 1.0f) n = 1.0f;
+	if(n < -1.0f) n = -1.0f;
+
+	return (aga_schar_t) (n * 127.0f + (n < 0.0f ? -0.5f : 0.5f));
+}
+
+/*
+ * NOTE: LOD levels are made by edge collapse -- each collapse moves a welded
+ * 		 Vertex onto one of its neighbours so every level can share the base
+ * 		 Vertex buffer and only needs its own indices. Collapses are costed
+ * 		 With Garland and Heckbert's quadric error and done in independent
+ * 		 Batches per pass. Vertices on open edges are never moved, welding
+ * 		 Splits UV seams and hard edges so this keeps those intact too.
+ */
+struct aga_build_adjacency {
+	aga_uint_t* offsets; /* `nverts + 1' offsets into `faces'. */
+	aga_uint_t* faces;
+};
+
+static enum aga_result aga_build_adjacency(
+		struct aga_build_adjacency* adj, const aga_uint_t* inds,
+		aga_size_t count, aga_uint_t nverts) {
+
+	aga_size_t i;
+
+	adj->offsets = aga_calloc(nverts + 2, sizeof(aga_uint_t));
+	adj->faces = aga_malloc((count + 1) * sizeof(aga_uint_t));
+	if(!adj->offsets || !adj->faces) return AGA_RESULT_OOM;
+
+	for(i = 0; i < count; ++i) adj->offsets[inds[i] + 2]++;
+	for(i = 2; i < nverts + 2; ++i) adj->offsets[i] += adj->offsets[i - 1];
+
+	for(i = 0; i < count; ++i) {
+		adj->faces[adj->offsets[inds[i] + 1]++] = (aga_uint_t) (i / 3);
+	}
+
+	return AGA_RESULT_OK;
+}
+
+static void aga_build_adjacency_delete(struct aga_build_adjacency* adj) {
+	aga_free(adj->offsets);
+	aga_free(adj->faces);
+}
+
+static void aga_build_normal(
+		const float* a, const float* b, const float* c, double* out) {
+
+	double e0[3], e1[3];
+	aga_size_t i;
+
+	for(i = 0; i < 3; ++i) {
+		e0[i] = b[i] - a[i];
+		e1[i] = c[i] - a[i];
+	}
+
+	out[0] = e0[1] * e1[2] - e0[2] * e1[1];
+	out[1] = e0[2] * e1[0] - e0[0] * e1[2];
+	out[2] = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+/* Upper triangle of the symmetric 4x4 -- `aa ab ac ad bb bc bd cc cd dd'. */
+static double aga_build_quadric_error(const double* q, const float* p) {
+	double x = p[0], y = p[1], z = p[2];
+
+	return q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z +
+			2.0 * q[3] * x + q[4] * y * y + 2.0 * q[5] * y * z +
+			2.0 * q[6] * y + q[7] * z * z + 2.0 * q[8] * z + q[9];
+}
+
+struct aga_build_collapse {
+	double cost;
+	aga_uint_t from;
+	aga_uint_t to;
+};
+
+static int aga_build_collapse_cmp(const void* a, const void* b) {
+	double ca = ((const struct aga_build_collapse*) a)->cost;
+	double cb = ((const struct aga_build_collapse*) b)->cost;
+
+	return ca < cb ? -1 : ca > cb;
+}
+
+/* Whether moving `from' onto `to' would turn any of its faces over. */
+static aga_bool_t aga_build_collapse_flips(
+		const aga_uint_t* inds, const struct aga_build_adjacency* adj,
+		const struct aga_model_vertex* verts, aga_uint_t from, aga_uint_t to) {
+
+	aga_uint_t i, j;
+
+	for(i = adj->offsets[from]; i < adj->offsets[from + 1]; ++i) {
+		const aga_uint_t* tri = &inds[3 * adj->faces[i]];
+		const float* p[3];
+		double before[3], after[3];
+
+		if(tri[0] == to || tri[1] == to || tri[2] == to) continue;
+
+		for(j = 0; j < 3; ++j) p[j] = verts[tri[j]].pos;
+		aga_build_normal(p[0], p[1], p[2], before);
+
+		for(j = 0; j < 3; ++j) if(tri[j] == from) p[j] = verts[to].pos;
+		aga_build_normal(p[0], p[1], p[2], after);
+
+		if(before[0] * after[0] + before[1] * after[1] +
+			before[2] * after[2] <= 0.0) {
+
+			return AGA_TRUE;
+		}
+	}
+
+	return AGA_FALSE;
+}
+
+/* Marks vertices on edges only one face uses. */
+static void aga_build_lock_open(
+		const aga_uint_t* inds, const struct aga_build_adjacency* adj,
+		aga_uint_t nverts, aga_bool_t* locked) {
+
+	aga_uint_t v, i, j, k, l;
+
+	for(v = 0; v < nverts; ++v) {
+		for(i = adj->offsets[v]; i < adj->offsets[v + 1]; ++i) {
+			const aga_uint_t* tri = &inds[3 * adj->faces[i]];
+
+			for(j = 0; j < 3; ++j) {
+				aga_uint_t w = tri[j];
+				aga_uint_t shared = 0;
+
+				if(w == v) continue;
+
+				for(k = adj->offsets[v]; k < adj->offsets[v + 1]; ++k) {
+					const aga_uint_t* other = &inds[3 * adj->faces[k]];
+
+					for(l = 0; l < 3; ++l) if(other[l] == w) ++shared;
+				}
+
+				if(shared == 1) locked[v] = locked[w] = AGA_TRUE;
+			}
+		}
+	}
+}
+
+static enum aga_result aga_build_decimate(
+		aga_uint_t* inds, aga_size_t* count,
+		const struct aga_model_vertex* verts, aga_uint_t nverts,
+		aga_size_t target) {
+
+	enum aga_result result = AGA_RESULT_OK;
+
+	struct aga_build_adjacency adj = { 0 };
+	struct aga_build_collapse* collapses = 0;
+	double* quadrics = 0;
+	aga_bool_t* locked = 0;
+	aga_bool_t* touched = 0;
+	aga_size_t tris = *count / 3;
+	aga_bool_t first = AGA_TRUE;
+	aga_size_t i, j, k;
+
+	quadrics = aga_calloc(10 * (aga_size_t) nverts + 1, sizeof(double));
+	locked = aga_calloc(nverts + 1, sizeof(aga_bool_t));
+	touched = aga_calloc(nverts + 1, sizeof(aga_bool_t));
+	collapses = aga_malloc(
+			(nverts + 1) * sizeof(struct aga_build_collapse));
+	if(!quadrics || !locked || !touched || !collapses) {
+		result = AGA_RESULT_OOM;
+		goto cleanup;
+	}
+
+	/* Each vertex starts with the area-weighted planes of its faces. */
+	for(i = 0; i < tris; ++i) {
+		const aga_uint_t* tri = &inds[3 * i];
+		const float* p = verts[tri[0]].pos;
+		double n[3], len, d;
+		double plane[4];
+
+		aga_build_normal(p, verts[tri[1]].pos, verts[tri[2]].pos, n);
+
+		len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if(len == 0.0) continue;
+
+		for(j = 0; j < 3; ++j) plane[j] = n[j] / len;
+		d = -(plane[0] * p[0] + plane[1] * p[1] + plane[2] * p[2]);
+		plane[3] = d;
+
+		for(j = 0; j < 3; ++j) {
+			double* q = &quadrics[10 * tri[j]];
+			double area = len / 2.0;
+
+			q[0] += area * plane[0] * plane[0];
+			q[1] += area * plane[0] * plane[1];
+			q[2] += area * plane[0] * plane[2];
+			q[3] += area * plane[0] * plane[3];
+			q[4] += area * plane[1] * plane[1];
+			q[5] += area * plane[1] * plane[2];
+			q[6] += area * plane[1] * plane[3];
+			q[7] += area * plane[2] * plane[2];
+			q[8] += area * plane[2] * plane[3];
+			q[9] += area * plane[3] * plane[3];
+		}
+	}
+
+	while(tris > target) {
+		aga_size_t ncollapses = 0, done = 0;
+
+		aga_build_adjacency_delete(&adj);
+		result = aga_build_adjacency(&adj, inds, 3 * tris, nverts);
+		if(result) goto cleanup;
+
+		if(first) aga_build_lock_open(inds, &adj, nverts, locked);
+		first = AGA_FALSE;
+
+		/* Find each free vertex's cheapest neighbour to collapse onto. */
+		for(i = 0; i < nverts; ++i) {
+			struct aga_build_collapse best;
+
+			best.cost = -1.0;
+			best.from = (aga_uint_t) i;
+			best.to = 0;
+
+			if(locked[i]) continue;
+
+			for(j = adj.offsets[i]; j < adj.offsets[i + 1]; ++j) {
+				const aga_uint_t* tri = &inds[3 * adj.faces[j]];
+
+				for(k = 0; k < 3; ++k) {
+					double q[10];
+					double cost;
+					aga_size_t l;
+
+					if(tri[k] == i) continue;
+
+					for(l = 0; l < 10; ++l) {
+						q[l] = quadrics[10 * i + l] +
+								quadrics[10 * tri[k] + l];
+					}
+
+					cost = aga_build_quadric_error(q, verts[tri[k]].pos);
+
+					if(best.cost < 0.0 || cost < best.cost) {
+						best.cost = cost;
+						best.to = tri[k];
+					}
+				}
+			}
+
+			if(best.cost >= 0.0) collapses[ncollapses++] = best;
+		}
+
+		qsort(
+				collapses, ncollapses, sizeof(struct aga_build_collapse),
+				aga_build_collapse_cmp);
+
+		for(i = 0; i < nverts; ++i) touched[i] = AGA_FALSE;
+
+		for(i = 0; i < ncollapses && tris > target; ++i) {
+			aga_uint_t from = collapses[i].from;
+			aga_uint_t to = collapses[i].to;
+
+			if(touched[from] || touched[to]) continue;
+
+			if(aga_build_collapse_flips(inds, &adj, verts, from, to)) {
+				continue;
+			}
+
+			/*
+			 * Anything sharing a face with `from' sees its faces change so
+			 * It has to wait for the next pass.
+			 */
+			for(j = adj.offsets[from]; j < adj.offsets[from + 1]; ++j) {
+				aga_uint_t* tri = &inds[3 * adj.faces[j]];
+				aga_bool_t degenerate = AGA_FALSE;
+
+				for(k = 0; k < 3; ++k) {
+					touched[tri[k]] = AGA_TRUE;
+					if(tri[k] == to) degenerate = AGA_TRUE;
+				}
+
+				for(k = 0; k < 3; ++k) if(tri[k] == from) tri[k] = to;
+
+				if(degenerate) --tris;
+			}
+
+			for(k = 0; k < 10; ++k) {
+				quadrics[10 * to + k] += quadrics[10 * from + k];
+			}
+
+			++done;
+		}
+
+		/* Drop the faces collapses have flattened. */
+		for(i = 0, j = 0; i < *count / 3; ++i) {
+			const aga_uint_t* tri = &inds[3 * i];
+
+			if(tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+				continue;
+			}
+
+			if(i != j) aga_memcpy(&inds[3 * j], tri, 3 * sizeof(aga_uint_t));
+			++j;
+		}
+
+		*count = 3 * j;
+		tris = j;
+
+		if(!done) break;
+	}
+
+	cleanup: {
+		aga_build_adjacency_delete(&adj);
+		aga_free(collapses);
+		aga_free(quadrics);
+		aga_free(locked);
+		aga_free(touched);
+
+		return result;
+	}
+}
+
+/*
+ * Writes the vertex buffer of a version 4 model. UVs are quantised against
+ * Their own extents as they commonly run outside 0-1 for tiling.
+ */
+static enum aga_result aga_build_obj_quantised(
+		void* out, const struct aga_model_vertex* verts, aga_uint_t len,
+		struct aga_build_meta* meta) {
+
+	enum aga_result result;
+
+	struct aga_packed_vertex* packed;
+	float* uv = meta->uv_extent;
+	const float* ext = meta->extent;
+	aga_uint_t i, j;
+
+	if(!(packed = aga_calloc(len + 1, sizeof(struct aga_packed_vertex)))) {
+		return AGA_RESULT_OOM;
+	}
+
+	for(i = 0; i < len; ++i) {
+		for(j = 0; j < 2; ++j) {
+			if(!i || verts[i].uv[j] < uv[j]) uv[j] = verts[i].uv[j];
+			if(!i || verts[i].uv[j] > uv[j + 2]) uv[j + 2] = verts[i].uv[j];
+		}
+	}
+
+	for(i = 0; i < len; ++i) {
+		const struct aga_model_vertex* v = &verts[i];
+		struct aga_packed_vertex* p = &packed[i];
+
+		for(j = 0; j < 3; ++j) {
+			p->pos[j] = aga_build_quantise(v->pos[j], ext[j], ext[j + 3]);
+			p->norm[j] = aga_build_quantise_norm(v->norm[j]);
+		}
+
+		for(j = 0; j < 2; ++j) {
+			p->uv[j] = aga_build_quantise(v->uv[j], uv[j], uv[j + 2]);
+		}
+	}
+
+	result = aga_build_write(
+			out, packed, len * sizeof(struct aga_packed_vertex));
+
+	aga_free(packed);
+
+	return result;
+}
+
+static enum aga_result aga_build_obj_indices(
+		void* out, const aga_uint_t* inds, aga_size_t count,
+		aga_uint_t index_size) {
+
+	enum aga_result result;
+
+	aga_ushort_t* short_inds;
+	aga_size_t i;
+
+	if(index_size == 4) {
+		return aga_build_write(out, inds, count * sizeof(aga_uint_t));
+	}
+
+	if(!(short_inds = aga_malloc((count + 1) * sizeof(aga_ushort_t)))) {
+		return AGA_RESULT_OOM;
+	}
+
+	for(i = 0; i < count; ++i) short_inds[i] = (aga_ushort_t) inds[i];
+
+	result = aga_build_write(out, short_inds, count * sizeof(aga_ushort_t));
+
+	aga_free(short_inds);
+
+	return result;
+}
+
+static enum aga_result aga_build_obj(
+		void* out, void* in, aga_uint_t options, struct aga_build_meta* meta) {
+
+	enum aga_result result = AGA_RESULT_OK;
+
+	GLMmodel* model;
+	GLMgroup* group;
+
+	struct aga_build_weld weld = { 0 };
+	aga_uint_t* inds = 0;
+	aga_uint_t* lod_inds = 0;
+	aga_uint_t* prev_inds = 0;
+	aga_size_t count = 0, lod_count;
+	aga_size_t size;
+	aga_uint_t i, j, k;
+	aga_uint_t lods = (options & AGA_BUILD_LOD_MASK) >> AGA_BUILD_LOD_SHIFT;
+
+	if(!(model = glmReadOBJFile(AGA_BUILD_FNAME, in))) {
+		/* TODO: Handle different EH. */
+		return AGA_RESULT_OOM;
+	}
+
+	glmExtent(model, meta->extent);
+
+	for(group = model->groups; group; group = group->next) {
+		count += 3 * group->ntris;
+	}
+
+	/* Leave the table at most half full. */
+	for(size = 16; size < count * 2; size <<= 1) continue;
+	weld.mask = size - 1;
+
+	weld.verts = aga_malloc((count + 1) * sizeof(struct aga_model_vertex));
+	weld.table = aga_calloc(size, sizeof(aga_uint_t));
+	inds = aga_malloc((count + 1) * sizeof(aga_uint_t));
+	if(!weld.verts || !weld.table || !inds) {
+		result = AGA_RESULT_OOM;
+		goto cleanup;
+	}
+
+	for(group = model->groups, k = 0; group; group = group->next) {
+		const GLMtriangle* tris = model->tris;
+		const float* norms = model->norms;
+		const float* uvs = model->uvs;
+		const float* verts = model->verts;
+
+		for(i = 0; i < group->ntris; i++) {
+			const GLMtriangle* t = &tris[group->tris[i]];
+
+			for(j = 0; j < 3; ++j) {
+				struct aga_model_vertex v;
+
+				/* Keep any padding stable for the hash and compare. */
+				aga_bzero(&v, sizeof(v));
+
+				aga_memcpy(v.norm, &norms[3 * t->n_inds[j]], sizeof(v.norm));
+				aga_memcpy(v.uv, &uvs[2 * t->t_inds[j]], sizeof(v.uv));
+				aga_memcpy(v.pos, &verts[3 * t->v_inds[j]], sizeof(v.pos));
+
+				inds[k++] = aga_build_weld_add(&weld, &v);
+			}
+		}
+	}
+
+	if((result = aga_build_vcache_optimise(inds, count, weld.len))) {
+		goto cleanup;
+	}
+
+	if(options & AGA_BUILD_OVERDRAW) {
+		result = aga_build_overdraw_optimise(
+				inds, count, weld.verts, weld.len);
+		if(result) goto cleanup;
+	}
+
+	result = aga_build_vfetch_optimise(inds, count, weld.verts, weld.len);
+	if(result) goto cleanup;
+
+	meta->vertices = weld.len;
+	meta->indices = (aga_uint_t) count;
+	meta->index_size = weld.len > 0xFFFF + 1 ? 4 : 2;
+
+	if(options & AGA_BUILD_QUANTISE) {
+		meta->model_version = 4;
+
+		result = aga_build_obj_quantised(out, weld.verts, weld.len, meta);
+		if(result) goto cleanup;
+	}
+	else {
+		meta->model_version = 3;
+
+		size = weld.len * sizeof(struct aga_model_vertex);
+		if((result = aga_build_write(out, weld.verts, size))) goto cleanup;
+	}
+
+	result = aga_build_obj_indices(out, inds, count, meta->index_size);
+	if(result) goto cleanup;
+
+	/* Each level halves the one before it. */
+	lod_count = count;
+	for(i = 0; i < lods; ++i) {
+		if(!(lod_inds = aga_malloc((lod_count + 1) * sizeof(aga_uint_t)))) {
+			result = AGA_RESULT_OOM;
+			goto cleanup;
+		}
+
+		aga_memcpy(
+				lod_inds, i ? prev_inds : inds, lod_count * sizeof(aga_uint_t));
+
+		result = aga_build_decimate(
+				lod_inds, &lod_count, weld.verts, weld.len, lod_count / 6);
+		if(result) goto cleanup;
+
+		result = aga_build_vcache_optimise(lod_inds, lod_count, weld.len);
+		if(result) goto cleanup;
+
+		result = aga_build_obj_indices(
+				out, lod_inds, lod_count, meta->index_size);
+		if(result) goto cleanup;
+
+		meta->lod_indices[i] = (aga_uint_t) lod_count;
+		meta->lods = i + 1;
+
+		aga_free(prev_inds);
+		prev_inds = lod_inds;
+		lod_inds = 0;
+	}
+
+	cleanup: {
+		aga_free(lod_inds);
+		aga_free(prev_inds);
+		aga_free(inds);
+		aga_free(weld.table);
+		aga_free(weld.verts);
+
+		glmDelete(model);
+
+		return result;
+	}
+}
+
+static aga_bool_t aga_build_is_pow2(aga_uint_t n) {
+	return n && !(n & (n - 1));
+}
+
+/*
+ * Halves an RGBA8 level in each dimension (down to 1). The tent filter
+ * Weights a 4x4 footprint 1-3-3-1 per axis, which is noticeably smoother
+ * Than GLU's 2x2 box when minifying.
+ */
+static void aga_build_downsample(
+		const aga_uchar_t* in, aga_uint_t w, aga_uint_t h, aga_uchar_t* out,
+		aga_bool_t tent) {
+
+	static const int taps[] = { -1, 0, 1, 2 };
+	static const unsigned weights[] = { 1, 3, 3, 1 };
+
+	aga_uint_t ow = w > 1 ? w / 2 : 1;
+	aga_uint_t oh = h > 1 ? h / 2 : 1;
+	aga_uint_t x, y, c;
+	int i, j;
+
+	for(y = 0; y < oh; ++y) {
+		for(x = 0; x < ow; ++x) {
+			for(c = 0; c < 4; ++c) {
+				unsigned sum = 0, total = 0;
+
+				for(j = 0; j < 4; ++j) {
+					int sy = (int) (2 * y) + taps[j];
+
+					if(!tent && (j == 0 || j == 3)) continue;
+
+					if(sy < 0) sy = 0;
+					if(sy >= (int) h) sy = (int) h - 1;
+
+					for(i = 0; i < 4; ++i) {
+						int sx = (int) (2 * x) + taps[i];
+						unsigned wt;
+
+						if(!tent && (i == 0 || i == 3)) continue;
+
+						if(sx < 0) sx = 0;
+						if(sx >= (int) w) sx = (int) w - 1;
+
+						wt = tent ? weights[i] * weights[j] : 1;
+
+						sum += wt * in[4 * ((aga_size_t) sy * w + sx) + c];
+						total += wt;
+					}
+				}
+
+				out[4 * ((aga_size_t) y * ow + x) + c] =
+						(aga_uchar_t) ((sum + total / 2) / total);
+			}
+		}
+	}
+}
+
+/*
+ * NOTE: Textures are stored in the pack in whichever format the input asks
+ * 		 For (`Format' in the build file) -- by default opaque images drop
+ * 		 Their alpha channel and greyscale ones their colour. Paletted
+ * 		 Textures use a median cut over a sample of the base level, the
+ * 		 Palette is then shared by every level of the chain.
+ */
+struct aga_build_texture {
+	enum aga_texture_format format;
+
+	aga_uchar_t palette[AGA_PALETTE_SIZE];
+	aga_uint_t colours;
+
+	/* Nearest palette entry by 5:5:5:3 colour, -1 if not yet known. */
+	aga_sshort_t* lookup;
+};
+
+#define AGA_BUILD_PALETTE_SAMPLES (65536)
+
+static const aga_uchar_t* aga_build_sort_pixels;
+static int aga_build_sort_channel;
+
+static int aga_build_sort_cmp(const void* a, const void* b) {
+	const aga_uchar_t* pixels = aga_build_sort_pixels;
+	int c = aga_build_sort_channel;
+
+	return (int) pixels[4 * *(const aga_uint_t*) a + c] -
+			(int) pixels[4 * *(const aga_uint_t*) b + c];
+}
+
+static enum aga_result aga_build_palette(
+		struct aga_build_texture* tex, const aga_uchar_t* rgba,
+		aga_size_t count) {
+
+	struct aga_build_box {
+		aga_size_t start;
+		aga_size_t len;
+	} boxes[256];
+
+	aga_uint_t* order;
+	aga_size_t stride = count / AGA_BUILD_PALETTE_SAMPLES + 1;
+	aga_size_t len = 0;
+	aga_size_t i, j, k;
+	aga_uint_t nboxes = 1;
+
+	if(!(order = aga_malloc((count / stride + 1) * sizeof(aga_uint_t)))) {
+		return AGA_RESULT_OOM;
+	}
+
+	for(i = 0; i < count; i += stride) order[len++] = (aga_uint_t) i;
+
+	boxes[0].start = 0;
+	boxes[0].len = len;
+
+	/* Repeatedly halve the box with the widest channel at its median. */
+	while(nboxes < 256) {
+		int best_range = 0, best_channel = 0;
+		aga_uint_t best = 0;
+
+		for(i = 0; i < nboxes; ++i) {
+			int lo[4] = { 255, 255, 255, 255 };
+			int hi[4] = { 0, 0, 0, 0 };
+
+			if(boxes[i].len < 2) continue;
+
+			for(j = boxes[i].start; j < boxes[i].start + boxes[i].len; ++j) {
+				for(k = 0; k < 4; ++k) {
+					int v = rgba[4 * order[j] + k];
+
+					if(v < lo[k]) lo[k] = v;
+					if(v > hi[k]) hi[k] = v;
+				}
+			}
+
+			for(k = 0; k < 4; ++k) {
+				if(hi[k] - lo[k] > best_range) {
+					best_range = hi[k] - lo[k];
+					best_channel = (int) k;
+					best = (aga_uint_t) i;
+				}
+			}
+		}
+
+		/* Every box is a single colour already. */
+		if(!best_range) break;
+
+		aga_build_sort_pixels = rgba;
+		aga_build_sort_channel = best_channel;
+
+		qsort(
+				&order[boxes[best].start], boxes[best].len, sizeof(aga_uint_t),
+				aga_build_sort_cmp);
+
+		boxes[nboxes].start = boxes[best].start + boxes[best].len / 2;
+		boxes[nboxes].len = boxes[best].len - boxes[best].len / 2;
+		boxes[best].len /= 2;
+
+		++nboxes;
+	}
+
+	for(i = 0; i < nboxes; ++i) {
+		for(k = 0; k < 4; ++k) {
+			aga_size_t sum = 0;
+
+			for(j = boxes[i].start; j < boxes[i].start + boxes[i].len; ++j) {
+				sum += rgba[4 * order[j] + k];
+			}
+
+			tex->palette[4 * i + k] =
+					(aga_uchar_t) ((sum + boxes[i].len / 2) / boxes[i].len);
+		}
+	}
+
+	tex->colours = nboxes;
+
+	aga_free(order);
+
+	if(!(tex->lookup = aga_malloc((1 << 18) * sizeof(aga_sshort_t)))) {
+		return AGA_RESULT_OOM;
+	}
+
+	for(i = 0; i < (1 << 18); ++i) tex->lookup[i] = -1;
+
+	return AGA_RESULT_OK;
+}
+
+static aga_uchar_t aga_build_palette_index(
+		struct aga_build_texture* tex, const aga_uchar_t* px) {
+
+	aga_size_t key = (aga_size_t) (px[0] >> 3) << 13 |
+			(aga_size_t) (px[1] >> 3) << 8 |
+			(aga_size_t) (px[2] >> 3) << 3 | (px[3] >> 5);
+
+	aga_uint_t i, k;
+	long best_dist = LONG_MAX;
+
+	if(tex->lookup[key] != -1) return (aga_uchar_t) tex->lookup[key];
+
+	for(i = 0; i < tex->colours; ++i) {
+		long dist = 0;
+
+		for(k = 0; k < 4; ++k) {
+			long d = (long) px[k] - (long) tex->palette[4 * i + k];
+			dist += d * d;
+		}
+
+		if(dist < best_dist) {
+			best_dist = dist;
+			tex->lookup[key] = (aga_sshort_t) i;
+		}
+	}
+
+	return (aga_uchar_t) tex->lookup[key];
+}
+
+/* Picks a format which loses nothing from the image. */
+static enum aga_texture_format aga_build_texture_detect(
+		const aga_uchar_t* rgba, aga_size_t count) {
+
+	aga_bool_t opaque = AGA_TRUE;
+	aga_bool_t grey = AGA_TRUE;
+	aga_size_t i;
+
+	for(i = 0; i < count && (opaque || grey); ++i) {
+		const aga_uchar_t* px = &rgba[4 * i];
+
+		if(px[3] != 0xFF) opaque = AGA_FALSE;
+		if(px[0] != px[1] || px[1] != px[2]) grey = AGA_FALSE;
+	}
+
+	if(opaque && grey) return AGA_FORMAT_LUMINANCE;
+	if(opaque) return AGA_FORMAT_RGB888;
+
+	return AGA_FORMAT_RGBA8888;
+}
+
+/* Writes one level of RGBA8 texels out in the texture's format. */
+static enum aga_result aga_build_texture_level(
+		void* out, struct aga_build_texture* tex, const aga_uchar_t* rgba,
+		aga_uint_t w, aga_uint_t h) {
+
+	enum aga_result result;
+
+	aga_size_t count = (aga_size_t) w * h;
+	aga_size_t size = aga_texture_format_size(tex->format);
+	aga_uchar_t* buf;
+	aga_size_t i;
+
+	if(tex->format == AGA_FORMAT_RGBA8888) {
+		return aga_build_write(out, rgba, 4 * count);
+	}
+
+	if(!(buf = aga_malloc(size * count + 1))) return AGA_RESULT_OOM;
+
+	for(i = 0; i < count; ++i) {
+		const aga_uchar_t* px = &rgba[4 * i];
+		aga_uchar_t* dst = &buf[size * i];
+		aga_ushort_t v;
+
+		switch(tex->format) {
+			default: break;
+
+			case AGA_FORMAT_RGB888: {
+				aga_memcpy(dst, px, 3);
+				break;
+			}
+
+			case AGA_FORMAT_RGB565: {
+				v = (aga_ushort_t) ((px[0] >> 3) << 11 | (px[1] >> 2) << 5 |
+						px[2] >> 3);
+				aga_memcpy(dst, &v, sizeof(v));
+				break;
+			}
+
+			case AGA_FORMAT_RGBA4444: {
+				v = (aga_ushort_t) ((px[0] >> 4) << 12 | (px[1] >> 4) << 8 |
+						(px[2] >> 4) << 4 | px[3] >> 4);
+				aga_memcpy(dst, &v, sizeof(v));
+				break;
+			}
+
+			case AGA_FORMAT_LUMINANCE: {
+				*dst = (aga_uchar_t) ((77 * px[0] + 150 * px[1] +
+						29 * px[2] + 128) >> 8);
+				break;
+			}
+
+			case AGA_FORMAT_PALETTED: {
+				*dst = aga_build_palette_index(tex, px);
+				break;
+			}
+		}
+	}
+
+	result = aga_build_write(out, buf, size * count);
+
+	aga_free(buf);
+
+	return result;
+}
+
+/* Appends every level below the one in `raster' down to 1x1. */
+static enum aga_result aga_build_mipmap(
+		void* out, struct aga_build_texture* tex, const aga_uchar_t* raster,
+		aga_uint_t w, aga_uint_t h, aga_bool_t tent, aga_uint_t* levels) {
+
+	enum aga_result result = AGA_RESULT_OK;
+
+	aga_uchar_t* prev;
+	aga_uchar_t* next;
+
+	*levels = 1;
+
+	/* Each level is at most a quarter of the last. */
+	prev = aga_malloc(4 * (aga_size_t) (w / 2 + 1) * (h / 2 + 1));
+	next = aga_malloc(4 * (aga_size_t) (w / 2 + 1) * (h / 2 + 1));
+	if(!prev || !next) {
+		result = AGA_RESULT_OOM;
+		goto cleanup;
+	}
+
+	while(w > 1 || h > 1) {
+		aga_uchar_t* swap;
+
+		aga_build_downsample(raster, w, h, next, tent);
+
+		if(w > 1) w /= 2;
+		if(h > 1) h /= 2;
+
+		result = aga_build_texture_level(out, tex, next, w, h);
+		if(result) goto cleanup;
+
+		++*levels;
+
+		swap = prev;
+		prev = next;
+		next = swap;
+		raster = prev;
+	}
+
+	cleanup: {
+		aga_free(next);
+		aga_free(prev);
+
+		return result;
+	}
+}
+
+static enum aga_result aga_build_tiff(
+		void* out, void* in, aga_uint_t options, struct aga_build_meta* meta) {
+
+	/* NOTE: TIFF wants this -- this is kind of evil. */
+	static char msg[1024];
+
+	enum aga_result result = AGA_RESULT_OK;
+
+	int fd;
+
+	TIFF* tiff;
+	TIFFRGBAImage img = { 0 };
+
+	struct aga_build_texture tex = { 0 };
+
+	aga_size_t size, count;
+	void* raster = 0;
+
+	tex.format = (enum aga_texture_format) (
+			(options & AGA_BUILD_FORMAT_MASK) >> AGA_BUILD_FORMAT_SHIFT);
+
+	if((fd = fileno(in)) == -1) return aga_error_system(__FILE__, "fileno");
+
+	if(!(tiff = TIFFFdOpen(fd, AGA_BUILD_FNAME, "r"))) return AGA_RESULT_ERROR;
+
+	if(!TIFFRGBAImageBegin(&img, tiff, 0, msg)) {
+		aga_log(__FILE__, "err: Failed to read TIFF file: %s", msg);
+		result = AGA_RESULT_ERROR;
+		goto cleanup;
+	}
+
+	count = img.width * img.height;
+	size = 4 * count;
+	if(!(raster = aga_malloc(size))) {
+		result = aga_error_system(__FILE__, "aga_malloc");
+		goto cleanup;
+	}
+
+	if(!TIFFRGBAImageGet(&img, raster, img.width, img.height)) {
+		result = AGA_RESULT_ERROR;
+		goto cleanup;
+	}
+
+	if(tex.format == AGA_FORMAT_AUTO) {
+		tex.format = aga_build_texture_detect(raster, count);
+	}
+
+	if(tex.format == AGA_FORMAT_PALETTED) {
+		if((result = aga_build_palette(&tex, raster, count))) goto cleanup;
+
+		result = aga_build_write(out, tex.palette, sizeof(tex.palette));
+		if(result) goto cleanup;
+	}
+
+	result = aga_build_texture_level(
+			out, &tex, raster, img.width, img.height);
+	if(result) goto cleanup;
+
+	meta->width = img.width;
+	meta->height = img.height;
+	meta->levels = 1;
+	meta->format = tex.format;
+
+	if(options & AGA_BUILD_MIPMAP) {
+		aga_bool_t tent = !(options & AGA_BUILD_MIP_BOX);
+
+		/* GL wants these rescaled first -- leave it to `gluBuild2DMipmaps'. */
+		if(!aga_build_is_pow2(img.width) || !aga_build_is_pow2(img.height)) {
+			aga_log(
+					__FILE__,
+					"warn: Not generating mipmaps for %ux%u texture -- "
+					"Dimensions must be powers of two",
+					img.width, img.height);
+		}
+		else {
+			result = aga_build_mipmap(
+					out, &tex, raster, img.width, img.height, tent,
+					&meta->levels);
+			if(result) goto cleanup;
+		}
+	}
+
+	cleanup: {
+		aga_free(tex.lookup);
+		aga_free(raster);
+		TIFFRGBAImageEnd(&img);
+		TIFFClose(tiff, 0);
+	}
+
+	return result;
+}
+
+/*
+ * Only artefacts which are loaded whole through `aga_resource_new' may be
+ * Encoded -- everything else is consumed through a stream onto the pack.
+ */
+static aga_bool_t aga_build_kind_compressible(enum aga_file_kind kind) {
+	return kind == AGA_KIND_TIFF;
+}
+
+/* Input kinds whose artefact is just the input file itself. */
+static aga_bool_t aga_build_kind_raw(enum aga_file_kind kind) {
+	return kind == AGA_KIND_SGML || kind == AGA_KIND_RAW;
+}
+
+static aga_bool_t aga_build_path_matches_kind(
+		const char* path, enum aga_file_kind kind) {
+
+	/*
+	 * TODO: Reduce all paths to within basic FAT restrictions -- including our
+	 * 		 Source tree!
+	 */
+	static const char* kind_exts[] = {
+			"", /* AGA_KIND_NONE */
+			".raw", /* AGA_KIND_RAW */
+			".tiff", /* AGA_KIND_TIFF */
+			".obj", /* AGA_KIND_OBJ */
+			".sgml", /* AGA_KIND_SGML */
+			".py", /* AGA_KIND_PY */
+			".wav", /* AGA_KIND_WAV */
+			".mid", /* AGA_KIND_MIDI */
+			".scene" /* AGA_KIND_SCENE */
+	};
+
+	/* TODO: `strcasecmp'? */
+	const char* ext = strrchr(path, '.');
+	if(!ext || !aga_streql(ext, kind_exts[kind])) return AGA_FALSE;
+
+	return AGA_TRUE;
+}
+
+/*
+ * Bump the relevant entry whenever a converter's output changes so stale
+ * Artefacts get rebuilt.
+ */
+static aga_uint_t aga_build_kind_version(enum aga_file_kind kind) {
+	static const aga_uint_t kind_versions[] = {
+			2, /* AGA_KIND_NONE -- the build file, bump to force a repack. */
+			1, /* AGA_KIND_RAW */
+			4, /* AGA_KIND_TIFF */
+			8, /* AGA_KIND_OBJ */
+			1, /* AGA_KIND_SGML */
+			1, /* AGA_KIND_PY */
+			1, /* AGA_KIND_WAV */
+			1, /* AGA_KIND_MIDI */
+			2 /* AGA_KIND_SCENE */
+	};
+
+	return kind_versions[kind];
+}
+
+/*
+ * Writes the kind-specific part of an artefact's metadata as config items.
+ * Shared between pack entries and the build cache.
+ */
+static enum aga_result aga_build_meta_write(
+		void* fp, aga_size_t indent, enum aga_file_kind kind,
+		const struct aga_build_meta* meta) {
+
+	enum aga_result result;
+
+	/* Unpleasant but neccesary. */
+#define agab_(name, type, fmt, param) \
+		do { \
+			result = aga_fprintf_add( \
+					fp, indent, \
+					"<item name=\"%s\" type=\"%s\">\n", name, type); \
+			if(result) return result; \
+			\
+			result = aga_fprintf_add(fp, indent + 1, fmt "\n", param); \
+			if(result) return result; \
+			\
+			result = aga_fprintf_add(fp, indent, "</item>\n"); \
+			if(result) return result; \
+		} while(0)
+
+	switch(kind) {
+		default: break;
+
+		case AGA_KIND_TIFF: {
+			agab_("Width", "Integer", "%u", meta->width);
+			agab_("Height", "Integer", "%u", meta->height);
+			agab_("Levels", "Integer", "%u", meta->levels);
+			agab_(
+					"Format", "String", "%s",
+					aga_texture_formats[meta->format]);
+			break;
+		}
+
+		case AGA_KIND_OBJ: {
+			/* Dequantisation uses these so they must round-trip exactly. */
+			agab_("MinX", "Float", "%.9g", meta->extent[0]);
+			agab_("MinY", "Float", "%.9g", meta->extent[1]);
+			agab_("MinZ", "Float", "%.9g", meta->extent[2]);
+			agab_("MaxX", "Float", "%.9g", meta->extent[3]);
+			agab_("MaxY", "Float", "%.9g", meta->extent[4]);
+			agab_("MaxZ", "Float", "%.9g", meta->extent[5]);
+
+			if(meta->model_version >= 4) {
+				agab_("MinU", "Float", "%.9g", meta->uv_extent[0]);
+				agab_("MinV", "Float", "%.9g", meta->uv_extent[1]);
+				agab_("MaxU", "Float", "%.9g", meta->uv_extent[2]);
+				agab_("MaxV", "Float", "%.9g", meta->uv_extent[3]);
+			}
+
+			agab_("Vertices", "Integer", "%u", meta->vertices);
+			agab_("Indices", "Integer", "%u", meta->indices);
+			agab_("IndexSize", "Integer", "%u", meta->index_size);
+			agab_("Lods", "Integer", "%u", meta->lods);
+
+			if(meta->lods >= 1) {
+				agab_("Lod1Indices", "Integer", "%u", meta->lod_indices[0]);
+			}
+
+			if(meta->lods >= 2) {
+				agab_("Lod2Indices", "Integer", "%u", meta->lod_indices[1]);
+			}
+
+			/*
+			 * Version 3 models are welded vertices without colour drawn
+			 * Through an index buffer, version 4 also quantises them.
+			 */
+			agab_("Version", "Integer", "%u", meta->model_version);
+
+			break;
+		}
+	}
+
+#undef agab_
+
+	return AGA_RESULT_OK;
+}
+
+/* The inverse of `aga_build_meta_write' -- returns false for other nodes. */
+static aga_bool_t aga_build_meta_read(
+		struct aga_config_node* node, struct aga_build_meta* meta) {
+
+	static const char* extents[] = {
+			"MinX", "MinY", "MinZ", "MaxX", "MaxY", "MaxZ"
+	};
+	static const char* uv_extents[] = { "MinU", "MinV", "MaxU", "MaxV" };
+
+	aga_slong_t v;
+	double f;
+	const char* str;
+	aga_size_t i;
+
+	if(aga_config_variable("Width", node, AGA_INTEGER, &v)) {
+		meta->width = (aga_uint_t) v;
+		return AGA_TRUE;
+	}
+	else if(aga_config_variable("Height", node, AGA_INTEGER, &v)) {
+		meta->height = (aga_uint_t) v;
+		return AGA_TRUE;
+	}
+	else if(aga_config_variable("Levels", node, AGA_INTEGER, &v)) {
+		meta->levels = (aga_uint_t) v;
+		return AGA_TRUE;
+	}
+	else if(aga_config_variable("Format", node, AGA_STRING, &str)) {
+		for(i = 0; i <= AGA_FORMAT_PALETTED; ++i) {
+			if(aga_streql(str, aga_texture_formats[i])) {
+				meta->format = (enum aga_texture_format) i;
+			}
+		}
+
+		return AGA_TRUE;
+	}
+	else if(aga_config_variable("Vertices", node, AGA_INTEGER, &v)) {
+		meta->vertices = (aga_uint_t) v;
+		return AGA_TRUE;
+	}
+	else if(aga_config_variable("Indices", node, AGA_INTEGER, &v)) {
+		meta->indices = (aga_uint_t) v;
+		return AGA_TRUE;
+	}
+	else if(aga_config_variable("Lods", node, AGA_INTEGER, &v)) {
+		meta->lods = (aga_uint_t) v;
+		return AGA_TRUE;
+	}
+	else if(aga_config_variable("Lod1Indices", node, AGA_INTEGER, &v)) {
+		meta->lod_indices[0] = (aga_uint_t) v;
+		return AGA_TRUE;
+	}
+	else if(aga_config_variable("Lod2Indices", node, AGA_INTEGER, &v)) {
+		meta->lod_indices[1] = (aga_uint_t) v;
+		return AGA_TRUE;
+	}
+	else if(aga_config_variable("IndexSize", node, AGA_INTEGER, &v)) {
+		meta->index_size = (aga_uint_t) v;
+		return AGA_TRUE;
+	}
+	else if(aga_config_variable("Version", node, AGA_INTEGER, &v)) {
+		meta->model_version = (aga_uint_t) v;
+		return AGA_TRUE;
+	}
+
+	for(i = 0; i < AGA_LEN(extents); ++i) {
+		if(aga_config_variable(extents[i], node, AGA_FLOAT, &f)) {
+			meta->extent[i] = (float) f;
+			return AGA_TRUE;
+		}
+	}
+
+	for(i = 0; i < AGA_LEN(uv_extents); ++i) {
+		if(aga_config_variable(uv_extents[i], node, AGA_FLOAT, &f)) {
+			meta->uv_extent[i] = (float) f;
+			return AGA_TRUE;
+		}
+	}
+
+	return AGA_FALSE;
+}
+
+/* A quiet check -- missing artefacts are an expected state here. */
+static aga_bool_t aga_build_exists(const char* path) {
+	void* fp;
+
+	if(!(fp = fopen(path, "rb"))) return AGA_FALSE;
+	if(fclose(fp) == EOF) (void) aga_error_system(__FILE__, "fclose");
+
+	return AGA_TRUE;
+}
+
+/* FNV-1a over the whole file. */
+static enum aga_result aga_build_hash_file(const char* path, aga_uint_t* out) {
+	static aga_fixed_buf_t buf = { 0 };
+
+	aga_uint_t hash = 2166136261U;
+	void* fp;
+	aga_size_t i, n;
+
+	if(!(fp = fopen(path, "rb"))) {
+		return aga_error_system_path(__FILE__, "fopen", path);
+	}
+
+	while((n = fread(buf, 1, sizeof(buf), fp))) {
+		for(i = 0; i < n; ++i) {
+			hash ^= (aga_uchar_t) buf[i];
+			hash *= 16777619U;
+		}
+	}
+
+	if(ferror(fp)) {
+		if(fclose(fp) == EOF) (void) aga_error_system(__FILE__, "fclose");
+		return aga_error_system(__FILE__, "fread");
+	}
+
+	if(fclose(fp) == EOF) return aga_error_system(__FILE__, "fclose");
+
+	*out = hash & 0xFFFFFFFFU;
+
+	return AGA_RESULT_OK;
+}
+
+/*
+ * NOTE: The build cache remembers what each input file looked like when its
+ * 		 Artefact was last produced so unchanged inputs can skip conversion,
+ * 		 And so the pack itself need not be reassembled when nothing in it
+ * 		 Would change. It lives alongside the output as `<Output>.cache' and
+ * 		 Is just deleted to force a clean build.
+ */
+struct aga_build_record {
+	char* path;
+
+	enum aga_file_kind kind;
+	aga_time_t modified;
+	aga_size_t length;
+	aga_uint_t hash;
+	aga_uint_t version; /* Converter version, see `aga_build_kind_version'. */
+	aga_uint_t options;
+	aga_bool_t compress;
+
+	struct aga_build_meta meta;
+
+	aga_bool_t seen; /* Visited during this build. */
+};
+
+struct aga_build_cache {
+	char* path;
+
+	struct aga_build_record* records;
+	aga_size_t len;
+
+	/* Open-addressed on path like pack indices, holds `records' index + 1. */
+	aga_size_t* index;
+	aga_size_t index_len;
+
+	aga_bool_t changed; /* Something in the pack needs rebuilding. */
+};
+
+static enum aga_result aga_build_cache_index(struct aga_build_cache* cache) {
+	aga_size_t i;
+	aga_size_t mask;
+
+	aga_free(cache->index);
+
+	cache->index_len = 16;
+	while(cache->index_len < cache->len * 2) cache->index_len <<= 1;
+
+	cache->index = aga_calloc(cache->index_len, sizeof(aga_size_t));
+	if(!cache->index) return AGA_RESULT_OOM;
+
+	mask = cache->index_len - 1;
+
+	for(i = 0; i < cache->len; ++i) {
+		aga_size_t j = aga_strhash(cache->records[i].path) & mask;
+
+		while(cache->index[j]) j = (j + 1) & mask;
+
+		cache->index[j] = i + 1;
+	}
+
+	return AGA_RESULT_OK;
+}
+
+static struct aga_build_record* aga_build_cache_find(
+		struct aga_build_cache* cache, const char* path) {
+
+	aga_size_t i;
+	aga_size_t mask = cache->index_len - 1;
+
+	for(i = aga_strhash(path) & mask; cache->index[i]; i = (i + 1) & mask) {
+		struct aga_build_record* record = &cache->records[cache->index[i] - 1];
+
+		if(aga_streql(record->path, path)) return record;
+	}
+
+	return 0;
+}
+
+static enum aga_result aga_build_cache_add(
+		struct aga_build_cache* cache, const char* path,
+		struct aga_build_record** out) {
+
+	enum aga_result result;
+
+	struct aga_build_record* record;
+	aga_size_t size = (cache->len + 1) * sizeof(struct aga_build_record);
+
+	if(!(record = aga_realloc(cache->records, size))) return AGA_RESULT_OOM;
+	cache->records = record;
+
+	record = &cache->records[cache->len];
+	aga_bzero(record, sizeof(struct aga_build_record));
+
+	if(!(record->path = aga_strdup(path))) return AGA_RESULT_OOM;
+
+	++cache->len;
+
+	if(cache->len * 2 > cache->index_len) {
+		if((result = aga_build_cache_index(cache))) return result;
+	}
+	else {
+		aga_size_t mask = cache->index_len - 1;
+		aga_size_t i = aga_strhash(path) & mask;
+
+		while(cache->index[i]) i = (i + 1) & mask;
+
+		cache->index[i] = cache->len;
+	}
+
+	*out = record;
+
+	return AGA_RESULT_OK;
+}
+
+static enum aga_result aga_build_cache_new(
+		struct aga_build_cache* cache, const char* output) {
+
+	enum aga_result result;
+
+	struct aga_config_node root;
+	struct aga_config_node* items;
+	aga_size_t i, j;
+
+	aga_bzero(cache, sizeof(struct aga_build_cache));
+	aga_bzero(&root, sizeof(struct aga_config_node));
+
+	cache->path = aga_malloc(aga_strlen(output) + sizeof(".cache"));
+	if(!cache->path) return AGA_RESULT_OOM;
+
+	strcpy(cache->path, output);
+	strcat(cache->path, ".cache");
+
+	if((result = aga_build_cache_index(cache))) return result;
+
+	if(!aga_build_exists(cache->path)) {
+		aga_log(__FILE__, "No build cache found -- building everything");
+		cache->changed = AGA_TRUE;
+		return AGA_RESULT_OK;
+	}
+
+	if((result = aga_build_open_config(cache->path, &root))) goto discard;
+
+	if(!root.len) {
+		result = AGA_RESULT_BAD_PARAM;
+		goto discard;
+	}
+
+	items = root.children;
+
+	for(i = 0; i < items->len; ++i) {
+		struct aga_config_node* item = &items->children[i];
+		struct aga_build_record* record;
+
+		if(!item->name) continue;
+
+		if((result = aga_build_cache_add(cache, item->name, &record))) {
+			goto discard;
+		}
+
+		for(j = 0; j < item->len; ++j) {
+			struct aga_config_node* child = &item->children[j];
+			struct aga_build_meta* meta = &record->meta;
+
+			aga_slong_t v;
+			const char* str;
+
+			if(aga_config_variable("Kind", child, AGA_INTEGER, &v)) {
+				record->kind = (enum aga_file_kind) v;
+			}
+			else if(aga_config_variable("Modified", child, AGA_INTEGER, &v)) {
+				record->modified = (aga_time_t) v;
+			}
+			else if(aga_config_variable("Length", child, AGA_INTEGER, &v)) {
+				record->length = (aga_size_t) v;
+			}
+			else if(aga_config_variable("Hash", child, AGA_STRING, &str)) {
+				record->hash = (aga_uint_t) strtoul(str, 0, 16);
+			}
+			else if(aga_config_variable(
+					"Converter", child, AGA_INTEGER, &v)) {
+
+				record->version = (aga_uint_t) v;
+			}
+			else if(aga_config_variable("Options", child, AGA_INTEGER, &v)) {
+				record->options = (aga_uint_t) v;
+			}
+			else if(aga_config_variable("Compress", child, AGA_INTEGER, &v)) {
+				record->compress = !!v;
+			}
+			else if(aga_config_variable("RawSize", child, AGA_INTEGER, &v)) {
+				meta->raw_size = (aga_size_t) v;
+			}
+			else if(aga_config_variable("Encoding", child, AGA_INTEGER, &v)) {
+				meta->encoding = (enum aga_resource_encoding) v;
+			}
+			else if(aga_config_variable(
+					"StoredSize", child, AGA_INTEGER, &v)) {
+
+				meta->stored_size = (aga_size_t) v;
+			}
+			else (void) aga_build_meta_read(child, meta);
+		}
+	}
+
+	return aga_config_delete(&root);
+
+	/* A bad cache just means a full rebuild. */
+	discard: {
+		aga_error_check_soft(__FILE__, "aga_build_cache_new", result);
+		aga_log(__FILE__, "warn: Discarding unreadable build cache");
+
+		aga_error_check_soft(
+				__FILE__, "aga_config_delete", aga_config_delete(&root));
+
+		for(i = 0; i < cache->len; ++i) aga_free(cache->records[i].path);
+		aga_free(cache->records);
+		cache->records = 0;
+		cache->len = 0;
+		cache->changed = AGA_TRUE;
+
+		return aga_build_cache_index(cache);
+	}
+}
+
+static void aga_build_cache_delete(struct aga_build_cache* cache) {
+	aga_size_t i;
+
+	for(i = 0; i < cache->len; ++i) aga_free(cache->records[i].path);
+
+	aga_free(cache->records);
+	aga_free(cache->index);
+	aga_free(cache->path);
+}
+
+/*
+ * Looks up the input's record and brings it up to date, setting `fresh' if
+ * The existing artefact can be reused as-is along with the metadata in
+ * `meta'. Inputs whose timestamp changed but whose content didn't are caught
+ * By the hash. A null `artefact' means the input is its own artefact.
+ */
+static enum aga_result aga_build_cache_check(
+		struct aga_build_cache* cache, const char* path,
+		enum aga_file_kind kind, aga_uint_t options, aga_bool_t compress,
+		const char* artefact, struct aga_build_meta* meta, aga_bool_t* fresh) {
+
+	enum aga_result result;
+
+	struct aga_build_record* record;
+	union aga_file_attribute attr;
+
+	aga_time_t modified;
+	aga_size_t length;
+	aga_uint_t version = aga_build_kind_version(kind);
+	aga_uint_t hash;
+	aga_bool_t hashed = AGA_FALSE;
+
+	*fresh = AGA_FALSE;
+
+	result = aga_file_attribute_path(path, AGA_FILE_MODIFIED, &attr);
+	if(result) return result;
+	modified = attr.modified;
+
+	result = aga_file_attribute_path(path, AGA_FILE_LENGTH, &attr);
+	if(result) return result;
+	length = attr.length;
+
+	if(!(record = aga_build_cache_find(cache, path))) {
+		if((result = aga_build_cache_add(cache, path, &record))) return result;
+	}
+	else if(record->version == version && record->kind == kind &&
+			record->options == options && record->length == length) {
+
+		if(record->modified == modified) *fresh = AGA_TRUE;
+		else {
+			if((result = aga_build_hash_file(path, &hash))) return result;
+			hashed = AGA_TRUE;
+
+			if(hash == record->hash) {
+				record->modified = modified;
+				*fresh = AGA_TRUE;
+			}
+		}
+
+		if(*fresh && artefact) *fresh = aga_build_exists(artefact);
+	}
+
+	record->seen = AGA_TRUE;
+
+	if(*fresh) {
+		/* Same artefact, but it'll be stored differently. */
+		if(record->compress != compress) {
+			record->compress = compress;
+			record->meta.stored_size = 0;
+			cache->changed = AGA_TRUE;
+		}
+	}
+	else {
+		if(!hashed && (result = aga_build_hash_file(path, &hash))) {
+			return result;
+		}
+
+		record->kind = kind;
+		record->modified = modified;
+		record->length = length;
+		record->hash = hash;
+		record->version = version;
+		record->options = options;
+		record->compress = compress;
+		aga_bzero(&record->meta, sizeof(struct aga_build_meta));
+
+		cache->changed = AGA_TRUE;
+	}
+
+	if(!artefact) record->meta.raw_size = length;
+
+	*meta = record->meta;
+
+	return AGA_RESULT_OK;
+}
+
+/*
+ * Identifies an artefact's content without reading it -- it changes whenever
+ * The input, converter or options do.
+ */
+static aga_uint_t aga_build_record_hash(
+		const struct aga_build_record* record) {
+
+	aga_uint_t hash = record->hash;
+
+	hash = (hash ^ record->version) * 16777619U;
+	hash = (hash ^ record->options) * 16777619U;
+
+	return hash & 0xFFFFFFFFU;
+}
+
+/* Drops records for inputs which have gone away since the last build. */
+static void aga_build_cache_prune(struct aga_build_cache* cache) {
+	aga_size_t i, j;
+
+	for(i = 0, j = 0; i < cache->len; ++i) {
+		if(!cache->records[i].seen) {
+			aga_free(cache->records[i].path);
+			cache->changed = AGA_TRUE;
+			continue;
+		}
+
+		cache->records[j++] = cache->records[i];
+	}
+
+	cache->len = j;
+}
+
+static enum aga_result aga_build_cache_write(struct aga_build_cache* cache) {
+	enum aga_result result;
+
+	void* fp;
+	aga_size_t i;
+
+	if(!(fp = fopen(cache->path, "w"))) {
+		return aga_error_system_path(__FILE__, "fopen", cache->path);
+	}
+
+	if(fputs("<root>\n", fp) == EOF) {
+		result = aga_error_system(__FILE__, "fputs");
+		goto cleanup;
+	}
+
+	for(i = 0; i < cache->len; ++i) {
+		struct aga_build_record* record = &cache->records[i];
+		struct aga_build_meta* meta = &record->meta;
+
+		result = aga_fprintf_add(
+				fp, 1, "<item name=\"%s\">\n", record->path);
+		if(result) goto cleanup;
+
+#define agab_(name, type, fmt, param) \
+		do { \
+			result = aga_fprintf_add( \
+					fp, 2, "<item name=\"%s\" type=\"%s\">\n", name, type); \
+			if(result) goto cleanup; \
+			\
+			result = aga_fprintf_add(fp, 3, fmt "\n", param); \
+			if(result) goto cleanup; \
+			\
+			result = aga_fprintf_add(fp, 2, "</item>\n"); \
+			if(result) goto cleanup; \
+		} while(0)
+
+		agab_("Kind", "Integer", "%u", (unsigned) record->kind);
+		agab_("Modified", "Integer", "%ld", (long) record->modified);
+		agab_("Length", "Integer", "%zu", record->length);
+		agab_("Hash", "String", "%08X", record->hash);
+		agab_("Converter", "Integer", "%u", record->version);
+		agab_("Options", "Integer", "%u", record->options);
+		agab_("Compress", "Integer", "%u", (unsigned) record->compress);
+		agab_("RawSize", "Integer", "%zu", meta->raw_size);
+		agab_("Encoding", "Integer", "%u", (unsigned) meta->encoding);
+		agab_("StoredSize", "Integer", "%zu", meta->stored_size);
+
+#undef agab_
+
+		result = aga_build_meta_write(fp, 2, record->kind, meta);
+		if(result) goto cleanup;
+
+		result = aga_fprintf_add(fp, 1, "</item>\n");
+		if(result) goto cleanup;
+	}
+
+	if(fputs("</root>\n", fp) == EOF) {
+		result = aga_error_system(__FILE__, "fputs");
+		goto cleanup;
+	}
+
+	if(fclose(fp) == EOF) return aga_error_system(__FILE__, "fclose");
+
+	return AGA_RESULT_OK;
+
+	cleanup: {
+		if(fclose(fp) == EOF) (void) aga_error_system(__FILE__, "fclose");
+
+		return result;
+	}
+}
+
+/*
+ * NOTE: The manifest is the one walk over the input tree -- every file that
+ * 		 Ends up in the pack gets an entry here in build file order, which is
+ * 		 What fixes its place in the pack. Everything after works from this
+ * 		 Rather than going back to the filesystem for sizes or metadata.
+ */
+struct aga_build_entry {
+	char* path; /* Input file. */
+	char* name; /* Artefact file -- and the entry's path in the pack. */
+
+	enum aga_file_kind kind;
+	aga_uint_t options;
+	aga_bool_t compress;
+	aga_bool_t convert; /* The artefact is stale and must be rebuilt. */
+
+	aga_bool_t celled;
+	aga_sint_t cell_x;
+	aga_sint_t cell_z;
+	aga_size_t order; /* Place in the manifest before cells are grouped. */
+
+	aga_uint_t hash; /* See `aga_build_record_hash'. */
+
+	struct aga_build_meta meta;
+
+	/* Filled in while writing the pack. */
+	aga_size_t offset;
+	aga_size_t conf; /* Offset of the entry's `<item>' in the config tree. */
+	aga_size_t conf_size;
+};
+
+struct aga_build_manifest {
+	struct aga_build_input* input; /* The input currently being walked. */
+	struct aga_build_cache* cache;
+
+	struct aga_build_entry* entries;
+	aga_size_t len;
+};
+
+static enum aga_result aga_build_manifest_file(
+		const char* path, struct aga_build_manifest* manifest) {
+
+	aga_fixed_buf_t lzpath = { 0 };
+
+	enum aga_result result;
+
+	struct aga_build_input* input = manifest->input;
+	struct aga_build_entry* entry;
+	aga_bool_t raw = aga_build_kind_raw(input->kind);
+	aga_bool_t fresh;
+	aga_size_t size;
+
+	/* Skip input files which don't match kind. */
+	if(!aga_build_path_matches_kind(path, input->kind)) return AGA_RESULT_OK;
+
+	size = (manifest->len + 1) * sizeof(struct aga_build_entry);
+	if(!(entry = aga_realloc(manifest->entries, size))) return AGA_RESULT_OOM;
+	manifest->entries = entry;
+
+	entry = &manifest->entries[manifest->len++];
+	aga_bzero(entry, sizeof(struct aga_build_entry));
+
+	entry->kind = input->kind;
+	entry->options = input->options;
+	entry->compress = input->compress;
+	entry->celled = input->celled;
+	entry->cell_x = input->cell_x;
+	entry->cell_z = input->cell_z;
+	entry->order = manifest->len - 1;
+
+	if(!(entry->path = aga_strdup(path))) return AGA_RESULT_OOM;
+
+	/*
+	 * Input kinds which are handled as "raw" need a special case when
+	 * Looking for the resultant artefact files -- we just redirect to the
+	 * Original because there is no need to produce any output whatsoever.
+	 */
+	size = aga_strlen(path) + 1;
+	if(!raw) size += sizeof(AGA_RAWPATH) - 1;
+
+	if(!(entry->name = aga_malloc(size))) return AGA_RESULT_OOM;
+
+	strcpy(entry->name, path);
+	if(!raw) strcat(entry->name, AGA_RAWPATH);
+
+	result = aga_build_cache_check(
+			manifest->cache, path, entry->kind, entry->options,
+			entry->compress,
+			raw ? 0 : entry->name, &entry->meta, &fresh);
+	if(result) return result;
+
+	entry->convert = !fresh && !raw;
+	entry->hash = aga_build_record_hash(
+			aga_build_cache_find(manifest->cache, path));
+
+	if(!entry->compress) {
+		entry->meta.encoding = AGA_ENCODING_NONE;
+		entry->meta.stored_size = entry->meta.raw_size;
+	}
+	else if(entry->meta.encoding == AGA_ENCODING_LZSS) {
+		/* Last build's encoded copy has gone missing. */
+		strcpy(lzpath, entry->name);
+		strcat(lzpath, AGA_LZPATH);
+
+		if(!aga_build_exists(lzpath)) entry->meta.stored_size = 0;
+	}
+
+	return AGA_RESULT_OK;
+}
+
+static enum aga_result aga_build_manifest_dir(const char* path, void* pass) {
+	return aga_build_manifest_file(path, pass);
+}
+
+static enum aga_result aga_build_manifest_input(
+		struct aga_build_input* input, void* pass) {
+
+	enum aga_result result;
+	union aga_file_attribute attr;
+
+	struct aga_build_manifest* manifest = pass;
+
+	manifest->input = input;
+
+	result = aga_file_attribute_path(input->path, AGA_FILE_TYPE, &attr);
+	if(result) return result;
+
+	if(attr.type == AGA_FILE_DIRECTORY) {
+		return aga_directory_iterate(
+				input->path, aga_build_manifest_dir, input->recurse, manifest,
+				AGA_TRUE);
+	}
+	else return aga_build_manifest_file(input->path, manifest);
+}
+
+static void aga_build_manifest_delete(struct aga_build_manifest* manifest) {
+	aga_size_t i;
+
+	for(i = 0; i < manifest->len; ++i) {
+		aga_free(manifest->entries[i].path);
+		aga_free(manifest->entries[i].name);
+	}
+
+	aga_free(manifest->entries);
+
+	manifest->entries = 0;
+	manifest->len = 0;
+}
+
+/* Whether an entry needs any work doing before it can be packed. */
+static aga_bool_t aga_build_entry_stale(struct aga_build_entry* entry) {
+	/* Scenes wait on everything else -- see `aga_build_scenes'. */
+	if(entry->kind == AGA_KIND_SCENE) return AGA_FALSE;
+
+	if(entry->convert) return AGA_TRUE;
+
+	return entry->compress && !entry->meta.stored_size;
+}
+
+/* Produces the entry's `.raw' artefact and fills in its metadata. */
+static enum aga_result aga_build_convert_file(struct aga_build_entry* entry) {
+	enum aga_result result = AGA_RESULT_OK;
+
+	void* in;
+	void* out;
+	long off;
+
+	if(!(in = fopen(entry->path, "rb"))) {
+		return aga_error_system_path(__FILE__, "fopen", entry->path);
+	}
+
+	if(!(out = fopen(entry->name, "wb"))) {
+		return aga_error_system_path(__FILE__, "fopen", entry->name);
+	}
+
+	/* TODO: Leaky error states. */
+	switch(entry->kind) {
+		default: {
+			aga_log(
+					__FILE__,
+					"err: Unknown or unimplemented input kind for `%s'",
+					entry->path);
+			break;
+		}
+
+		case AGA_KIND_PY: {
+			result = aga_build_python(out, in, &entry->meta);
+			break;
+		}
+
+		case AGA_KIND_OBJ: {
+			result = aga_build_obj(out, in, entry->options, &entry->meta);
+			break;
+		}
+
+		case AGA_KIND_TIFF: {
+			result = aga_build_tiff(out, in, entry->options, &entry->meta);
+			break;
+		}
+
+/*
+		case AGA_KIND_WAV: break;
+		case AGA_KIND_MIDI: break;
+ */
+	}
+
+	if(result) return result;
+
+	if((off = ftell(out)) == -1) return aga_error_system(__FILE__, "ftell");
+	entry->meta.raw_size = (aga_size_t) off;
+
+	if(fclose(in) == EOF) return aga_error_system(__FILE__, "fclose");
+
+	if(fclose(out) == EOF) return aga_error_system(__FILE__, "fclose");
+
+	return AGA_RESULT_OK;
+}
+
+/*
+ * Writes an encoded copy of the first `size' bytes of an artefact alongside
+ * It. Gives `AGA_RESULT_EOF' if encoding wouldn't save anything.
+ */
+static enum aga_result aga_build_compress(
+		const char* path, aga_size_t size, aga_size_t* out_size) {
+
+	aga_fixed_buf_t lzpath = { 0 };
+
+	enum aga_result result;
+
+	void* fp;
+	void* data = 0;
+	void* out = 0;
+
+	if(!(fp = fopen(path, "rb"))) {
+		return aga_error_system_path(__FILE__, "fopen", path);
+	}
+
+	if(!(data = aga_malloc(size))) {
+		result = AGA_RESULT_OOM;
+		goto cleanup;
+	}
+
+	if((result = aga_file_read(data, size, fp))) goto cleanup;
+
+	if(fclose(fp) == EOF) {
+		fp = 0;
+		result = aga_error_system(__FILE__, "fclose");
+		goto cleanup;
+	}
+	fp = 0;
+
+	if(!(out = aga_malloc(AGA_COMPRESS_BOUND(size)))) {
+		result = AGA_RESULT_OOM;
+		goto cleanup;
+	}
+
+	if((result = aga_compress(data, size, out, out_size))) goto cleanup;
+
+	if(*out_size >= size) {
+		result = AGA_RESULT_EOF;
+		goto cleanup;
+	}
+
+	strcpy(lzpath, path);
+	strcat(lzpath, AGA_LZPATH);
+
+	if(!(fp = fopen(lzpath, "wb"))) {
+		result = aga_error_system_path(__FILE__, "fopen", lzpath);
+		goto cleanup;
+	}
+
+	if((result = aga_build_write(fp, out, *out_size))) goto cleanup;
+
+	if(fclose(fp) == EOF) {
+		fp = 0;
+		result = aga_error_system(__FILE__, "fclose");
+		goto cleanup;
+	}
+	fp = 0;
+
+	cleanup: {
+		if(fp && fclose(fp) == EOF) (void) aga_error_system(__FILE__, "fclose");
+
+		aga_free(out);
+		aga_free(data);
+
+		return result;
+	}
+}
+
+/* Brings a stale entry up to date -- safe to run in a worker process. */
+static enum aga_result aga_build_process(struct aga_build_entry* entry) {
+	enum aga_result result;
+
+	struct aga_build_meta* meta = &entry->meta;
+
+	if(entry->convert) {
+		if((result = aga_build_convert_file(entry))) return result;
+	}
+
+	meta->encoding = AGA_ENCODING_NONE;
+	meta->stored_size = meta->raw_size;
+
+	if(entry->compress) {
+		aga_size_t size;
+
+		result = aga_build_compress(entry->name, meta->raw_size, &size);
+		if(!result) {
+			meta->encoding = AGA_ENCODING_LZSS;
+			meta->stored_size = size;
+		}
+		else if(result != AGA_RESULT_EOF) return result;
+	}
+
+	return AGA_RESULT_OK;
+}
+
+#ifdef AGA_NIXSPAWN
+/* What a worker sends back -- small enough for pipe writes to be atomic. */
+struct aga_build_report {
+	aga_size_t entry;
+	struct aga_build_meta meta;
+};
+
+/*
+ * Each entry gets its own process -- the converters and their libraries
+ * Lean on static state and were never going to be thread safe. Workers send
+ * Their metadata back over a shared pipe.
+ */
+static enum aga_result aga_build_process_parallel(
+		struct aga_build_manifest* manifest, aga_size_t jobs) {
+
+	enum aga_result result = AGA_RESULT_OK;
+
+	int fds[2];
+	pid_t* pids;
+	aga_size_t next = 0;
+	aga_size_t running = 0;
+	aga_bool_t spawn = AGA_TRUE;
+	aga_size_t i;
+
+	if(!(pids = aga_calloc(manifest->len, sizeof(pid_t)))) {
+		return AGA_RESULT_OOM;
+	}
+
+	if(pipe(fds) == -1) {
+		aga_free(pids);
+		return aga_error_system(__FILE__, "pipe");
+	}
+
+	while(running || spawn) {
+		struct aga_build_report report;
+		aga_uchar_t* p;
+		aga_size_t got;
+		int status;
+		pid_t pid;
+
+		if(spawn) {
+			while(next < manifest->len) {
+				if(aga_build_entry_stale(&manifest->entries[next])) break;
+				++next;
+			}
+
+			if(next == manifest->len) spawn = AGA_FALSE;
+		}
+
+		if(spawn && running < jobs) {
+			struct aga_build_entry* entry = &manifest->entries[next];
+
+			/* Don't let children flush our buffered output a second time. */
+			if(fflush(0) == EOF) (void) aga_error_system(__FILE__, "fflush");
+
+			if((pid = fork()) == -1) {
+				/* Let what's already running finish and give up on the rest. */
+				result = aga_error_system(__FILE__, "fork");
+				spawn = AGA_FALSE;
+				continue;
+			}
+
+			if(!pid) {
+				if(aga_build_process(entry)) exit(EXIT_FAILURE);
+
+				report.entry = next;
+				report.meta = entry->meta;
+
+				if(write(fds[1], &report, sizeof(report)) != sizeof(report)) {
+					(void) aga_error_system(__FILE__, "write");
+					exit(EXIT_FAILURE);
+				}
+
+				exit(EXIT_SUCCESS);
+			}
+
+			pids[next++] = pid;
+			++running;
+
+			continue;
+		}
+
+		if((pid = waitpid(-1, &status, 0)) == -1) {
+			if(errno == EINTR) continue;
+
+			result = aga_error_system(__FILE__, "waitpid");
+			break;
+		}
+
+		--running;
+
+		if(!WIFEXITED(status) || WEXITSTATUS(status)) {
+			for(i = 0; i < next && pids[i] != pid; ++i) continue;
+
+			aga_log(
+					__FILE__, "err: Failed to build `%s'",
+					i < next ? manifest->entries[i].path : "<unknown>");
+
+			result = AGA_RESULT_ERROR;
+			continue;
+		}
+
+		/*
+		 * Every successful worker wrote exactly one report before exiting, so
+		 * One is waiting for us -- though not necessarily this worker's.
+		 */
+		for(p = (aga_uchar_t*) &report, got = 0; got < sizeof(report); ) {
+			ssize_t n = read(fds[0], p + got, sizeof(report) - got);
+
+			if(n == -1 && errno == EINTR) continue;
+			if(n <= 0) {
+				result = aga_error_system(__FILE__, "read");
+				goto cleanup;
+			}
+
+			got += (aga_size_t) n;
+		}
+
+		if(report.entry >= manifest->len) {
+			result = AGA_RESULT_ERROR;
+			goto cleanup;
+		}
+
+		manifest->entries[report.entry].meta = report.meta;
+	}
+
+	cleanup: {
+		/* Reap anything left behind by an early exit. */
+		while(running && waitpid(-1, 0, 0) != -1) --running;
+
+		if(close(fds[0]) == -1) (void) aga_error_system(__FILE__, "close");
+		if(close(fds[1]) == -1) (void) aga_error_system(__FILE__, "close");
+
+		aga_free(pids);
+
+		return result;
+	}
+}
+#endif
+
+/* Brings stale entries up to date, up to `jobs' at once where supported. */
+static enum aga_result aga_build_process_all(
+		struct aga_build_manifest* manifest, aga_size_t jobs) {
+
+	enum aga_result result;
+	enum aga_result held_result = AGA_RESULT_OK;
+
+	aga_size_t i;
+	aga_size_t count = 0;
+
+	for(i = 0; i < manifest->len; ++i) {
+		count += aga_build_entry_stale(&manifest->entries[i]);
+	}
+
+	if(!count) return AGA_RESULT_OK;
+
+	aga_log(
+			__FILE__, "Building `%zu' input files (`%zu' jobs)...", count,
+			jobs);
+
+#ifdef AGA_NIXSPAWN
+	if(jobs > 1) return aga_build_process_parallel(manifest, jobs);
+#else
+	if(jobs > 1) {
+		aga_log(
+				__FILE__,
+				"warn: Parallel conversion is unsupported on this platform");
+	}
+#endif
+
+	for(i = 0; i < manifest->len; ++i) {
+		struct aga_build_entry* entry = &manifest->entries[i];
+
+		if(!aga_build_entry_stale(entry)) continue;
+
+		if((result = aga_build_process(entry))) {
+			aga_log(__FILE__, "err: Failed to build `%s'", entry->path);
+			held_result = result;
+		}
+	}
+
+	return held_result;
+}
+
+static struct aga_build_entry* aga_build_manifest_find(
+		struct aga_build_manifest* manifest, const char* name) {
+
+	aga_size_t i;
+
+	for(i = 0; i < manifest->len; ++i) {
+		struct aga_build_entry* entry = &manifest->entries[i];
+
+		if(aga_streql(entry->name, name)) return entry;
+	}
+
+	return 0;
+}
+
+/* Appends to the scene's members unless it's already one. */
+static enum aga_result aga_build_scene_add(
+		struct aga_build_entry*** members, aga_size_t* count,
+		struct aga_build_entry* entry) {
+
+	struct aga_build_entry** p;
+	aga_size_t i;
+
+	for(i = 0; i < *count; ++i) if((*members)[i] == entry) return AGA_RESULT_OK;
+
+	p = aga_realloc(*members, (*count + 1) * sizeof(struct aga_build_entry*));
+	if(!p) return AGA_RESULT_OOM;
+
+	p[(*count)++] = entry;
+	*members = p;
+
+	return AGA_RESULT_OK;
+}
+
+/* Adds whatever the object at `entry' draws with. */
+static enum aga_result aga_build_scene_deps(
+		struct aga_build_entry* entry, struct aga_build_manifest* manifest,
+		struct aga_build_entry*** members, aga_size_t* count) {
+
+	static const char* deps[] = {
+			"Texture", "Model", "ModelLod1", "ModelLod2", "Billboard"
+	};
+
+	enum aga_result result;
+	enum aga_result err;
+
+	struct aga_config_node conf;
+	struct aga_build_entry* dep;
+	const char* path;
+	aga_size_t i;
+
+	if((result = aga_build_open_config(entry->path, &conf))) return result;
+
+	for(i = 0; i < AGA_LEN(deps); ++i) {
+		err = aga_config_lookup(
+				conf.children, &deps[i], 1, &path, AGA_STRING, AGA_FALSE);
+		if(err == AGA_RESULT_MISSING_KEY) continue;
+		else if(err) {
+			/* The object's own load will complain about this properly. */
+			aga_log(
+					__FILE__, "warn: `%s' of `%s' could not be read (%s)",
+					deps[i], entry->name, aga_result_name(err));
+			continue;
+		}
+
+		/* Not an error -- it'll just be loaded from the pack as usual. */
+		if(!(dep = aga_build_manifest_find(manifest, path))) {
+			aga_log(
+					__FILE__, "warn: `%s' of `%s' is not in the pack",
+					path, entry->name);
+			continue;
+		}
+
+		if((result = aga_build_scene_add(members, count, dep))) break;
+	}
+
+	aga_error_check_soft(
+			__FILE__, "aga_config_delete", aga_config_delete(&conf));
+
+	return result;
+}
+
+/* Pads the scene out so the next member starts aligned. */
+static enum aga_result aga_build_scene_align(void* fp) {
+	long off;
+
+	if((off = ftell(fp)) == -1) return aga_error_system(__FILE__, "ftell");
+
+	for(; off % sizeof(aga_uint_t); ++off) {
+		if(fputc(0, fp) == EOF) return aga_error_system(__FILE__, "fputc");
+	}
+
+	return AGA_RESULT_OK;
+}
+
+/* Writes each member's metadata and data after the table and strings. */
+static enum aga_result aga_build_scene_members(
+		void* fp, struct aga_build_entry** members,
+		struct aga_scene_entry* table, aga_size_t count) {
+
+	enum aga_result result;
+
+	aga_size_t i;
+	long off;
+	void* in;
+
+	for(i = 0; i < count; ++i) {
+		struct aga_build_entry* member = members[i];
+
+		if((off = ftell(fp)) == -1) return aga_error_system(__FILE__, "ftell");
+		table[i].conf = (aga_uint_t) off;
+
+		result = aga_fprintf_add(fp, 0, "<item name=\"%s\">\n", member->name);
+		if(result) return result;
+
+		result = aga_build_meta_write(fp, 1, member->kind, &member->meta);
+		if(result) return result;
+
+		if((result = aga_fprintf_add(fp, 0, "</item>\n"))) return result;
+
+		if((off = ftell(fp)) == -1) return aga_error_system(__FILE__, "ftell");
+		table[i].conf_size = (aga_uint_t) off - table[i].conf;
+
+		if((result = aga_build_scene_align(fp))) return result;
+
+		if((off = ftell(fp)) == -1) return aga_error_system(__FILE__, "ftell");
+		table[i].offset = (aga_uint_t) off;
+		table[i].size = (aga_uint_t) member->meta.raw_size;
+		table[i].hash = member->hash;
+
+		if(!(in = fopen(member->name, "rb"))) {
+			return aga_error_system_path(__FILE__, "fopen", member->name);
+		}
+
+		result = aga_file_copy(fp, in, member->meta.raw_size);
+		if(result) {
+			if(fclose(in) == EOF) (void) aga_error_system(__FILE__, "fclose");
+			return result;
+		}
+
+		if(fclose(in) == EOF) return aga_error_system(__FILE__, "fclose");
+
+		if((result = aga_build_scene_align(fp))) return result;
+	}
+
+	return AGA_RESULT_OK;
+}
+
+/*
+ * A scene file is a config with an `Objects' list of object paths as they
+ * Appear in the pack. The scene takes those objects and whatever they draw
+ * With -- each only once however many objects share it.
+ */
+static enum aga_result aga_build_scene(
+		struct aga_build_entry* scene, struct aga_build_manifest* manifest) {
+
+	static const char* objects = "Objects";
+
+	enum aga_result result;
+
+	struct aga_config_node root;
+	struct aga_config_node* list;
+	struct aga_build_entry** members = 0;
+	struct aga_scene_entry* table = 0;
+	struct aga_scene_header hdr = { AGA_SCENE_MAGIC, 0, 0, 0 };
+	aga_size_t count = 0;
+	aga_size_t i;
+	void* fp = 0;
+	long off;
+
+	aga_log(__FILE__, "Assembling scene `%s'...", scene->path);
+
+	if((result = aga_build_open_config(scene->path, &root))) return result;
+
+	result = aga_config_lookup_check(root.children, &objects, 1, &list);
+	if(result) goto cleanup;
+
+	for(i = 0; i < list->len; ++i) {
+		struct aga_config_node* node = &list->children[i];
+		struct aga_build_entry* entry;
+
+		if(node->type != AGA_STRING) {
+			aga_log(
+					__FILE__, "warn: Non-string in `Objects' of `%s'",
+					scene->path);
+			continue;
+		}
+
+		entry = aga_build_manifest_find(manifest, node->data.string);
+		if(!entry || entry->kind != AGA_KIND_SGML) {
+			aga_log(
+					__FILE__, "err: Scene object `%s' is not an object in "
+							  "the pack", node->data.string);
+			result = AGA_RESULT_BAD_PARAM;
+			goto cleanup;
+		}
+
+		result = aga_build_scene_add(&members, &count, entry);
+		if(result) goto cleanup;
+	}
+
+	hdr.objects = (aga_uint_t) count;
+
+	for(i = 0; i < hdr.objects; ++i) {
+		result = aga_build_scene_deps(members[i], manifest, &members, &count);
+		if(result) goto cleanup;
+	}
+
+	hdr.len = (aga_uint_t) count;
+
+	for(i = 0; i < count; ++i) {
+		hdr.strings += (aga_uint_t) aga_strlen(members[i]->name) + 1;
+	}
+
+	while(hdr.strings % sizeof(aga_uint_t)) hdr.strings++;
+
+	if(!(table = aga_calloc(count, sizeof(struct aga_scene_entry)))) {
+		result = AGA_RESULT_OOM;
+		goto cleanup;
+	}
+
+	if(!(fp = fopen(scene->name, "wb"))) {
+		result = aga_error_system_path(__FILE__, "fopen", scene->name);
+		goto cleanup;
 	}
 
-	result = aga_file_copy(fp, in, size);
+	/* The table is rewritten once the members have been placed. */
+	if((result = aga_build_write(fp, &hdr, sizeof(hdr)))) goto cleanup;
+
+	result = aga_build_write(fp, table, count * sizeof(*table));
 	if(result) goto cleanup;
 
-	if(fclose(in) == EOF) return aga_error_system(__FILE__, "fclose");
+	for(i = 0, off = 0; i < count; ++i) {
+		const char* str = members[i]->name;
 
-	return AGA_RESULT_OK;
+		table[i].name = (aga_uint_t) off;
+		off += (long) aga_strlen(str) + 1;
+
+		if((result = aga_build_write(fp, str, aga_strlen(str) + 1))) {
+			goto cleanup;
+		}
+	}
+
+	if((result = aga_build_scene_align(fp))) goto cleanup;
+
+	result = aga_build_scene_members(fp, members, table, count);
+	if(result) goto cleanup;
+
+	if((off = ftell(fp)) == -1) {
+		result = aga_error_system(__FILE__, "ftell");
+		goto cleanup;
+	}
+
+	scene->meta.raw_size = (aga_size_t) off;
+	scene->meta.encoding = AGA_ENCODING_NONE;
+	scene->meta.stored_size = scene->meta.raw_size;
+
+	rewind(fp);
+
+	if((result = aga_build_write(fp, &hdr, sizeof(hdr)))) goto cleanup;
+
+	result = aga_build_write(fp, table, count * sizeof(*table));
+	if(result) goto cleanup;
+
+	aga_log(
+			__FILE__, "Scene `%s' has `%u' objects in `%zu' entries",
+			scene->path, hdr.objects, count);
 
 	cleanup: {
-		if(fclose(in) == EOF) (void) aga_error_system(__FILE__, "fclose");
+		if(fp && fclose(fp) == EOF && !result) {
+			result = aga_error_system(__FILE__, "fclose");
+		}
+
+		aga_free(table);
+		aga_free(members);
+
+		aga_error_check_soft(
+				__FILE__, "aga_config_delete", aga_config_delete(&root));
 
 		return result;
 	}
 }
 
-static enum aga_result aga_build_pack_dir(const char* path, void* pass) {
-	struct aga_build_conf_pass* conf_pass = pass;
+/*
+ * NOTE: Scenes copy other artefacts so they're only assembled once everything
+ * 		 Else is up to date, and again whenever anything else in the pack has
+ * 		 Changed at all rather than tracking exactly what each depends on.
+ */
+static enum aga_result aga_build_scenes(
+		struct aga_build_manifest* manifest, struct aga_build_cache* cache) {
+
+	enum aga_result result;
+	enum aga_result held_result = AGA_RESULT_OK;
+
+	aga_size_t i;
+
+	for(i = 0; i < manifest->len; ++i) {
+		struct aga_build_entry* entry = &manifest->entries[i];
 
-	return aga_build_pack_file(path, conf_pass->kind, conf_pass->fp);
+		if(entry->kind != AGA_KIND_SCENE) continue;
+		if(!entry->convert && !cache->changed) continue;
+
+		if((result = aga_build_scene(entry, manifest))) {
+			aga_log(__FILE__, "err: Failed to build `%s'", entry->path);
+			held_result = result;
+		}
+	}
+
+	return held_result;
 }
 
-static enum aga_result aga_build_pack(
-		const char* path, enum aga_file_kind kind, aga_bool_t recurse,
-		void* pass) {
+/* Stores what we learned this build so the next can reuse it. */
+static void aga_build_manifest_record(
+		struct aga_build_manifest* manifest, struct aga_build_cache* cache) {
 
-	enum aga_result result;
-	union aga_file_attribute attr;
+	aga_size_t i;
 
-	if((result = aga_file_attribute_path(path, AGA_FILE_TYPE, &attr))) {
-		return result;
+	for(i = 0; i < manifest->len; ++i) {
+		struct aga_build_entry* entry = &manifest->entries[i];
+		struct aga_build_record* record;
+
+		if((record = aga_build_cache_find(cache, entry->path))) {
+			record->meta = entry->meta;
+		}
 	}
+}
 
-	if(attr.type == AGA_FILE_DIRECTORY) {
-		struct aga_build_conf_pass conf_pass;
+/* Where a kind goes within its cell -- objects lead into what they use. */
+static int aga_build_kind_rank(enum aga_file_kind kind) {
+	switch(kind) {
+		default: return 3;
+		case AGA_KIND_SGML: return 0;
+		case AGA_KIND_OBJ: return 1;
+		case AGA_KIND_TIFF: return 2;
+	}
+}
 
-		conf_pass.fp = pass;
-		conf_pass.kind = kind;
+static int aga_build_entry_cmp(const void* a, const void* b) {
+	const struct aga_build_entry* x = a;
+	const struct aga_build_entry* y = b;
+	int rx, ry;
 
-		return aga_directory_iterate(
-				path, aga_build_pack_dir, recurse, &conf_pass, AGA_TRUE);
+	if(x->celled != y->celled) return x->celled ? 1 : -1;
+
+	if(x->celled) {
+		if(x->cell_x != y->cell_x) return x->cell_x < y->cell_x ? -1 : 1;
+		if(x->cell_z != y->cell_z) return x->cell_z < y->cell_z ? -1 : 1;
+
+		rx = aga_build_kind_rank(x->kind);
+		ry = aga_build_kind_rank(y->kind);
+		if(rx != ry) return rx < ry ? -1 : 1;
 	}
-	else return aga_build_pack_file(path, kind, pass);
+
+	return x->order < y->order ? -1 : x->order > y->order;
+}
+
+/*
+ * NOTE: Uncelled entries keep build file order at the front of the pack and
+ * 		 Each cell's entries follow as one contiguous run so streaming a cell
+ * 		 In is a single forward read. Neighbouring cells along Z are also
+ * 		 Neighbours in the pack.
+ */
+static void aga_build_manifest_cells(struct aga_build_manifest* manifest) {
+	qsort(
+			manifest->entries, manifest->len, sizeof(struct aga_build_entry),
+			aga_build_entry_cmp);
 }
 
 static enum aga_result aga_build_iter(
@@ -652,50 +3197,198 @@ static enum aga_result aga_build_iter(
 
 		aga_slong_t v;
 		const char* str = 0;
-
-		enum aga_file_kind kind = AGA_KIND_NONE;
-		const char* path = 0;
-		aga_bool_t recurse = AGA_FALSE;
+		const char* filter = "Tent";
+		const char* format = aga_texture_formats[AGA_FORMAT_AUTO];
+
+		struct aga_build_input input = { 0 };
+		aga_bool_t compress = AGA_TRUE;
+		aga_bool_t has_compress = AGA_FALSE;
+		aga_bool_t quantise = AGA_TRUE;
+		aga_bool_t mipmap = AGA_TRUE;
+		aga_slong_t lods = 0;
+		aga_slong_t cell_x = 0;
+		aga_slong_t cell_z = 0;
+		aga_bool_t has_x = AGA_FALSE;
+		aga_bool_t has_z = AGA_FALSE;
+
+		input.kind = AGA_KIND_NONE;
+		input.recurse = AGA_FALSE;
 
 		for(j = 0; j < node->len; ++j) {
 			struct aga_config_node* child = &node->children[j];
 
 			if(aga_config_variable("Kind", child, AGA_STRING, &str)) {
-				if(aga_streql(str, "RAW")) kind = AGA_KIND_RAW;
-				else if(aga_streql(str, "TIFF")) kind = AGA_KIND_TIFF;
-				else if(aga_streql(str, "OBJ")) kind = AGA_KIND_OBJ;
-				else if(aga_streql(str, "SGML")) kind = AGA_KIND_SGML;
-				else if(aga_streql(str, "PY")) kind = AGA_KIND_PY;
-				else if(aga_streql(str, "WAV")) kind = AGA_KIND_WAV;
-				else if(aga_streql(str, "MIDI")) kind = AGA_KIND_MIDI;
+				if(aga_streql(str, "RAW")) input.kind = AGA_KIND_RAW;
+				else if(aga_streql(str, "TIFF")) input.kind = AGA_KIND_TIFF;
+				else if(aga_streql(str, "OBJ")) input.kind = AGA_KIND_OBJ;
+				else if(aga_streql(str, "SGML")) input.kind = AGA_KIND_SGML;
+				else if(aga_streql(str, "PY")) input.kind = AGA_KIND_PY;
+				else if(aga_streql(str, "WAV")) input.kind = AGA_KIND_WAV;
+				else if(aga_streql(str, "MIDI")) input.kind = AGA_KIND_MIDI;
+				else if(aga_streql(str, "SCENE")) input.kind = AGA_KIND_SCENE;
 				else {
 					aga_log(
 							__FILE__,
 							"warn: Unknown input kind `%s' -- Assuming `RAW'",
 							str);
 
-					kind = AGA_KIND_RAW;
+					input.kind = AGA_KIND_RAW;
 				}
 
 				continue;
 			}
-			else if(aga_config_variable("Path", child, AGA_STRING, &path)) {
+			else if(aga_config_variable(
+					"Path", child, AGA_STRING, &input.path)) {
+
 				continue;
 			}
 			else if(aga_config_variable("Recurse", child, AGA_INTEGER, &v)) {
-				recurse = !!v;
+				input.recurse = !!v;
+				continue;
+			}
+			else if(aga_config_variable("Compress", child, AGA_INTEGER, &v)) {
+				compress = !!v;
+				has_compress = AGA_TRUE;
+				continue;
+			}
+			else if(aga_config_variable("Overdraw", child, AGA_INTEGER, &v)) {
+				if(v) input.options |= AGA_BUILD_OVERDRAW;
 				continue;
 			}
+			else if(aga_config_variable("Quantise", child, AGA_INTEGER, &v)) {
+				quantise = !!v;
+				continue;
+			}
+			else if(aga_config_variable("Lods", child, AGA_INTEGER, &lods)) {
+				continue;
+			}
+			else if(aga_config_variable(
+					"CellX", child, AGA_INTEGER, &cell_x)) {
+
+				has_x = AGA_TRUE;
+				continue;
+			}
+			else if(aga_config_variable(
+					"CellZ", child, AGA_INTEGER, &cell_z)) {
+
+				has_z = AGA_TRUE;
+				continue;
+			}
+			else if(aga_config_variable("Mipmap", child, AGA_INTEGER, &v)) {
+				mipmap = !!v;
+				continue;
+			}
+			else if(aga_config_variable(
+					"MipFilter", child, AGA_STRING, &filter)) {
+
+				continue;
+			}
+			else if(aga_config_variable(
+					"Format", child, AGA_STRING, &format)) {
+
+				continue;
+			}
+		}
+
+		if(input.kind == AGA_KIND_TIFF) {
+			aga_uint_t f;
+
+			for(f = 0; f <= AGA_FORMAT_PALETTED; ++f) {
+				if(aga_streql(format, aga_texture_formats[f])) break;
+			}
+
+			if(f > AGA_FORMAT_PALETTED) {
+				aga_log(
+						__FILE__,
+						"warn: Unknown texture format `%s' -- Assuming `%s'",
+						format, aga_texture_formats[AGA_FORMAT_AUTO]);
+
+				f = AGA_FORMAT_AUTO;
+			}
+
+			input.options |= f << AGA_BUILD_FORMAT_SHIFT;
+		}
+
+		/* Textures carry their mip chain unless asked otherwise. */
+		if(input.kind == AGA_KIND_TIFF && mipmap) {
+			input.options |= AGA_BUILD_MIPMAP;
+
+			if(aga_streql(filter, "Box")) input.options |= AGA_BUILD_MIP_BOX;
+			else if(!aga_streql(filter, "Tent")) {
+				aga_log(
+						__FILE__,
+						"warn: Unknown mip filter `%s' -- Assuming `Tent'",
+						filter);
+			}
+		}
+
+		/* Models are quantised unless asked otherwise. */
+		if(input.kind == AGA_KIND_OBJ && quantise) {
+			input.options |= AGA_BUILD_QUANTISE;
 		}
 
+		if(input.kind == AGA_KIND_OBJ && lods) {
+			if(lods < 0 || lods > AGA_MODEL_LODS) {
+				aga_log(
+						__FILE__,
+						"warn: Models can have at most %u LOD levels -- "
+						"Clamping `Lods'", AGA_MODEL_LODS);
+
+				lods = lods < 0 ? 0 : AGA_MODEL_LODS;
+			}
+
+			input.options |= (aga_uint_t) lods << AGA_BUILD_LOD_SHIFT;
+		}
+
+		if(has_x != has_z) {
+			if(log) {
+				aga_log(
+						__FILE__,
+						"warn: Cells need both `CellX' and `CellZ' -- "
+						"Ignoring cell for `%s'", input.path);
+			}
+		}
+		else if(has_x) {
+			input.celled = AGA_TRUE;
+			input.cell_x = (aga_sint_t) cell_x;
+			input.cell_z = (aga_sint_t) cell_z;
+		}
+
+		if(input.kind != AGA_KIND_OBJ && input.options & AGA_BUILD_OVERDRAW) {
+			if(log) {
+				aga_log(
+						__FILE__,
+						"warn: Input kind `%s' cannot be overdraw ordered -- "
+						"Ignoring `Overdraw'", str);
+			}
+
+			input.options &= ~AGA_BUILD_OVERDRAW;
+		}
+
+		/* Compressible kinds are compressed unless asked otherwise. */
+		input.compress = compress && aga_build_kind_compressible(input.kind);
+
 		if(log) {
+			if(has_compress && compress && !input.compress) {
+				aga_log(
+						__FILE__,
+						"warn: Input kind `%s' cannot be compressed -- "
+						"Ignoring `Compress'", str);
+			}
+
 			aga_log(
 					__FILE__,
-					"Build Input: Path=\"%s\" Kind=%s Recurse=%s",
-					path, str, recurse ? "True" : "False");
+					"Build Input: Path=\"%s\" Kind=%s Recurse=%s Compress=%s "
+					"Overdraw=%s Quantise=%s Lods=%u",
+					input.path, str, input.recurse ? "True" : "False",
+					input.compress ? "True" : "False",
+					input.options & AGA_BUILD_OVERDRAW ? "True" : "False",
+					input.options & AGA_BUILD_QUANTISE ? "True" : "False",
+					(input.options & AGA_BUILD_LOD_MASK) >>
+							AGA_BUILD_LOD_SHIFT);
 		}
 
-		if((result = fn(path, kind, recurse, pass))) {
+		if((result = fn(&input, pass))) {
 			aga_error_check_soft(
 					__FILE__, "aga_build_iter::<callback>", result);
 
@@ -706,6 +3399,242 @@ static enum aga_result aga_build_iter(
 	return held_result;
 }
 
+/*
+ * Writes an entry's `<item>' into the config tree.
+ * TODO: Sort out:
+ *		  - `%zu' did not exist until C99.
+ *		  - `%llu' should not be used on non "modern Windows" machines.
+ *				- Same goes for `long long' in general.
+ *
+ *		 Might need to make our own equivalent of `inttypes.h'.
+ */
+static enum aga_result aga_build_conf_entry(
+		void* fp, struct aga_build_entry* entry) {
+
+	enum aga_result result;
+
+	struct aga_build_meta* meta = &entry->meta;
+
+	result = aga_fprintf_add(fp, 1, "<item name=\"%s\">\n", entry->name);
+	if(result) return result;
+
+#define agab_(name, type, fmt, param) \
+		do { \
+			result = aga_fprintf_add( \
+					fp, 2, "<item name=\"%s\" type=\"%s\">\n", name, type); \
+			if(result) return result; \
+			\
+			result = aga_fprintf_add(fp, 3, fmt "\n", param); \
+			if(result) return result; \
+			\
+			result = aga_fprintf_add(fp, 2, "</item>\n"); \
+			if(result) return result; \
+		} while(0)
+
+	agab_("Offset", "Integer", "%zu", entry->offset);
+	agab_("Size", "Integer", "%zu", meta->stored_size);
+
+	if(meta->encoding == AGA_ENCODING_LZSS) {
+		agab_("Encoding", "String", "%s", "LZSS");
+		agab_("RawSize", "Integer", "%zu", meta->raw_size);
+	}
+
+#undef agab_
+
+	if((result = aga_build_meta_write(fp, 2, entry->kind, meta))) {
+		return result;
+	}
+
+	return aga_fprintf_add(fp, 1, "</item>\n");
+}
+
+/* Writes the table of cells over the (already grouped) manifest. */
+static enum aga_result aga_build_cells(
+		void* fp, struct aga_build_manifest* manifest,
+		struct aga_resource_pack_directory* dir) {
+
+	enum aga_result result;
+
+	aga_size_t i;
+
+	dir->cells = 0;
+
+	for(i = 0; i < manifest->len; ) {
+		struct aga_build_entry* entry = &manifest->entries[i];
+		struct aga_resource_pack_cell cell;
+
+		if(!entry->celled) {
+			++i;
+			continue;
+		}
+
+		cell.x = entry->cell_x;
+		cell.z = entry->cell_z;
+		cell.first = (aga_uint_t) i;
+
+		for(++i; i < manifest->len; ++i) {
+			struct aga_build_entry* next = &manifest->entries[i];
+
+			if(next->cell_x != cell.x || next->cell_z != cell.z) break;
+		}
+
+		cell.count = (aga_uint_t) (i - cell.first);
+
+		if((result = aga_build_write(fp, &cell, sizeof(cell)))) return result;
+
+		dir->cells++;
+	}
+
+	return AGA_RESULT_OK;
+}
+
+/* Writes the config tree, entry table and string pool from the manifest. */
+static enum aga_result aga_build_directory(
+		void* fp, struct aga_build_manifest* manifest,
+		struct aga_resource_pack_directory* dir, aga_size_t conf_base) {
+
+	enum aga_result result;
+
+	aga_size_t i;
+	aga_size_t offset = 0;
+	aga_size_t name = 0;
+	long off;
+
+	if(fputs("<root>\n", fp) == EOF) return aga_error_system(__FILE__, "fputs");
+
+	for(i = 0; i < manifest->len; ++i) {
+		struct aga_build_entry* entry = &manifest->entries[i];
+
+		entry->offset = offset;
+		offset += entry->meta.stored_size;
+
+		if((off = ftell(fp)) == -1) return aga_error_system(__FILE__, "ftell");
+		entry->conf = off - conf_base;
+
+		if((result = aga_build_conf_entry(fp, entry))) return result;
+
+		if((off = ftell(fp)) == -1) return aga_error_system(__FILE__, "ftell");
+		entry->conf_size = (off - conf_base) - entry->conf;
+	}
+
+	if(fputs("</root>\n", fp) == EOF) {
+		return aga_error_system(__FILE__, "fputs");
+	}
+
+	if((off = ftell(fp)) == -1) return aga_error_system(__FILE__, "ftell");
+	dir->conf_size = (aga_uint_t) (off - conf_base);
+
+	for(i = 0; i < manifest->len; ++i) {
+		struct aga_build_entry* entry = &manifest->entries[i];
+		struct aga_resource_pack_entry out;
+
+		out.name = (aga_uint_t) name;
+		out.offset = (aga_uint_t) entry->offset;
+		out.size = (aga_uint_t) entry->meta.stored_size;
+		out.conf = (aga_uint_t) entry->conf;
+		out.conf_size = (aga_uint_t) entry->conf_size;
+		out.encoding = (aga_uint_t) entry->meta.encoding;
+		out.raw_size = (aga_uint_t) entry->meta.raw_size;
+		out.hash = entry->hash;
+
+		result = aga_build_write(fp, &out, sizeof(out));
+		if(result) return result;
+
+		name += aga_strlen(entry->name) + 1;
+	}
+
+	for(i = 0; i < manifest->len; ++i) {
+		const char* str = manifest->entries[i].name;
+
+		result = aga_build_write(fp, str, aga_strlen(str) + 1);
+		if(result) return result;
+	}
+
+	/* Keeps the cell table aligned when the directory is read in whole. */
+	for(; name % sizeof(aga_uint_t); ++name) {
+		if(fputc(0, fp) == EOF) return aga_error_system(__FILE__, "fputc");
+	}
+
+	dir->len = (aga_uint_t) manifest->len;
+	dir->strings = (aga_uint_t) name;
+
+	return aga_build_cells(fp, manifest, dir);
+}
+
+/* Copies each entry's data in directory order. */
+static enum aga_result aga_build_data(
+		void* fp, struct aga_build_manifest* manifest) {
+
+	aga_fixed_buf_t path = { 0 };
+
+	enum aga_result result;
+
+	aga_size_t i;
+	void* in;
+
+	for(i = 0; i < manifest->len; ++i) {
+		struct aga_build_entry* entry = &manifest->entries[i];
+
+		strcpy(path, entry->name);
+		if(entry->meta.encoding != AGA_ENCODING_NONE) strcat(path, AGA_LZPATH);
+
+		if(!(in = fopen(path, "rb"))) {
+			return aga_error_system_path(__FILE__, "fopen", path);
+		}
+
+		result = aga_file_copy(fp, in, entry->meta.stored_size);
+		if(result) {
+			if(fclose(in) == EOF) (void) aga_error_system(__FILE__, "fclose");
+			return result;
+		}
+
+		if(fclose(in) == EOF) return aga_error_system(__FILE__, "fclose");
+	}
+
+	return AGA_RESULT_OK;
+}
+
+/* Lays out the whole pack from the manifest in a single pass. */
+static enum aga_result aga_build_pack(
+		void* fp, struct aga_build_manifest* manifest) {
+
+	enum aga_result result;
+
+	struct aga_resource_pack_header hdr = { 0, AGA_PACK_DIRECTORY_MAGIC };
+	struct aga_resource_pack_directory dir = { 0, 0, 0, 0 };
+	long off;
+	fpos_t mark;
+
+	result = aga_build_write(fp, &hdr, sizeof(hdr));
+	if(result) return result;
+
+	result = aga_build_write(fp, &dir, sizeof(dir));
+	if(result) return result;
+
+	result = aga_build_directory(fp, manifest, &dir, sizeof(hdr) + sizeof(dir));
+	if(result) return result;
+
+	if((off = ftell(fp)) == -1) return aga_error_system(__FILE__, "ftell");
+	hdr.size = off - sizeof(hdr);
+
+	/* The header and directory sizes are only known now -- go back. */
+	if(fgetpos(fp, &mark)) return aga_error_system(__FILE__, "fgetpos");
+
+	rewind(fp);
+
+	result = aga_build_write(fp, &hdr, sizeof(hdr));
+	if(result) return result;
+
+	result = aga_build_write(fp, &dir, sizeof(dir));
+	if(result) return result;
+
+	if(fsetpos(fp, &mark)) return aga_error_system(__FILE__, "fsetpos");
+
+	aga_log(__FILE__, "Inserting file data...");
+
+	return aga_build_data(fp, manifest);
+}
+
 static void aga_tiff_handler(
 		aga_bool_t warning, const char* module, const char* fmt, va_list ap) {
 
@@ -752,8 +3681,14 @@ enum aga_result aga_build(struct aga_settings* opts) {
 	struct aga_config_node root;
 	struct aga_config_node* input_root;
 
+	struct aga_build_manifest manifest = { 0 };
+	struct aga_build_cache cache = { 0 };
+	struct aga_build_meta meta;
+
 	void* fp = 0;
+	const char* path;
 	const char* out_path = 0;
+	aga_bool_t fresh;
 
 	aga_log(__FILE__, "Compiling project `%s'...", opts->build_file);
 
@@ -770,79 +3705,70 @@ enum aga_result aga_build(struct aga_settings* opts) {
 		goto cleanup;
 	}
 
-	if((result = aga_build_iter(input_root, AGA_TRUE, aga_build_input, 0))) {
-		goto cleanup;
-	}
-
-	if((result = aga_build_open_output(&root, &fp, &out_path))) goto cleanup;
+	path = aga_build_output_path(&root);
 
-	aga_log(__FILE__, "Building pack directory...");
-
-	{
-		struct aga_build_conf_pass conf_pass;
+	if((result = aga_build_cache_new(&cache, path))) goto cleanup;
 
-		struct aga_resource_pack_header hdr = { 0, AGA_PACK_MAGIC };
-		long off;
-		fpos_t mark;
+	/* Changes to the build file itself may change how anything is packed. */
+	result = aga_build_cache_check(
+			&cache, opts->build_file, AGA_KIND_NONE, 0, AGA_FALSE, 0, &meta,
+			&fresh);
+	if(result) goto cleanup;
 
-		conf_pass.fp = fp;
-		conf_pass.offset = 0;
+	manifest.cache = &cache;
 
-		if(fwrite(&hdr, sizeof(hdr), 1, fp) < 1) {
-			if(ferror(fp)) result = aga_error_system(__FILE__, "fwrite");
-			else result = AGA_RESULT_EOF;
+	result = aga_build_iter(
+			input_root, AGA_TRUE, aga_build_manifest_input, &manifest);
+	if(result) goto cleanup;
 
-			goto cleanup;
-		}
-		if(fputs("<root>\n", fp) == EOF) {
-			result = aga_error_system(__FILE__, "fputs");
-			goto cleanup;
-		}
+	if((result = aga_build_process_all(&manifest, opts->jobs))) goto cleanup;
+	if((result = aga_build_scenes(&manifest, &cache))) goto cleanup;
 
-		result = aga_build_iter(
-				input_root, AGA_FALSE, aga_build_conf, &conf_pass);
+	aga_build_manifest_record(&manifest, &cache);
+	aga_build_cache_prune(&cache);
 
-		if(result) goto cleanup;
+	aga_build_manifest_cells(&manifest);
 
-		if(fputs("</root>\n", fp) == EOF) {
-			result = aga_error_system(__FILE__, "fputs");
-			goto cleanup;
-		}
+	if(!cache.changed && aga_build_exists(path)) {
+		aga_log(__FILE__, "Output file `%s' is up to date", path);
 
-		if((off = ftell(fp)) == -1) {
-			result = aga_error_system(__FILE__, "ftell");
-			goto cleanup;
-		}
+		aga_error_check_soft(
+				__FILE__, "aga_build_cache_write",
+				aga_build_cache_write(&cache));
 
-		hdr.size = off - sizeof(hdr);
+		aga_build_manifest_delete(&manifest);
+		aga_build_cache_delete(&cache);
 
-		if(fgetpos(fp, &mark)) {
-			result = aga_error_system(__FILE__, "fgetpos");
-			goto cleanup;
-		}
+		if((result = aga_config_delete(&root))) return result;
 
-		rewind(fp);
+		aga_log(__FILE__, "Done!");
 
-		if(fwrite(&hdr, sizeof(hdr), 1, fp) < 1) {
-			if(ferror(fp)) result = aga_error_system(__FILE__, "fwrite");
-			else result = AGA_RESULT_EOF;
+		return AGA_RESULT_OK;
+	}
 
-			goto cleanup;
-		}
+	if((result = aga_build_open_output(path, &fp))) goto cleanup;
+	out_path = path;
 
-		if(fsetpos(fp, &mark)) {
-			result = aga_error_system(__FILE__, "fsetpos");
-			goto cleanup;
-		}
-	}
+	aga_log(__FILE__, "Building pack directory...");
 
-	aga_log(__FILE__, "Inserting file data...");
+	if((result = aga_build_pack(fp, &manifest))) goto cleanup;
 
-	if((result = aga_build_iter(input_root, AGA_FALSE, aga_build_pack, fp))) {
+	if(fclose(fp) == EOF) {
+		fp = 0;
+		result = aga_error_system(__FILE__, "fclose");
 		goto cleanup;
 	}
 
-	if(fclose(fp) == EOF) goto cleanup;
+	/*
+	 * NOTE: Only written once the pack is complete -- a failed build leaves
+	 * 		 The previous cache in place, which no longer matches. Failing to
+	 * 		 Write it only costs the next build time.
+	 */
+	aga_error_check_soft(
+			__FILE__, "aga_build_cache_write", aga_build_cache_write(&cache));
+
+	aga_build_manifest_delete(&manifest);
+	aga_build_cache_delete(&cache);
 
 	if((result = aga_config_delete(&root))) return result;
 
@@ -865,6 +3791,9 @@ enum aga_result aga_build(struct aga_settings* opts) {
 		aga_error_check_soft(
 				__FILE__, "aga_config_delete", aga_config_delete(&root));
 
+		aga_build_manifest_delete(&manifest);
+		aga_build_cache_delete(&cache);
+
 		if(fp && fclose(fp) == EOF) {
 			(void) aga_error_system(__FILE__, "fclose");
 		}
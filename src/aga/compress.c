@@ -0,0 +1,210 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#include <aga/compress.h>
+#include <aga/utility.h>
+#include <aga/log.h>
+#include <aga/std.h>
+
+#define AGA_LZ_HASH_BITS (12)
+#define AGA_LZ_HASH_SIZE (1 << AGA_LZ_HASH_BITS)
+/* How many candidates to try per position before settling. */
+#define AGA_LZ_CHAIN (64)
+#define AGA_LZ_NIL ((aga_size_t) -1)
+
+static aga_size_t aga_lz_hash(const aga_uchar_t* p) {
+	aga_size_t h = ((aga_size_t) p[0] << 8) ^ ((aga_size_t) p[1] << 4) ^ p[2];
+
+	return h & (AGA_LZ_HASH_SIZE - 1);
+}
+
+enum aga_result aga_compress(
+		const void* data, aga_size_t size, void* out, aga_size_t* out_size) {
+
+	const aga_uchar_t* src = data;
+	aga_uchar_t* dst = out;
+
+	aga_size_t* head;
+	aga_size_t* prev;
+
+	aga_size_t pos = 0;
+	aga_size_t o = 0;
+	aga_size_t flag = 0;
+	unsigned bit = 8;
+
+	aga_size_t i;
+
+	if(!data && size) return AGA_RESULT_BAD_PARAM;
+	if(!out) return AGA_RESULT_BAD_PARAM;
+	if(!out_size) return AGA_RESULT_BAD_PARAM;
+
+	if(!(head = aga_malloc(AGA_LZ_HASH_SIZE * sizeof(aga_size_t)))) {
+		return AGA_RESULT_OOM;
+	}
+
+	if(!(prev = aga_malloc(AGA_LZ_WINDOW * sizeof(aga_size_t)))) {
+		aga_free(head);
+		return AGA_RESULT_OOM;
+	}
+
+	for(i = 0; i < AGA_LZ_HASH_SIZE; ++i) head[i] = AGA_LZ_NIL;
+
+	while(pos < size) {
+		aga_size_t best_len = 0;
+		aga_size_t best_dist = 0;
+
+		if(bit == 8) {
+			flag = o++;
+			dst[flag] = 0;
+			bit = 0;
+		}
+
+		if(size - pos >= AGA_LZ_MIN_MATCH) {
+			aga_size_t max = size - pos;
+			aga_size_t cand = head[aga_lz_hash(&src[pos])];
+			unsigned depth = AGA_LZ_CHAIN;
+
+			if(max > AGA_LZ_MAX_MATCH) max = AGA_LZ_MAX_MATCH;
+
+			/*
+			 * NOTE: `prev' is a ring over the window so a candidate's link
+			 * 		 Is only trustworthy while it is still within range.
+			 */
+			while(cand != AGA_LZ_NIL && depth--) {
+				aga_size_t len = 0;
+
+				if(pos - cand > AGA_LZ_WINDOW) break;
+
+				while(len < max && src[cand + len] == src[pos + len]) ++len;
+
+				if(len > best_len) {
+					best_len = len;
+					best_dist = pos - cand;
+					if(len == max) break;
+				}
+
+				cand = prev[cand % AGA_LZ_WINDOW];
+			}
+		}
+
+		if(best_len >= AGA_LZ_MIN_MATCH) {
+			aga_size_t token = (best_dist - 1);
+
+			token |= (best_len - AGA_LZ_MIN_MATCH) << 12;
+
+			dst[o++] = (aga_uchar_t) (token & 0xFF);
+			dst[o++] = (aga_uchar_t) (token >> 8);
+		}
+		else {
+			dst[flag] |= (aga_uchar_t) (1 << bit);
+			dst[o++] = src[pos];
+			best_len = 1;
+		}
+
+		++bit;
+
+		/* Every position we step over needs to be findable later. */
+		for(i = 0; i < best_len; ++i, ++pos) {
+			if(size - pos >= AGA_LZ_MIN_MATCH) {
+				aga_size_t h = aga_lz_hash(&src[pos]);
+
+				prev[pos % AGA_LZ_WINDOW] = head[h];
+				head[h] = pos;
+			}
+		}
+	}
+
+	aga_free(prev);
+	aga_free(head);
+
+	*out_size = o;
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_decompressor_new(
+		struct aga_decompressor* lz, void* out, aga_size_t size) {
+
+	if(!lz) return AGA_RESULT_BAD_PARAM;
+	if(!out && size) return AGA_RESULT_BAD_PARAM;
+
+	aga_bzero(lz, sizeof(struct aga_decompressor));
+
+	lz->out = out;
+	lz->size = size;
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_decompressor_feed(
+		struct aga_decompressor* lz, const void* data, aga_size_t size) {
+
+	const aga_uchar_t* p = data;
+	const aga_uchar_t* end = p + size;
+
+	if(!lz) return AGA_RESULT_BAD_PARAM;
+	if(!data && size) return AGA_RESULT_BAD_PARAM;
+
+	while(p < end) {
+		if(lz->partial) {
+			aga_size_t token = lz->low | ((aga_size_t) *p++ << 8);
+			aga_size_t dist = (token & 0xFFF) + 1;
+			aga_size_t len = (token >> 12) + AGA_LZ_MIN_MATCH;
+			aga_size_t i;
+
+			lz->partial = AGA_FALSE;
+
+			if(dist > lz->pos || len > lz->size - lz->pos) {
+				aga_log(__FILE__, "err: Bad back reference in compressed data");
+				return AGA_RESULT_BAD_PARAM;
+			}
+
+			/* NOTE: Matches may overlap their own output. */
+			for(i = 0; i < len; ++i, ++lz->pos) {
+				lz->out[lz->pos] = lz->out[lz->pos - dist];
+			}
+
+			continue;
+		}
+
+		if(!lz->bits) {
+			lz->flags = *p++;
+			lz->bits = 8;
+			continue;
+		}
+
+		--lz->bits;
+
+		if(lz->flags & 1) {
+			if(lz->pos == lz->size) {
+				aga_log(__FILE__, "err: Compressed data overruns its size");
+				return AGA_RESULT_BAD_PARAM;
+			}
+
+			lz->out[lz->pos++] = *p++;
+		}
+		else {
+			lz->low = *p++;
+			lz->partial = AGA_TRUE;
+		}
+
+		lz->flags >>= 1;
+	}
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_decompressor_end(struct aga_decompressor* lz) {
+	if(!lz) return AGA_RESULT_BAD_PARAM;
+
+	if(lz->partial || lz->pos != lz->size) {
+		aga_log(
+				__FILE__, "err: Compressed data ended early (`%zu/%zu')",
+				lz->pos, lz->size);
+		return AGA_RESULT_EOF;
+	}
+
+	return AGA_RESULT_OK;
+}
@@ -12,6 +12,8 @@
 #include <aga/utility.h>
 #include <aga/std.h>
 
+#include <apro.h>
+
 /* Very nasty dependency to leak - keep it contained! */
 #include <SGML.h>
 
@@ -32,6 +34,9 @@ enum aga_sgml_item_attribs {
 
 #define AGA_CONFIG_MAX_DEPTH (1024)
 
+/* Bytes read from the stream at a time when not parsing from memory. */
+#define AGA_CONFIG_BLOCK (4096)
+
 struct aga_sgml_structured {
 	const HTStructuredClass* class;
 
@@ -71,20 +76,62 @@ static void aga_sgml_abort(struct aga_sgml_structured* me, HTError e) {
 	(void) e;
 }
 
+/*
+ * NOTE: Text and child arrays grow geometrically while parsing. Only the parser
+ * 		 Ever grows them so their capacity is implied by their length rather
+ * 		 Than stored.
+ */
+static aga_size_t aga_sgml_capacity(aga_size_t len) {
+	aga_size_t cap = 16;
+
+	while(cap < len) cap <<= 1;
+
+	return cap;
+}
+
+/* Gives back the slack once a node is complete -- conf trees can be held. */
+static void aga_sgml_trim(struct aga_config_node* node) {
+	if(node->children) {
+		aga_size_t sz = node->len * sizeof(struct aga_config_node);
+		void* children;
+
+		if((children = aga_realloc(node->children, sz))) {
+			node->children = children;
+		}
+	}
+
+	if(node->type == AGA_STRING && node->data.string) {
+		aga_size_t sz = strlen(node->data.string) + 1;
+		char* string;
+
+		if((string = aga_realloc(node->data.string, sz))) {
+			node->data.string = string;
+		}
+	}
+}
+
 static void aga_sgml_putc(struct aga_sgml_structured* me, char c) {
 	struct aga_config_node* node = me->stack[me->depth - 1];
+	char* string = node->data.string;
+	aga_size_t len = node->scratch;
 
 	if(node->type == AGA_NONE) return;
-	if(!node->data.string && aga_isblank(c)) return;
+	if(!string && aga_isblank(c)) return;
 
-	node->data.string = aga_realloc(node->data.string, ++node->scratch + 1);
-	if(!node->data.string) {
-		aga_error_system(__FILE__, "aga_realloc");
-		return;
+	/* Room for the new character and its terminator. */
+	if(!string || len + 2 > aga_sgml_capacity(len + 1)) {
+		aga_size_t sz = aga_sgml_capacity(len + 2);
+
+		if(!(string = aga_realloc(string, sz))) {
+			aga_error_system(__FILE__, "aga_realloc");
+			return;
+		}
+
+		node->data.string = string;
 	}
 
-	node->data.string[node->scratch - 1] = c;
-	node->data.string[node->scratch] = 0;
+	string[len] = c;
+	string[++node->scratch] = 0;
 }
 
 static void aga_sgml_puts(HTStructured* me, const char* str) {
@@ -106,14 +153,23 @@ void aga_sgml_start_element(
 	struct aga_config_node* node;
 	enum aga_result result;
 
-	aga_size_t sz = ++parent->len * sizeof(struct aga_config_node);
+	if(!parent->children ||
+		parent->len + 1 > aga_sgml_capacity(parent->len)) {
 
-	if(!(parent->children = aga_realloc(parent->children, sz))) {
-		aga_error_system(__FILE__, "aga_realloc");
-		parent->len = 0;
-		return;
+		aga_size_t sz = aga_sgml_capacity(parent->len + 1);
+		void* children;
+
+		sz *= sizeof(struct aga_config_node);
+		if(!(children = aga_realloc(parent->children, sz))) {
+			aga_error_system(__FILE__, "aga_realloc");
+			return;
+		}
+
+		parent->children = children;
 	}
 
+	parent->len++;
+
 	node = &parent->children[parent->len - 1];
 	memset(node, 0, sizeof(struct aga_config_node));
 
@@ -206,6 +262,8 @@ void aga_sgml_end_element(struct aga_sgml_structured* me, int element_number) {
 		}
 	}
 
+	aga_sgml_trim(node);
+
 	me->depth--;
 }
 
@@ -220,8 +278,10 @@ void HTOOM(const char* file, const char* func) {
 	aga_error_abort();
 }
 
-enum aga_result aga_config_new(
-		void* fp, aga_size_t count, struct aga_config_node* root) {
+/* Reads from `buf' if it's non-null, otherwise `fp'. */
+static enum aga_result aga_config_parse(
+		void* fp, const char* buf, aga_size_t count,
+		struct aga_config_node* root) {
 
 	enum aga_result result;
 
@@ -273,28 +333,142 @@ enum aga_result aga_config_new(
 	dtd.tags = tags;
 	dtd.number_of_tags = AGA_LEN(tags);
 
+	apro_stamp_start(APRO_CONF_PARSE);
+
 	s = SGML_new(&dtd, (HTStructured*) &structured);
 
-	for(i = 0; i < count; ++i) {
-		int c = fgetc(fp);
+	if(buf) {
+		for(i = 0; i < count; ++i) SGML_character(s, buf[i]);
+	}
+	else {
+		/* NOTE: libwww has no block interface so this is still per-byte. */
+		char block[AGA_CONFIG_BLOCK];
 
-		if(c == EOF) {
-			if(feof(fp)) break;
+		for(i = 0; i < count;) {
+			aga_size_t j, n = count - i;
 
-			SGML_free(s);
+			if(n > sizeof(block)) n = sizeof(block);
 
-			return aga_error_system_path(
-					__FILE__, "fgetc", aga_config_debug_file);
-		}
+			if((n = fread(block, 1, n, fp)) == 0) {
+				if(feof(fp)) break;
+
+				SGML_free(s);
+
+				apro_stamp_end(APRO_CONF_PARSE);
+
+				return aga_error_system_path(
+						__FILE__, "fread", aga_config_debug_file);
+			}
+
+			for(j = 0; j < n; ++j) SGML_character(s, block[j]);
 
-		SGML_character(s, (char) c);
+			i += n;
+		}
 	}
 
 	SGML_free(s);
 
+	/* The root is never ended as an element. */
+	aga_sgml_trim(root);
+
+	apro_stamp_end(APRO_CONF_PARSE);
+
 	return AGA_RESULT_OK;
 }
 
+enum aga_result aga_config_new(
+		void* fp, aga_size_t count, struct aga_config_node* root) {
+
+	return aga_config_parse(fp, 0, count, root);
+}
+
+enum aga_result aga_config_new_buffer(
+		const void* buf, aga_size_t count, struct aga_config_node* root) {
+
+	if(!buf) return AGA_RESULT_BAD_PARAM;
+
+	return aga_config_parse(0, buf, count, root);
+}
+
+#ifdef AGA_DEVBUILD
+static void aga_config_bench_log(
+		const char* from, aga_size_t runs, apro_unit_t us) {
+
+	aga_log(
+			__FILE__, "%s: %luus total, %luus per parse", from,
+			(unsigned long) us, (unsigned long) (us / runs));
+}
+
+/* NOTE: Timings come from `apro' so read as zero under `APRO_DISABLE'. */
+enum aga_result aga_config_bench(const char* path, aga_size_t runs) {
+	enum aga_result result;
+
+	union aga_file_attribute attr;
+	struct aga_config_node root;
+	void* fp;
+	void* buf = 0;
+	aga_size_t i;
+
+	if(!path) return AGA_RESULT_BAD_PARAM;
+	if(!runs) return AGA_RESULT_BAD_PARAM;
+
+	result = aga_file_attribute_path(path, AGA_FILE_LENGTH, &attr);
+	if(result) return result;
+
+	if(!(fp = fopen(path, "rb"))) {
+		return aga_error_system_path(__FILE__, "fopen", path);
+	}
+
+	if(!(buf = aga_malloc(attr.length))) {
+		result = AGA_RESULT_OOM;
+		goto cleanup;
+	}
+
+	if((result = aga_file_read(buf, attr.length, fp))) goto cleanup;
+
+	aga_config_debug_file = path;
+
+	aga_log(
+			__FILE__, "Parsing `%s' (%lu bytes) %lu times", path,
+			(unsigned long) attr.length, (unsigned long) runs);
+
+	apro_clear();
+
+	for(i = 0; i < runs; ++i) {
+		if(fseek(fp, 0, SEEK_SET)) {
+			result = aga_error_system_path(__FILE__, "fseek", path);
+			goto cleanup;
+		}
+
+		if((result = aga_config_new(fp, attr.length, &root))) goto cleanup;
+		if((result = aga_config_delete(&root))) goto cleanup;
+	}
+
+	aga_config_bench_log("stream", runs, apro_stamp_us(APRO_CONF_PARSE));
+
+	apro_clear();
+
+	for(i = 0; i < runs; ++i) {
+		result = aga_config_new_buffer(buf, attr.length, &root);
+		if(result) goto cleanup;
+
+		if((result = aga_config_delete(&root))) goto cleanup;
+	}
+
+	aga_config_bench_log("memory", runs, apro_stamp_us(APRO_CONF_PARSE));
+
+	cleanup: {
+		aga_free(buf);
+
+		if(fclose(fp) == EOF) {
+			return aga_error_system_path(__FILE__, "fclose", path);
+		}
+
+		return result;
+	}
+}
+#endif
+
 void aga_free_node(struct aga_config_node* node) {
 	aga_size_t i;
 
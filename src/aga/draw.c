@@ -129,6 +129,29 @@ enum aga_result aga_draw_fidelity(aga_bool_t hq) {
 	return AGA_RESULT_OK;
 }
 
+aga_bool_t aga_draw_have_gl11(void) {
+	static aga_bool_t known = AGA_FALSE;
+	static aga_bool_t have = AGA_FALSE;
+
+	const char* version;
+	int major, minor;
+
+	if(known) return have;
+
+	if(!(version = (const char*) glGetString(GL_VERSION))) {
+		(void) aga_error_gl(__FILE__, "glGetString");
+		return AGA_FALSE;
+	}
+
+	if(sscanf(version, "%d.%d", &major, &minor) == 2) {
+		have = major > 1 || (major == 1 && minor >= 1);
+	}
+
+	known = AGA_TRUE;
+
+	return have;
+}
+
 enum aga_result aga_renderer_string(const char** out) {
 	static aga_fixed_buf_t buf = { 0 };
 
@@ -3,6 +3,11 @@
  * Copyright (C) 2023, 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
  */
 
+/* NOTE: We need this to get `pread' in strict ANSI mode. */
+#ifndef _XOPEN_SOURCE
+# define _XOPEN_SOURCE 500
+#endif
+
 #include <aga/io.h>
 #include <aga/error.h>
 #include <aga/log.h>
@@ -14,6 +19,17 @@
 #define AGA_WANT_WINDOWS_H
 #include <aga/win32.h>
 
+#if !defined(AGA_HAVE_PREAD) && defined(AGA_HAVE_PTHREAD)
+# include <pthread.h>
+
+/*
+ * NOTE: The seek and read fallback for `aga_file_read_offset' moves the
+ * 		 Stream position, so it's serialised between the loader thread and
+ * 		 The main thread which share the pack's read handle.
+ */
+static pthread_mutex_t aga_read_offset_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /* TODO: Implement BSD-y `<sys/dir.h>' `direct' interface  */
 enum aga_result aga_directory_iterate(
 		const char* path, aga_directory_callback_t fn, aga_bool_t recurse,
@@ -514,6 +530,85 @@ enum aga_result aga_file_read(void* data, aga_size_t size, void* fp) {
 	return AGA_RESULT_OK;
 }
 
+enum aga_result aga_file_read_offset(
+		void* fp, aga_size_t offset, void* data, aga_size_t size) {
+
+#ifdef AGA_NIXPREAD
+	int fd;
+	aga_size_t total = 0;
+
+	if(!fp) return AGA_RESULT_BAD_PARAM;
+	if(!data) return AGA_RESULT_BAD_PARAM;
+
+	if((fd = fileno(fp)) == -1) return aga_error_system(__FILE__, "fileno");
+
+	while(total < size) {
+		aga_uchar_t* p = (aga_uchar_t*) data + total;
+		ssize_t rdsz = pread(fd, p, size - total, (off_t) (offset + total));
+
+		if(rdsz == -1) {
+			if(errno == EINTR) continue;
+			return aga_error_system(__FILE__, "pread");
+		}
+
+		if(!rdsz) return AGA_RESULT_EOF;
+
+		total += (aga_size_t) rdsz;
+	}
+
+	return AGA_RESULT_OK;
+#elif defined(AGA_WINPREAD)
+	HANDLE file;
+	OVERLAPPED overlapped = { 0 };
+	DWORD rdsz;
+
+	if(!fp) return AGA_RESULT_BAD_PARAM;
+	if(!data) return AGA_RESULT_BAD_PARAM;
+
+	file = (HANDLE) _get_osfhandle(_fileno(fp));
+	if(file == INVALID_HANDLE_VALUE) {
+		return aga_error_system(__FILE__, "_get_osfhandle");
+	}
+
+	/* NOTE: Split shift so this stays defined for a 32-bit `aga_size_t'. */
+	overlapped.Offset = (DWORD) (offset & 0xFFFFFFFF);
+	overlapped.OffsetHigh = (DWORD) ((offset >> 16) >> 16);
+
+	if(!ReadFile(file, data, (DWORD) size, &rdsz, &overlapped)) {
+		if(GetLastError() == ERROR_HANDLE_EOF) return AGA_RESULT_EOF;
+		return aga_win32_error(__FILE__, "ReadFile");
+	}
+
+	if(rdsz < size) return AGA_RESULT_EOF;
+
+	return AGA_RESULT_OK;
+#else
+	enum aga_result result;
+
+	if(!fp) return AGA_RESULT_BAD_PARAM;
+	if(!data) return AGA_RESULT_BAD_PARAM;
+
+# ifdef AGA_HAVE_PTHREAD
+	if(pthread_mutex_lock(&aga_read_offset_lock)) {
+		return aga_error_system(__FILE__, "pthread_mutex_lock");
+	}
+# endif
+
+	if(fseek(fp, (long) offset, SEEK_SET)) {
+		result = aga_error_system(__FILE__, "fseek");
+	}
+	else result = aga_file_read(data, size, fp);
+
+# ifdef AGA_HAVE_PTHREAD
+	if(pthread_mutex_unlock(&aga_read_offset_lock)) {
+		(void) aga_error_system(__FILE__, "pthread_mutex_unlock");
+	}
+# endif
+
+	return result;
+#endif
+}
+
 enum aga_result aga_file_print_characters(int c, aga_size_t n, void* fp) {
 	aga_size_t i;
 
@@ -524,6 +619,75 @@ enum aga_result aga_file_print_characters(int c, aga_size_t n, void* fp) {
 	return AGA_RESULT_OK;
 }
 
+#ifdef AGA_HAVE_MAP
+# ifdef AGA_NIXMAP
+enum aga_result aga_file_map(void* fp, aga_size_t size, void** out) {
+	int fd;
+	void* p;
+
+	if(!fp) return AGA_RESULT_BAD_PARAM;
+	if(!out) return AGA_RESULT_BAD_PARAM;
+
+	if((fd = fileno(fp)) == -1) return aga_error_system(__FILE__, "fileno");
+
+	p = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+	if(p == MAP_FAILED) return aga_error_system(__FILE__, "mmap");
+
+	*out = p;
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_file_unmap(void* p, aga_size_t size) {
+	if(!p) return AGA_RESULT_BAD_PARAM;
+
+	if(munmap(p, size) == -1) return aga_error_system(__FILE__, "munmap");
+
+	return AGA_RESULT_OK;
+}
+# elif defined(AGA_WINMAP)
+enum aga_result aga_file_map(void* fp, aga_size_t size, void** out) {
+	HANDLE file;
+	HANDLE mapping;
+	void* p;
+
+	if(!fp) return AGA_RESULT_BAD_PARAM;
+	if(!out) return AGA_RESULT_BAD_PARAM;
+
+	file = (HANDLE) _get_osfhandle(_fileno(fp));
+	if(file == INVALID_HANDLE_VALUE) {
+		return aga_error_system(__FILE__, "_get_osfhandle");
+	}
+
+	mapping = CreateFileMapping(file, 0, PAGE_READONLY, 0, 0, 0);
+	if(!mapping) return aga_win32_error(__FILE__, "CreateFileMapping");
+
+	p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+
+	/* The view holds its own reference to the mapping object. */
+	if(!CloseHandle(mapping)) {
+		(void) aga_win32_error(__FILE__, "CloseHandle");
+	}
+
+	if(!p) return aga_win32_error(__FILE__, "MapViewOfFile");
+
+	*out = p;
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_file_unmap(void* p, aga_size_t size) {
+	(void) size;
+
+	if(!p) return AGA_RESULT_BAD_PARAM;
+
+	if(!UnmapViewOfFile(p)) return aga_win32_error(__FILE__, "UnmapViewOfFile");
+
+	return AGA_RESULT_OK;
+}
+# endif
+#endif
+
 #ifdef AGA_HAVE_SPAWN
 # ifdef AGA_NIXSPAWN
 /*
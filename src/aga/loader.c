@@ -0,0 +1,540 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#include <aga/loader.h>
+#include <aga/pack.h>
+#include <aga/log.h>
+#include <aga/error.h>
+#include <aga/utility.h>
+#include <aga/std.h>
+
+#define AGA_WANT_WINDOWS_H
+#include <aga/win32.h>
+
+#ifdef AGA_NIXTHREAD
+# include <pthread.h>
+#endif
+
+/*
+ * NOTE: Threads very much aren't 1992 -- this is a strictly optional
+ * 		 Accelerator and everything here must keep working in the synchronous
+ * 		 Fallback.
+ */
+
+/* We don't care about the real page size - we just need to land on each. */
+#define AGA_LOADER_TOUCH_STRIDE (4096)
+
+#ifdef AGA_NIXTHREAD
+struct aga_loader_sync {
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t work;
+	pthread_cond_t done;
+};
+
+static void aga_loader_lock(struct aga_loader_sync* sync) {
+	if(pthread_mutex_lock(&sync->mutex)) {
+		(void) aga_error_system(__FILE__, "pthread_mutex_lock");
+	}
+}
+
+static void aga_loader_unlock(struct aga_loader_sync* sync) {
+	if(pthread_mutex_unlock(&sync->mutex)) {
+		(void) aga_error_system(__FILE__, "pthread_mutex_unlock");
+	}
+}
+
+static void aga_loader_signal_work(struct aga_loader_sync* sync) {
+	if(pthread_cond_signal(&sync->work)) {
+		(void) aga_error_system(__FILE__, "pthread_cond_signal");
+	}
+}
+
+static void aga_loader_signal_done(struct aga_loader_sync* sync) {
+	if(pthread_cond_broadcast(&sync->done)) {
+		(void) aga_error_system(__FILE__, "pthread_cond_broadcast");
+	}
+}
+
+/* Must be called with the lock held. */
+static void aga_loader_wait_work(struct aga_loader_sync* sync) {
+	if(pthread_cond_wait(&sync->work, &sync->mutex)) {
+		(void) aga_error_system(__FILE__, "pthread_cond_wait");
+	}
+}
+
+/* Must be called with the lock held. */
+static void aga_loader_wait_done(struct aga_loader_sync* sync) {
+	if(pthread_cond_wait(&sync->done, &sync->mutex)) {
+		(void) aga_error_system(__FILE__, "pthread_cond_wait");
+	}
+}
+#elif defined(AGA_WINTHREAD)
+struct aga_loader_sync {
+	HANDLE thread;
+	CRITICAL_SECTION lock;
+	HANDLE work;
+	HANDLE done;
+};
+
+static void aga_loader_lock(struct aga_loader_sync* sync) {
+	EnterCriticalSection(&sync->lock);
+}
+
+static void aga_loader_unlock(struct aga_loader_sync* sync) {
+	LeaveCriticalSection(&sync->lock);
+}
+
+static void aga_loader_signal_work(struct aga_loader_sync* sync) {
+	if(!SetEvent(sync->work)) (void) aga_win32_error(__FILE__, "SetEvent");
+}
+
+static void aga_loader_signal_done(struct aga_loader_sync* sync) {
+	if(!SetEvent(sync->done)) (void) aga_win32_error(__FILE__, "SetEvent");
+}
+
+/* Must be called with the lock held. */
+static void aga_loader_wait_work(struct aga_loader_sync* sync) {
+	LeaveCriticalSection(&sync->lock);
+
+	if(WaitForSingleObject(sync->work, INFINITE) == WAIT_FAILED) {
+		(void) aga_win32_error(__FILE__, "WaitForSingleObject");
+	}
+
+	EnterCriticalSection(&sync->lock);
+}
+
+/* Must be called with the lock held. */
+static void aga_loader_wait_done(struct aga_loader_sync* sync) {
+	LeaveCriticalSection(&sync->lock);
+
+	if(WaitForSingleObject(sync->done, INFINITE) == WAIT_FAILED) {
+		(void) aga_win32_error(__FILE__, "WaitForSingleObject");
+	}
+
+	EnterCriticalSection(&sync->lock);
+}
+#endif
+
+static void aga_resource_loader_service(
+		struct aga_resource_loader* loader, struct aga_resource_request* req) {
+
+	struct aga_resource* res = req->resource;
+
+	req->result = aga_resource_load(res, &req->data);
+	if(req->result) {
+		aga_error_check_soft(__FILE__, "aga_resource_load", req->result);
+		return;
+	}
+
+	/*
+	 * Mapped data is "loaded" by faulting it in here so the main thread
+	 * Doesn't end up stalling on the disk instead.
+	 */
+	if(loader->pack->map && res->encoding == AGA_ENCODING_NONE) {
+		const volatile aga_uchar_t* p = req->data;
+		aga_size_t i;
+
+		for(i = 0; i < res->size; i += AGA_LOADER_TOUCH_STRIDE) (void) p[i];
+	}
+}
+
+static void aga_resource_loader_push(
+		struct aga_resource_request** head, struct aga_resource_request** tail,
+		struct aga_resource_request* req) {
+
+	req->next = 0;
+
+	if(*tail) (*tail)->next = req;
+	else *head = req;
+
+	*tail = req;
+}
+
+static struct aga_resource_request* aga_resource_loader_pop(
+		struct aga_resource_request** head,
+		struct aga_resource_request** tail) {
+
+	struct aga_resource_request* req = *head;
+
+	if(!req) return 0;
+
+	*head = req->next;
+	if(!*head) *tail = 0;
+
+	return req;
+}
+
+static void aga_resource_loader_discard(struct aga_resource_request* req) {
+	if(req->data) aga_resource_discard(req->resource, req->data);
+	aga_free(req);
+}
+
+#ifdef AGA_HAVE_THREADS
+static void aga_resource_loader_work(struct aga_resource_loader* loader) {
+	struct aga_loader_sync* sync = loader->sync;
+
+	while(AGA_TRUE) {
+		struct aga_resource_request* req;
+
+		aga_loader_lock(sync);
+
+		while(!loader->pending && !loader->die) aga_loader_wait_work(sync);
+
+		if(loader->die) {
+			aga_loader_unlock(sync);
+			return;
+		}
+
+		req = aga_resource_loader_pop(&loader->pending, &loader->pending_tail);
+
+		aga_loader_unlock(sync);
+
+		aga_resource_loader_service(loader, req);
+
+		aga_loader_lock(sync);
+
+		aga_resource_loader_push(
+				&loader->complete, &loader->complete_tail, req);
+
+		aga_loader_signal_done(sync);
+
+		aga_loader_unlock(sync);
+	}
+}
+
+# ifdef AGA_NIXTHREAD
+static void* aga_resource_loader_thread(void* pass) {
+	aga_resource_loader_work(pass);
+
+	return 0;
+}
+# elif defined(AGA_WINTHREAD)
+static DWORD WINAPI aga_resource_loader_thread(LPVOID pass) {
+	aga_resource_loader_work(pass);
+
+	return 0;
+}
+# endif
+#endif
+
+enum aga_result aga_resource_loader_new(
+		struct aga_resource_loader* loader, struct aga_resource_pack* pack) {
+
+#ifdef AGA_HAVE_THREADS
+	enum aga_result result;
+	struct aga_loader_sync* sync;
+# ifdef AGA_NIXTHREAD
+	unsigned made = 0; /* How many of the primitives are initialised. */
+# endif
+#endif
+
+	if(!loader) return AGA_RESULT_BAD_PARAM;
+	if(!pack) return AGA_RESULT_BAD_PARAM;
+	if(!pack->path) return AGA_RESULT_BAD_PARAM;
+
+	aga_bzero(loader, sizeof(struct aga_resource_loader));
+
+	loader->pack = pack;
+
+#ifdef AGA_HAVE_THREADS
+	if(!(sync = aga_calloc(1, sizeof(struct aga_loader_sync)))) {
+		return AGA_RESULT_OOM;
+	}
+
+	loader->sync = sync;
+
+# ifdef AGA_NIXTHREAD
+	if(pthread_mutex_init(&sync->mutex, 0)) {
+		result = aga_error_system(__FILE__, "pthread_mutex_init");
+		goto cleanup;
+	}
+	made++;
+
+	if(pthread_cond_init(&sync->work, 0)) {
+		result = aga_error_system(__FILE__, "pthread_cond_init");
+		goto cleanup;
+	}
+	made++;
+
+	if(pthread_cond_init(&sync->done, 0)) {
+		result = aga_error_system(__FILE__, "pthread_cond_init");
+		goto cleanup;
+	}
+	made++;
+
+	if(pthread_create(&sync->thread, 0, aga_resource_loader_thread, loader)) {
+		result = aga_error_system(__FILE__, "pthread_create");
+		goto cleanup;
+	}
+# elif defined(AGA_WINTHREAD)
+	InitializeCriticalSection(&sync->lock);
+
+	if(!(sync->work = CreateEvent(0, FALSE, FALSE, 0))) {
+		result = aga_win32_error(__FILE__, "CreateEvent");
+		goto cleanup;
+	}
+
+	if(!(sync->done = CreateEvent(0, FALSE, FALSE, 0))) {
+		result = aga_win32_error(__FILE__, "CreateEvent");
+		goto cleanup;
+	}
+
+	sync->thread = CreateThread(0, 0, aga_resource_loader_thread, loader, 0, 0);
+	if(!sync->thread) {
+		result = aga_win32_error(__FILE__, "CreateThread");
+		goto cleanup;
+	}
+# endif
+#else
+	aga_log(
+			__FILE__, "warn: No thread support -- resource requests will be "
+					  "serviced synchronously");
+#endif
+
+	return AGA_RESULT_OK;
+
+#ifdef AGA_HAVE_THREADS
+	/* The worker is never running by the time we get here. */
+	cleanup: {
+# ifdef AGA_NIXTHREAD
+		if(made > 2) (void) pthread_cond_destroy(&sync->done);
+		if(made > 1) (void) pthread_cond_destroy(&sync->work);
+		if(made > 0) (void) pthread_mutex_destroy(&sync->mutex);
+# elif defined(AGA_WINTHREAD)
+		if(sync->done) (void) CloseHandle(sync->done);
+		if(sync->work) (void) CloseHandle(sync->work);
+
+		DeleteCriticalSection(&sync->lock);
+# endif
+
+		aga_free(sync);
+		loader->sync = 0;
+
+		return result;
+	}
+#endif
+}
+
+enum aga_result aga_resource_loader_delete(struct aga_resource_loader* loader) {
+	struct aga_resource_request* req;
+
+#ifdef AGA_HAVE_THREADS
+	struct aga_loader_sync* sync;
+#endif
+
+	if(!loader) return AGA_RESULT_BAD_PARAM;
+
+#ifdef AGA_HAVE_THREADS
+	sync = loader->sync;
+
+	aga_loader_lock(sync);
+	loader->die = AGA_TRUE;
+	aga_loader_signal_work(sync);
+	aga_loader_unlock(sync);
+
+# ifdef AGA_NIXTHREAD
+	if(pthread_join(sync->thread, 0)) {
+		return aga_error_system(__FILE__, "pthread_join");
+	}
+
+	if(pthread_cond_destroy(&sync->done)) {
+		return aga_error_system(__FILE__, "pthread_cond_destroy");
+	}
+
+	if(pthread_cond_destroy(&sync->work)) {
+		return aga_error_system(__FILE__, "pthread_cond_destroy");
+	}
+
+	if(pthread_mutex_destroy(&sync->mutex)) {
+		return aga_error_system(__FILE__, "pthread_mutex_destroy");
+	}
+# elif defined(AGA_WINTHREAD)
+	if(WaitForSingleObject(sync->thread, INFINITE) == WAIT_FAILED) {
+		return aga_win32_error(__FILE__, "WaitForSingleObject");
+	}
+
+	if(!CloseHandle(sync->thread)) return aga_win32_error(__FILE__, "CloseHandle");
+	if(!CloseHandle(sync->work)) return aga_win32_error(__FILE__, "CloseHandle");
+	if(!CloseHandle(sync->done)) return aga_win32_error(__FILE__, "CloseHandle");
+
+	DeleteCriticalSection(&sync->lock);
+# endif
+
+	aga_free(sync);
+#endif
+
+	while((req = aga_resource_loader_pop(
+			&loader->pending, &loader->pending_tail))) {
+
+		aga_resource_loader_discard(req);
+	}
+
+	while((req = aga_resource_loader_pop(
+			&loader->complete, &loader->complete_tail))) {
+
+		aga_resource_loader_discard(req);
+	}
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_resource_request(
+		struct aga_resource_loader* loader, const char* path,
+		aga_resource_callback_t callback, void* pass) {
+
+	enum aga_result result;
+
+	struct aga_resource* res;
+	struct aga_resource_request* req;
+
+	if(!loader) return AGA_RESULT_BAD_PARAM;
+	if(!path) return AGA_RESULT_BAD_PARAM;
+
+	result = aga_resource_pack_lookup(loader->pack, path, &res);
+	if(result) return result;
+
+	if(res->data) {
+		if((result = aga_resource_aquire(res))) return result;
+		if(callback) callback(res, AGA_RESULT_OK, pass);
+
+		return AGA_RESULT_OK;
+	}
+
+	if(!(req = aga_calloc(1, sizeof(struct aga_resource_request)))) {
+		return AGA_RESULT_OOM;
+	}
+
+	req->resource = res;
+	req->callback = callback;
+	req->pass = pass;
+
+	++loader->outstanding;
+
+#ifdef AGA_HAVE_THREADS
+	aga_loader_lock(loader->sync);
+#endif
+
+	aga_resource_loader_push(&loader->pending, &loader->pending_tail, req);
+
+#ifdef AGA_HAVE_THREADS
+	aga_loader_signal_work(loader->sync);
+	aga_loader_unlock(loader->sync);
+#endif
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_resource_cancel(
+		struct aga_resource_loader* loader, aga_resource_callback_t callback,
+		void* pass) {
+
+	struct aga_resource_request* prev = 0;
+	struct aga_resource_request* req;
+
+	if(!loader) return AGA_RESULT_BAD_PARAM;
+
+#ifdef AGA_HAVE_THREADS
+	aga_loader_lock(loader->sync);
+#endif
+
+	for(req = loader->pending; req; prev = req, req = req->next) {
+		if(req->callback != callback || req->pass != pass) continue;
+
+		if(prev) prev->next = req->next;
+		else loader->pending = req->next;
+
+		if(loader->pending_tail == req) loader->pending_tail = prev;
+
+		break;
+	}
+
+#ifdef AGA_HAVE_THREADS
+	aga_loader_unlock(loader->sync);
+#endif
+
+	if(!req) return AGA_RESULT_MISSING_KEY;
+
+	--loader->outstanding;
+	aga_free(req);
+
+	return AGA_RESULT_OK;
+}
+
+static void aga_resource_loader_dispatch(
+		struct aga_resource_loader* loader, struct aga_resource_request* req) {
+
+	struct aga_resource* res = req->resource;
+	enum aga_result result = req->result;
+
+	--loader->outstanding;
+
+	if(!result) {
+		/* Discards our copy if someone loaded it while we were busy. */
+		result = aga_resource_adopt(res, req->data);
+		if(!result) result = aga_resource_aquire(res);
+	}
+	else if(req->data) aga_resource_discard(res, req->data);
+
+	if(req->callback) req->callback(res, result, req->pass);
+
+	aga_free(req);
+}
+
+enum aga_result aga_resource_loader_poll(struct aga_resource_loader* loader) {
+	struct aga_resource_request* req;
+	struct aga_resource_request* complete;
+
+	if(!loader) return AGA_RESULT_BAD_PARAM;
+
+#ifdef AGA_HAVE_THREADS
+	aga_loader_lock(loader->sync);
+#else
+	while((req = aga_resource_loader_pop(
+			&loader->pending, &loader->pending_tail))) {
+
+		aga_resource_loader_service(loader, req);
+		aga_resource_loader_push(
+				&loader->complete, &loader->complete_tail, req);
+	}
+#endif
+
+	complete = loader->complete;
+	loader->complete = 0;
+	loader->complete_tail = 0;
+
+#ifdef AGA_HAVE_THREADS
+	aga_loader_unlock(loader->sync);
+#endif
+
+	while(complete) {
+		req = complete;
+		complete = complete->next;
+
+		aga_resource_loader_dispatch(loader, req);
+	}
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_resource_loader_wait(struct aga_resource_loader* loader) {
+	enum aga_result result;
+
+	if(!loader) return AGA_RESULT_BAD_PARAM;
+
+	while(loader->outstanding) {
+#ifdef AGA_HAVE_THREADS
+		aga_loader_lock(loader->sync);
+
+		while(!loader->complete) aga_loader_wait_done(loader->sync);
+
+		aga_loader_unlock(loader->sync);
+#endif
+
+		if((result = aga_resource_loader_poll(loader))) return result;
+	}
+
+	return AGA_RESULT_OK;
+}
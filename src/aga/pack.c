@@ -10,13 +10,10 @@
 #include <aga/std.h>
 #include <aga/utility.h>
 #include <aga/script.h>
+#include <aga/compress.h>
 
-/*
- * TODO: Allow inplace use of UNIX `compress'/`uncompress' utilities on pack
- * 		 In distribution.
- * 		 Windows apparently had `COMPRESS.EXE' and could use `LZRead' etc. for
- * 		 In-place compressed reads (!).
- */
+/* Encoded data is read through a buffer of this size when not mapped. */
+#define AGA_RESOURCE_DECODE_CHUNK (16384)
 
 /*
  * TODO: Allow pack input as a "raw" argument and make space for a shebang so
@@ -26,99 +23,138 @@
 
 struct aga_resource_pack* aga_global_pack = 0;
 
-enum aga_result aga_resource_pack_lookup(
+enum aga_result aga_resource_pack_lookup_raw(
 		struct aga_resource_pack* pack, const char* path,
 		struct aga_resource** out) {
 
 	aga_size_t i;
+	aga_size_t mask;
 
 	if(!pack) return AGA_RESULT_BAD_PARAM;
 	if(!path) return AGA_RESULT_BAD_PARAM;
 	if(!out) return AGA_RESULT_BAD_PARAM;
 
-	for(i = 0; i < pack->len; ++i) {
-		if(aga_streql(pack->db[i].conf->name, path)) {
-			*out = &pack->db[i];
+	if(!pack->index) return AGA_RESULT_MISSING_KEY;
+
+	mask = pack->index_len - 1;
+
+	for(i = aga_strhash(path) & mask; pack->index[i]; i = (i + 1) & mask) {
+		if(aga_streql(pack->index[i]->path, path)) {
+			*out = pack->index[i];
 			return AGA_RESULT_OK;
 		}
 	}
 
-	aga_log(__FILE__, "err: Path `%s' not found in resource pack", path);
-
-	return AGA_RESULT_BAD_PARAM;
+	return AGA_RESULT_MISSING_KEY;
 }
 
-enum aga_result aga_resource_pack_new(
-		const char* path, struct aga_resource_pack* pack) {
-
-	enum aga_result result;
+enum aga_result aga_resource_pack_cell(
+		struct aga_resource_pack* pack, aga_sint_t x, aga_sint_t z,
+		struct aga_resource_pack_cell** out) {
 
-	aga_size_t i;
-	struct aga_resource_pack_header hdr;
-	aga_bool_t c = AGA_FALSE;
+	aga_size_t lo, hi;
 
-	union aga_file_attribute attr;
-
-	if(!path) return AGA_RESULT_BAD_PARAM;
 	if(!pack) return AGA_RESULT_BAD_PARAM;
+	if(!out) return AGA_RESULT_BAD_PARAM;
 
-	aga_global_pack = pack;
+	lo = 0;
+	hi = pack->cell_count;
 
-	pack->fp = 0;
-	pack->db = 0;
-	pack->len = 0;
+	while(lo < hi) {
+		aga_size_t mid = lo + (hi - lo) / 2;
+		struct aga_resource_pack_cell* cell = &pack->cells[mid];
 
-	aga_bzero(&pack->root, sizeof(struct aga_config_node));
+		if(cell->x == x && cell->z == z) {
+			*out = cell;
+			return AGA_RESULT_OK;
+		}
 
-#ifndef NDEBUG
-	pack->outstanding_refs = 0;
-#endif
+		if(cell->x < x || (cell->x == x && cell->z < z)) lo = mid + 1;
+		else hi = mid;
+	}
 
-	aga_log(__FILE__, "Loading resource pack `%s'...", path);
+	return AGA_RESULT_MISSING_KEY;
+}
 
-	if(!(pack->fp = fopen(path, "rb"))) {
-		return aga_error_system_path(__FILE__, "fopen", path);
+enum aga_result aga_resource_pack_lookup(
+		struct aga_resource_pack* pack, const char* path,
+		struct aga_resource** out) {
+
+	enum aga_result result = aga_resource_pack_lookup_raw(pack, path, out);
+	if(result == AGA_RESULT_MISSING_KEY) {
+		aga_log(__FILE__, "err: Path `%s' not found in resource pack", path);
 	}
 
-	result = aga_file_attribute(pack->fp, AGA_FILE_LENGTH, &attr);
-	if(result) goto cleanup;
-	pack->size = attr.length;
+	return result;
+}
 
-	result = aga_file_read(&hdr, sizeof(hdr), pack->fp);
-	if(result) goto cleanup;
+static enum aga_result aga_resource_pack_index(
+		struct aga_resource_pack* pack) {
 
-	if(hdr.magic != AGA_PACK_MAGIC) {
-		result = AGA_RESULT_BAD_PARAM;
-		goto cleanup;
+	aga_size_t i;
+	aga_size_t mask;
+
+	pack->index_len = 1;
+	while(pack->index_len < pack->len * 2) pack->index_len <<= 1;
+
+	pack->index = aga_calloc(pack->index_len, sizeof(struct aga_resource*));
+	if(!pack->index) return AGA_RESULT_OOM;
+
+	mask = pack->index_len - 1;
+
+	for(i = 0; i < pack->len; ++i) {
+		struct aga_resource* res = &pack->db[i];
+		aga_size_t j;
+
+		if(!res->path) {
+			aga_log(
+					__FILE__, "warn: Resource #%zu appears to be missing a "
+							  "path", i);
+			continue;
+		}
+
+		for(j = aga_strhash(res->path) & mask; pack->index[j]; ) {
+			j = (j + 1) & mask;
+		}
+
+		pack->index[j] = res;
 	}
 
-	aga_config_debug_file = path;
+	return AGA_RESULT_OK;
+}
 
-	result = aga_config_new(pack->fp, hdr.size, &pack->root);
-	if(result) goto cleanup;
+/* Legacy packs which only carry the SGML header. */
+static enum aga_result aga_resource_pack_load_config(
+		struct aga_resource_pack* pack, struct aga_resource_pack_header* hdr) {
+
+	enum aga_result result;
 
-	c = AGA_TRUE;
+	aga_size_t i;
+
+	result = aga_config_new(pack->fp, hdr->size, &pack->root);
+	if(result) return result;
 
 	pack->len = pack->root.children->len;
-	pack->data_offset = hdr.size + sizeof(hdr);
+	pack->data_offset = hdr->size + sizeof(*hdr);
 
 	pack->db = aga_calloc(pack->len, sizeof(struct aga_resource));
-	if(!pack->db) {
-		result = AGA_RESULT_OOM;
-		goto cleanup;
-	}
+	if(!pack->db) return AGA_RESULT_OOM;
 
 	for(i = 0; i < pack->len; ++i) {
 		static const char* off = "Offset";
 		static const char* sz = "Size";
+		static const char* enc = "Encoding";
+		static const char* raw = "RawSize";
 
 		struct aga_resource* res = &pack->db[i];
 		struct aga_config_node* node = &pack->root.children->children[i];
 
 		aga_slong_t offset;
 		aga_slong_t size;
+		const char* encoding;
 
 		res->conf = node;
+		res->path = node->name;
 		res->pack = pack;
 
 		result = aga_config_lookup(
@@ -137,8 +173,7 @@ enum aga_result aga_resource_pack_new(
 					__FILE__, "Resource #%zu appears to be beyond resource "
 							  "pack bounds (`%zu >= %zu')", i, res->offset,
 					pack->size);
-			result = AGA_RESULT_BAD_PARAM;
-			goto cleanup;
+			return AGA_RESULT_BAD_PARAM;
 		}
 
 		result = aga_config_lookup(
@@ -151,34 +186,295 @@ enum aga_result aga_resource_pack_new(
 			continue;
 		}
 		res->size = (aga_size_t) size;
+		res->stored_size = res->size;
 
 		if(res->offset + res->size >= pack->size) {
 			aga_log(
 					__FILE__, "Resource #%zu appears to be beyond resource "
 							  "pack bounds (`%zu + %zu >= %zu')", i,
 					res->offset, res->size, pack->size);
-			result = AGA_RESULT_BAD_PARAM;
-			goto cleanup;
+			return AGA_RESULT_BAD_PARAM;
+		}
+
+		result = aga_config_lookup(
+				node, &enc, 1, &encoding, AGA_STRING, AGA_FALSE);
+		if(!result) {
+			if(!aga_streql(encoding, "LZSS")) {
+				aga_log(
+						__FILE__, "err: Resource #%zu has unknown encoding "
+								  "`%s'", i, encoding);
+				return AGA_RESULT_BAD_PARAM;
+			}
+
+			result = aga_config_lookup(
+					node, &raw, 1, &size, AGA_INTEGER, AGA_TRUE);
+			if(result) return result;
+
+			res->encoding = AGA_ENCODING_LZSS;
+			res->size = (aga_size_t) size;
+		}
+	}
+
+	return AGA_RESULT_OK;
+}
+
+/*
+ * Reads the entry table and string pool in one go and skips over the SGML
+ * Tree entirely -- entry metadata is parsed on demand by `aga_resource_conf'.
+ */
+static enum aga_result aga_resource_pack_load_directory(
+		struct aga_resource_pack* pack, struct aga_resource_pack_header* hdr) {
+
+	enum aga_result result;
+
+	struct aga_resource_pack_directory dir;
+	struct aga_resource_pack_entry* entries;
+	const char* strings;
+	aga_size_t conf_base;
+	aga_size_t table;
+	aga_size_t cells;
+	aga_size_t i;
+
+	result = aga_file_read(&dir, sizeof(dir), pack->fp);
+	if(result) return result;
+
+	conf_base = sizeof(*hdr) + sizeof(dir);
+	table = dir.len * sizeof(struct aga_resource_pack_entry);
+	cells = dir.cells * sizeof(struct aga_resource_pack_cell);
+
+	if(conf_base + dir.conf_size + table + dir.strings + cells >
+		sizeof(*hdr) + hdr->size) {
+
+		aga_log(__FILE__, "err: Resource pack directory exceeds header size");
+		return AGA_RESULT_BAD_PARAM;
+	}
+
+	if(!dir.strings) {
+		aga_log(__FILE__, "err: Resource pack directory has no string pool");
+		return AGA_RESULT_BAD_PARAM;
+	}
+
+	if(fseek(pack->fp, (long) dir.conf_size, SEEK_CUR)) {
+		return aga_error_system(__FILE__, "fseek");
+	}
+
+	if(!(pack->directory = aga_malloc(table + dir.strings + cells))) {
+		return AGA_RESULT_OOM;
+	}
+
+	result = aga_file_read(
+			pack->directory, table + dir.strings + cells, pack->fp);
+	if(result) return result;
+
+	entries = pack->directory;
+	strings = (const char*) pack->directory + table;
+
+	/* The build pads the string pool so this stays aligned. */
+	pack->cells = (void*) ((char*) pack->directory + table + dir.strings);
+	pack->cell_count = dir.cells;
+
+	for(i = 0; i < pack->cell_count; ++i) {
+		struct aga_resource_pack_cell* cell = &pack->cells[i];
+
+		if(cell->first + cell->count > dir.len) {
+			aga_log(
+					__FILE__, "err: Cell #%zu has entries beyond the "
+							  "directory (`%u + %u > %u')", i, cell->first,
+					cell->count, dir.len);
+			return AGA_RESULT_BAD_PARAM;
 		}
 	}
 
+	if(strings[dir.strings - 1]) {
+		aga_log(__FILE__, "err: Resource pack string pool is unterminated");
+		return AGA_RESULT_BAD_PARAM;
+	}
+
+	pack->len = dir.len;
+	pack->data_offset = hdr->size + sizeof(*hdr);
+
+	pack->db = aga_calloc(pack->len, sizeof(struct aga_resource));
+	if(!pack->db) return AGA_RESULT_OOM;
+
+	for(i = 0; i < pack->len; ++i) {
+		struct aga_resource* res = &pack->db[i];
+		struct aga_resource_pack_entry* entry = &entries[i];
+
+		if(entry->name >= dir.strings) {
+			aga_log(
+					__FILE__, "Resource #%zu has a path beyond the string "
+							  "pool (`%u >= %u')", i, entry->name,
+					dir.strings);
+			return AGA_RESULT_BAD_PARAM;
+		}
+
+		/* Written so that corrupt offsets and sizes can't overflow. */
+		if(entry->conf > dir.conf_size ||
+			entry->conf_size > dir.conf_size - entry->conf) {
+
+			aga_log(
+					__FILE__, "Resource #%zu has metadata beyond the config "
+							  "tree (`%u + %u > %u')", i, entry->conf,
+					entry->conf_size, dir.conf_size);
+			return AGA_RESULT_BAD_PARAM;
+		}
+
+		res->pack = pack;
+		res->path = strings + entry->name;
+		res->offset = entry->offset;
+		res->size = entry->raw_size;
+		res->stored_size = entry->size;
+		res->hash = entry->hash;
+		res->conf_offset = conf_base + entry->conf;
+		res->conf_size = entry->conf_size;
+
+		if(entry->encoding > AGA_ENCODING_LZSS) {
+			aga_log(
+					__FILE__, "Resource #%zu has unknown encoding `%u'", i,
+					entry->encoding);
+			return AGA_RESULT_BAD_PARAM;
+		}
+		res->encoding = (enum aga_resource_encoding) entry->encoding;
+
+		if(pack->data_offset > pack->size ||
+			res->offset > pack->size - pack->data_offset ||
+			res->stored_size > pack->size - pack->data_offset - res->offset) {
+
+			aga_log(
+					__FILE__, "Resource #%zu appears to be beyond resource "
+							  "pack bounds (`%zu + %zu > %zu')", i,
+					res->offset, res->stored_size, pack->size);
+			return AGA_RESULT_BAD_PARAM;
+		}
+	}
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_resource_pack_new(
+		const char* path, struct aga_resource_pack* pack) {
+
+	enum aga_result result;
+
+	struct aga_resource_pack_header hdr;
+
+	union aga_file_attribute attr;
+
+	if(!path) return AGA_RESULT_BAD_PARAM;
+	if(!pack) return AGA_RESULT_BAD_PARAM;
+
+	aga_global_pack = pack;
+
+	pack->path = path;
+	pack->fp = 0;
+	pack->map = 0;
+	pack->read_fp = 0;
+	pack->db = 0;
+	pack->len = 0;
+	pack->index = 0;
+	pack->index_len = 0;
+	pack->directory = 0;
+	pack->cells = 0;
+	pack->cell_count = 0;
+	pack->budget = AGA_RESOURCE_CACHE_BUDGET;
+	pack->resident = 0;
+	pack->lru_head = 0;
+	pack->lru_tail = 0;
+
+	aga_bzero(&pack->root, sizeof(struct aga_config_node));
+
+#ifndef NDEBUG
+	pack->outstanding_refs = 0;
+#endif
+
+	aga_log(__FILE__, "Loading resource pack `%s'...", path);
+
+	if(!(pack->fp = fopen(path, "rb"))) {
+		return aga_error_system_path(__FILE__, "fopen", path);
+	}
+
+	result = aga_file_attribute(pack->fp, AGA_FILE_LENGTH, &attr);
+	if(result) goto cleanup;
+	pack->size = attr.length;
+
+	if(!(pack->read_fp = fopen(path, "rb"))) {
+		result = aga_error_system_path(__FILE__, "fopen", path);
+		goto cleanup;
+	}
+
+#ifdef AGA_HAVE_MAP
+	result = aga_file_map(pack->fp, pack->size, &pack->map);
+	if(result) {
+		aga_error_check_soft(__FILE__, "aga_file_map", result);
+		aga_log(__FILE__, "warn: Falling back to buffered resource reads");
+		pack->map = 0;
+	}
+#endif
+
+	result = aga_file_read(&hdr, sizeof(hdr), pack->fp);
+	if(result) goto cleanup;
+
+	aga_config_debug_file = path;
+
+	if(hdr.magic == AGA_PACK_DIRECTORY_MAGIC) {
+		result = aga_resource_pack_load_directory(pack, &hdr);
+		if(result) goto cleanup;
+	}
+	else if(hdr.magic == AGA_PACK_MAGIC) {
+		aga_log(
+				__FILE__, "warn: `%s' is a legacy resource pack -- rebuild it "
+						  "for faster loading", path);
+
+		result = aga_resource_pack_load_config(pack, &hdr);
+		if(result) goto cleanup;
+	}
+	else {
+		aga_log(
+				__FILE__, "err: `%s' is not a resource pack or is from an "
+						  "incompatible version (magic `0x%X')", path,
+				hdr.magic);
+		result = AGA_RESULT_BAD_PARAM;
+		goto cleanup;
+	}
+
+	result = aga_resource_pack_index(pack);
+	if(result) goto cleanup;
+
 	aga_log(__FILE__, "Loaded `%zu' resource entries", pack->len);
 
 	return AGA_RESULT_OK;
 
 	cleanup: {
+#ifdef AGA_HAVE_MAP
+		if(pack->map) {
+			aga_error_check_soft(
+					__FILE__, "aga_file_unmap",
+					aga_file_unmap(pack->map, pack->size));
+		}
+		pack->map = 0;
+#endif
+
+		aga_free(pack->index);
+		pack->index = 0;
 		aga_free(pack->db);
+		pack->db = 0;
+		aga_free(pack->directory);
+		pack->directory = 0;
+		pack->cells = 0;
+		pack->cell_count = 0;
 
 		if(pack->fp && fclose(pack->fp) == EOF) {
 			(void) aga_error_system(__FILE__, "fclose");
 		}
 		pack->fp = 0;
 
-		if(c) {
-			aga_error_check_soft(
-					__FILE__, "aga_config_delete",
-					aga_config_delete(&pack->root));
+		if(pack->read_fp && fclose(pack->read_fp) == EOF) {
+			(void) aga_error_system(__FILE__, "fclose");
 		}
+		pack->read_fp = 0;
+
+		aga_error_check_soft(
+				__FILE__, "aga_config_delete", aga_config_delete(&pack->root));
 
 		return result;
 	}
@@ -187,8 +483,11 @@ enum aga_result aga_resource_pack_new(
 enum aga_result aga_resource_pack_delete(struct aga_resource_pack* pack) {
 	enum aga_result result;
 
+	aga_size_t i;
+
 	if(!pack) return AGA_RESULT_BAD_PARAM;
 
+	pack->budget = 0;
 	if((result = aga_resource_pack_sweep(pack))) return result;
 
 #ifndef NDEBUG
@@ -199,28 +498,79 @@ enum aga_result aga_resource_pack_delete(struct aga_resource_pack* pack) {
 	}
 #endif
 
+#ifdef AGA_HAVE_MAP
+	if(pack->map) {
+		if((result = aga_file_unmap(pack->map, pack->size))) return result;
+		pack->map = 0;
+	}
+#endif
+
+	for(i = 0; i < pack->len; ++i) {
+		result = aga_config_delete(&pack->db[i].conf_root);
+		if(result) return result;
+	}
+
+	aga_free(pack->index);
 	aga_free(pack->db);
+	aga_free(pack->directory);
+	pack->cells = 0;
+	pack->cell_count = 0;
 	if(pack->fp && fclose(pack->fp) == EOF) {
 		return aga_error_system(__FILE__, "fclose");
 	}
+	if(pack->read_fp && fclose(pack->read_fp) == EOF) {
+		return aga_error_system(__FILE__, "fclose");
+	}
 
 	return aga_config_delete(&pack->root);
 }
 
-enum aga_result aga_resource_pack_sweep(struct aga_resource_pack* pack) {
-	aga_size_t i;
+/* Whether `data' is an allocation of ours rather than a view of the map. */
+static aga_bool_t aga_resource_owned(struct aga_resource* res) {
+	return !res->pack->map || res->encoding != AGA_ENCODING_NONE;
+}
+
+static void aga_resource_lru_unlink(struct aga_resource* res) {
+	struct aga_resource_pack* pack = res->pack;
+
+	if(res->lru_prev) res->lru_prev->lru_next = res->lru_next;
+	else if(pack->lru_head == res) pack->lru_head = res->lru_next;
+	else return; /* Not linked. */
+
+	if(res->lru_next) res->lru_next->lru_prev = res->lru_prev;
+	else pack->lru_tail = res->lru_prev;
+
+	res->lru_prev = 0;
+	res->lru_next = 0;
+}
+
+static void aga_resource_lru_push(struct aga_resource* res) {
+	struct aga_resource_pack* pack = res->pack;
+
+	res->lru_prev = 0;
+	res->lru_next = pack->lru_head;
+
+	if(pack->lru_head) pack->lru_head->lru_prev = res;
+	else pack->lru_tail = res;
+
+	pack->lru_head = res;
+}
 
+enum aga_result aga_resource_pack_sweep(struct aga_resource_pack* pack) {
 	if(!pack) return AGA_RESULT_BAD_PARAM;
 
-	for(i = 0; i < pack->len; ++i) {
-		struct aga_resource* res = &pack->db[i];
+	/* Mapped data is paged in and out for us by the OS so never gets here. */
+	while(pack->resident > pack->budget && pack->lru_tail) {
+		struct aga_resource* res = pack->lru_tail;
 
-		if(res->refcount || !res->data) continue;
+		aga_resource_lru_unlink(res);
 
 #ifndef NDEBUG
 		pack->outstanding_refs--;
 #endif
 
+		pack->resident -= res->size;
+
 		aga_free(res->data);
 		res->data = 0;
 	}
@@ -245,23 +595,16 @@ enum aga_result aga_resource_new(
 	}
 
 	if(!(*res)->data) {
-		result = aga_resource_seek(*res, 0);
-		if(result) return result;
-
-#ifndef NDEBUG
-		pack->outstanding_refs++;
-#endif
+		void* data;
 
-		/* TODO: Use mapping for large reads. */
-		if(!((*res)->data = aga_malloc((*res)->size))) return AGA_RESULT_OOM;
+		result = aga_resource_load(*res, &data);
+		if(result) return result;
 
-		result = aga_file_read((*res)->data, (*res)->size, pack->fp);
+		result = aga_resource_adopt(*res, data);
 		if(result) return result;
 	}
 
-	++(*res)->refcount;
-
-	return AGA_RESULT_OK;
+	return aga_resource_aquire(*res);
 }
 
 enum aga_result aga_resource_stream(
@@ -292,6 +635,13 @@ enum aga_result aga_resource_seek(struct aga_resource* res, void** fp) {
 
 	if(!res) return AGA_RESULT_BAD_PARAM;
 
+	if(res->encoding != AGA_ENCODING_NONE) {
+		aga_log(
+				__FILE__, "err: Resource `%s' is encoded and cannot be "
+						  "streamed", res->path);
+		return AGA_RESULT_BAD_OP;
+	}
+
 	offset = res->pack->data_offset + res->offset;
 
 	result = fseek(res->pack->fp, (long) offset, SEEK_SET);
@@ -302,10 +652,319 @@ enum aga_result aga_resource_seek(struct aga_resource* res, void** fp) {
 	return AGA_RESULT_OK;
 }
 
+/* Reads the resource's bytes as they are stored in the pack. */
+static enum aga_result aga_resource_read_stored(
+		struct aga_resource* res, aga_size_t offset, void* data,
+		aga_size_t size) {
+
+	struct aga_resource_pack* pack = res->pack;
+
+	if(offset > res->stored_size || size > res->stored_size - offset) {
+		return AGA_RESULT_EOF;
+	}
+
+	if(!size) return AGA_RESULT_OK;
+
+	offset += pack->data_offset + res->offset;
+
+	if(pack->map) {
+		aga_memcpy(data, (aga_uchar_t*) pack->map + offset, size);
+		return AGA_RESULT_OK;
+	}
+
+	return aga_file_read_offset(pack->read_fp, offset, data, size);
+}
+
+enum aga_result aga_resource_read(
+		struct aga_resource* res, aga_size_t offset, void* data,
+		aga_size_t size) {
+
+	if(!res) return AGA_RESULT_BAD_PARAM;
+	if(!data && size) return AGA_RESULT_BAD_PARAM;
+
+	if(res->encoding != AGA_ENCODING_NONE) return AGA_RESULT_BAD_OP;
+
+	return aga_resource_read_stored(res, offset, data, size);
+}
+
+/*
+ * Decodes as we go so we never hold the whole encoded entry in memory, unless
+ * It's already sat in the mapping.
+ */
+static enum aga_result aga_resource_decode(
+		struct aga_resource* res, void* data) {
+
+	enum aga_result result;
+
+	struct aga_resource_pack* pack = res->pack;
+	struct aga_decompressor lz;
+	aga_size_t off;
+	void* chunk;
+
+	result = aga_decompressor_new(&lz, data, res->size);
+	if(result) return result;
+
+	if(pack->map) {
+		off = pack->data_offset + res->offset;
+
+		result = aga_decompressor_feed(
+				&lz, (aga_uchar_t*) pack->map + off, res->stored_size);
+		if(result) return result;
+
+		return aga_decompressor_end(&lz);
+	}
+
+	if(!(chunk = aga_malloc(AGA_RESOURCE_DECODE_CHUNK))) return AGA_RESULT_OOM;
+
+	for(off = 0; off < res->stored_size; off += AGA_RESOURCE_DECODE_CHUNK) {
+		aga_size_t n = res->stored_size - off;
+
+		if(n > AGA_RESOURCE_DECODE_CHUNK) n = AGA_RESOURCE_DECODE_CHUNK;
+
+		result = aga_resource_read_stored(res, off, chunk, n);
+		if(result) goto cleanup;
+
+		result = aga_decompressor_feed(&lz, chunk, n);
+		if(result) goto cleanup;
+	}
+
+	result = aga_decompressor_end(&lz);
+
+	cleanup: {
+		aga_free(chunk);
+
+		return result;
+	}
+}
+
+enum aga_result aga_resource_load(struct aga_resource* res, void** out) {
+	enum aga_result result;
+
+	struct aga_resource_pack* pack;
+	void* data;
+
+	if(!res) return AGA_RESULT_BAD_PARAM;
+	if(!out) return AGA_RESULT_BAD_PARAM;
+
+	pack = res->pack;
+
+	if(res->encoding != AGA_ENCODING_NONE) {
+		if(!(data = aga_malloc(res->size))) return AGA_RESULT_OOM;
+
+		if((result = aga_resource_decode(res, data))) {
+			aga_log(__FILE__, "err: Failed to decode `%s'", res->path);
+			aga_free(data);
+			return result;
+		}
+
+		*out = data;
+
+		return AGA_RESULT_OK;
+	}
+
+	if(pack->map) {
+		*out = (aga_uchar_t*) pack->map + pack->data_offset + res->offset;
+		return AGA_RESULT_OK;
+	}
+
+	if(!(data = aga_malloc(res->size))) return AGA_RESULT_OOM;
+
+	if((result = aga_resource_read(res, 0, data, res->size))) {
+		aga_free(data);
+		return result;
+	}
+
+	*out = data;
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_resource_adopt(struct aga_resource* res, void* data) {
+	struct aga_resource_pack* pack;
+
+	if(!res) return AGA_RESULT_BAD_PARAM;
+	if(!data) return AGA_RESULT_BAD_PARAM;
+
+	pack = res->pack;
+
+	if(res->data) {
+		aga_resource_discard(res, data);
+		return AGA_RESULT_OK;
+	}
+
+	res->data = data;
+
+	if(aga_resource_owned(res)) {
+		pack->resident += res->size;
+
+#ifndef NDEBUG
+		pack->outstanding_refs++;
+#endif
+	}
+
+	return AGA_RESULT_OK;
+}
+
+void aga_resource_discard(struct aga_resource* res, void* data) {
+	if(!res) return;
+
+	if(aga_resource_owned(res)) aga_free(data);
+}
+
+enum aga_result aga_resource_conf(
+		struct aga_resource* res, struct aga_config_node** out) {
+
+	enum aga_result result;
+
+	if(!res) return AGA_RESULT_BAD_PARAM;
+	if(!out) return AGA_RESULT_BAD_PARAM;
+
+	if(!res->conf) {
+		if(!res->conf_size) return AGA_RESULT_MISSING_KEY;
+
+		if(fseek(res->pack->fp, (long) res->conf_offset, SEEK_SET)) {
+			return aga_error_system(__FILE__, "fseek");
+		}
+
+		aga_config_debug_file = res->path;
+
+		result = aga_config_new(res->pack->fp, res->conf_size, &res->conf_root);
+		if(result) return result;
+
+		if(!res->conf_root.len) {
+			aga_log(__FILE__, "err: Resource `%s' has no metadata", res->path);
+			return AGA_RESULT_BAD_PARAM;
+		}
+
+		res->conf = res->conf_root.children;
+	}
+
+	*out = res->conf;
+
+	return AGA_RESULT_OK;
+}
+
+/* Gives the member its own copy unless it can view the scene in the map. */
+static enum aga_result aga_resource_scene_data(
+		struct aga_resource* scene, struct aga_resource* res,
+		const aga_uchar_t* data) {
+
+	enum aga_result result;
+	void* copy;
+
+	if(!aga_resource_owned(res)) {
+		if(aga_resource_owned(scene)) {
+			if((result = aga_resource_load(res, &copy))) return result;
+		}
+		else copy = (void*) data;
+	}
+	else {
+		if(!(copy = aga_malloc(res->size))) return AGA_RESULT_OOM;
+		aga_memcpy(copy, data, res->size);
+	}
+
+	if((result = aga_resource_adopt(res, copy))) return result;
+
+	/* Nobody holds it yet -- leave it to the cache like any other release. */
+	if((result = aga_resource_aquire(res))) return result;
+
+	return aga_resource_release(res);
+}
+
+enum aga_result aga_resource_scene(struct aga_resource* scene) {
+	enum aga_result result;
+
+	const aga_uchar_t* base;
+	const struct aga_scene_header* hdr;
+	const struct aga_scene_entry* entries;
+	const char* strings;
+	aga_size_t table;
+	aga_size_t i;
+
+	if(!scene) return AGA_RESULT_BAD_PARAM;
+	if(!scene->data) return AGA_RESULT_BAD_OP;
+
+	base = scene->data;
+	hdr = scene->data;
+
+	if(scene->size < sizeof(*hdr) || hdr->magic != AGA_SCENE_MAGIC) {
+		aga_log(__FILE__, "err: `%s' is not a scene", scene->path);
+		return AGA_RESULT_BAD_PARAM;
+	}
+
+	table = hdr->len * sizeof(struct aga_scene_entry);
+
+	if(hdr->len > scene->size / sizeof(struct aga_scene_entry) ||
+		hdr->strings > scene->size ||
+		hdr->objects > hdr->len || !hdr->strings ||
+		sizeof(*hdr) + table + hdr->strings > scene->size) {
+
+		aga_log(__FILE__, "err: Scene `%s' has a bad table", scene->path);
+		return AGA_RESULT_BAD_PARAM;
+	}
+
+	entries = (const void*) (base + sizeof(*hdr));
+	strings = (const char*) base + sizeof(*hdr) + table;
+
+	if(strings[hdr->strings - 1]) {
+		aga_log(
+				__FILE__, "err: Scene `%s' string pool is unterminated",
+				scene->path);
+		return AGA_RESULT_BAD_PARAM;
+	}
+
+	for(i = 0; i < hdr->len; ++i) {
+		const struct aga_scene_entry* entry = &entries[i];
+		struct aga_resource* res;
+
+		/* Written so that corrupt offsets and sizes can't overflow. */
+		if(entry->name >= hdr->strings ||
+			entry->offset > scene->size ||
+			entry->size > scene->size - entry->offset ||
+			entry->conf > scene->size ||
+			entry->conf_size > scene->size - entry->conf) {
+
+			aga_log(
+					__FILE__, "err: Scene `%s' member #%zu is out of bounds",
+					scene->path, i);
+			return AGA_RESULT_BAD_PARAM;
+		}
+
+		result = aga_resource_pack_lookup(
+				scene->pack, strings + entry->name, &res);
+		if(result) return result;
+
+		if(entry->hash != res->hash || entry->size != res->size) {
+			aga_log(
+					__FILE__, "warn: Scene `%s' has a stale copy of `%s'",
+					scene->path, res->path);
+			continue;
+		}
+
+		if(!res->conf && entry->conf_size) {
+			aga_config_debug_file = res->path;
+
+			result = aga_config_new_buffer(
+					base + entry->conf, entry->conf_size, &res->conf_root);
+			if(result) return result;
+
+			if(res->conf_root.len) res->conf = res->conf_root.children;
+		}
+
+		if(!res->data) {
+			result = aga_resource_scene_data(
+					scene, res, base + entry->offset);
+			if(result) return result;
+		}
+	}
+
+	return AGA_RESULT_OK;
+}
+
 enum aga_result aga_resource_aquire(struct aga_resource* res) {
 	if(!res) return AGA_RESULT_BAD_PARAM;
 
-	++res->refcount;
+	if(!res->refcount++) aga_resource_lru_unlink(res);
 
 	return AGA_RESULT_OK;
 }
@@ -313,7 +972,11 @@ enum aga_result aga_resource_aquire(struct aga_resource* res) {
 enum aga_result aga_resource_release(struct aga_resource* res) {
 	if(!res) return AGA_RESULT_BAD_PARAM;
 
-	if(res->refcount) --res->refcount;
+	if(!res->refcount) return AGA_RESULT_OK;
+
+	if(!--res->refcount && res->data && aga_resource_owned(res)) {
+		aga_resource_lru_push(res);
+	}
 
 	return AGA_RESULT_OK;
 }
@@ -23,22 +23,41 @@ void py_fatal(const char* msg) {
 }
 
 void* py_open_r(const char* path) {
+	enum aga_result result;
 	void* fp;
-	aga_size_t i;
-
-	for(i = 0; i < aga_global_pack->len; ++i) {
-		struct aga_resource* res = &aga_global_pack->db[i];
-		if(aga_streql(path, res->conf->name)) {
-			enum aga_result result;
+	struct aga_resource* res;
+
+	/*
+	 * NOTE: Misses are expected here as Python searches its whole path for
+	 * 		 Modules - we just fall through to the filesystem.
+	 */
+	result = aga_resource_pack_lookup_raw(aga_global_pack, path, &res);
+	if(!result) {
+		/*
+		 * NOTE: Python wants a stream it can keep reading from while other
+		 * 		 Modules are being imported, so each open gets its own handle
+		 * 		 Rather than borrowing the pack's shared stream position.
+		 */
+		const char* pack_path = aga_global_pack->path;
+		aga_size_t offset = aga_global_pack->data_offset + res->offset;
+
+		if(res->encoding != AGA_ENCODING_NONE) {
+			aga_log(__FILE__, "err: Module `%s' is encoded in the pack", path);
+			return 0;
+		}
 
-			result = aga_resource_seek(res, &fp);
-			if(result) {
-				aga_error_check_soft(__FILE__, "aga_resource_seek", result);
-				return 0;
-			}
+		if(!(fp = fopen(pack_path, "rb"))) {
+			(void) aga_error_system_path(__FILE__, "fopen", pack_path);
+			return 0;
+		}
 
-			return fp;
+		if(fseek(fp, (long) offset, SEEK_SET)) {
+			(void) aga_error_system(__FILE__, "fseek");
+			if(fclose(fp) == EOF) (void) aga_error_system(__FILE__, "fclose");
+			return 0;
 		}
+
+		return fp;
 	}
 
 	if(!(fp = fopen(path, "rb"))) aga_error_system_path(__FILE__, "fopen", path);
@@ -47,7 +66,6 @@ void* py_open_r(const char* path) {
 
 void py_close(void* fp) {
 	if(!fp) return;
-	if(fp == aga_global_pack->fp) return;
 
 	if(fclose(fp) == EOF) aga_error_system(__FILE__, "fclose");
 }
@@ -134,7 +134,7 @@ enum aga_result aga_sound_device_update(struct aga_sound_device* dev) {
 
 		for(i = 0; i < dev->count; ++i) {
 			struct aga_sound_stream* stream = &dev->streams[i];
-			void* fp;
+			aga_size_t size;
 			aga_size_t rdsz;
 			aga_bool_t eof = AGA_FALSE;
 
@@ -145,20 +145,14 @@ enum aga_result aga_sound_device_update(struct aga_sound_device* dev) {
 			 */
 			if(stream->done) continue;
 
-			result = aga_resource_seek(stream->resource, &fp);
-			if(result) return result;
-
-			if(fseek(fp, (long) stream->offset, SEEK_CUR)) {
-				return aga_error_system(__FILE__, "fseek");
-			}
+			size = stream->resource->size;
+			rdsz = stream->offset < size ? size - stream->offset : 0;
+			if(rdsz < req) eof = AGA_TRUE;
+			else rdsz = req;
 
-			rdsz = fread(dev->scratch, 1, req, fp);
-			if(rdsz < req) {
-				if(ferror(fp)) {
-					return aga_error_system(__FILE__, "fread");
-				}
-				else eof = AGA_TRUE;
-			}
+			result = aga_resource_read(
+					stream->resource, stream->offset, dev->scratch, rdsz);
+			if(result) return result;
 			stream->last_seek = rdsz;
 			stream->offset += rdsz;
 
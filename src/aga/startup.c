@@ -6,6 +6,7 @@
 #include <aga/startup.h>
 #include <aga/log.h>
 #include <aga/pack.h>
+#include <aga/zone.h>
 #include <aga/error.h>
 #include <aga/utility.h>
 #include <aga/io.h>
@@ -29,6 +30,9 @@ enum aga_result aga_settings_new(
 #ifdef AGA_DEVBUILD
 	opts->compile = AGA_FALSE;
 	opts->build_file = "agabuild.sgml";
+	opts->jobs = 1;
+	opts->bench_file = 0;
+	opts->bench_runs = 100;
 #endif
 	opts->config_file = "aga.sgml";
 	opts->display = aga_getenv("DISPLAY");
@@ -41,6 +45,9 @@ enum aga_result aga_settings_new(
 	opts->height = 480;
 	opts->title = "Aft Gang Aglay";
 	opts->mipmap_default = AGA_FALSE;
+	opts->cache_budget = AGA_RESOURCE_CACHE_BUDGET;
+	opts->zone_cell_size = AGA_ZONE_CELL_SIZE;
+	opts->zone_radius = AGA_ZONE_RADIUS;
 	opts->fov = 90.0f;
 	opts->audio_enabled = AGA_TRUE;
 	opts->version = AGA_VERSION;
@@ -61,41 +68,65 @@ enum aga_result aga_settings_new(
 			"warn: usage:\n"
 			"\t%s [-f respack] [-A dsp] [-D display] [-C dir] [-v] [-h]"
 #ifdef AGA_DEVBUILD
-			"\n\t%s -c [-f buildfile] [-C dir] [-v] [-h]"
+			"\n\t%s -c [-f buildfile] [-j jobs] [-C dir] [-v] [-h]"
+			"\n\t%s -b sgml [-n runs] [-C dir] [-v] [-h]"
 #endif
 		;
 
 		int o;
-		while((o = getopt(argc, argv, "hcf:s:A:D:C:v")) != -1) {
-			switch(o) {
-				default:
+		aga_bool_t help = AGA_FALSE;
+		const char* file = 0;
 #ifdef AGA_DEVBUILD
-					;help:
+		aga_bool_t jobs_set = AGA_FALSE;
+		aga_bool_t runs_set = AGA_FALSE;
+		aga_bool_t runtime_set = AGA_FALSE;
 #endif
-				{
-					aga_log(__FILE__, helpmsg, argv[0], argv[0]);
-					goto break2;
+
+		while(!help && (o = getopt(argc, argv, "hcf:s:A:D:C:vj:b:n:")) != -1) {
+			switch(o) {
+				default: {
+					help = AGA_TRUE;
+					break;
 				}
 #ifdef AGA_DEVBUILD
 				case 'c': {
-					if(optind != 2) goto help;
-
 					opts->compile = AGA_TRUE;
 					break;
 				}
+				case 'j': {
+					long jobs;
+
+					if((jobs = strtol(optarg, 0, 10)) < 1) help = AGA_TRUE;
+					else {
+						opts->jobs = (aga_size_t) jobs;
+						jobs_set = AGA_TRUE;
+					}
+
+					break;
+				}
+				case 'b': {
+					opts->bench_file = optarg;
+					break;
+				}
+				case 'n': {
+					long runs;
+
+					if((runs = strtol(optarg, 0, 10)) < 1) help = AGA_TRUE;
+					else {
+						opts->bench_runs = (aga_size_t) runs;
+						runs_set = AGA_TRUE;
+					}
+
+					break;
+				}
 #endif
 				case 'f': {
-#ifdef AGA_DEVBUILD
-					if(opts->compile) opts->build_file = optarg;
-					else
-#endif
-					opts->respack = optarg;
-
+					file = optarg;
 					break;
 				}
 				case 'A': {
 #ifdef AGA_DEVBUILD
-					if(opts->compile) goto help;
+					runtime_set = AGA_TRUE;
 #endif
 
 					/* TODO: Fix audio buffer options. */
@@ -104,7 +135,7 @@ enum aga_result aga_settings_new(
 				}
 				case 'D': {
 #ifdef AGA_DEVBUILD
-					if(opts->compile) goto help;
+					runtime_set = AGA_TRUE;
 #endif
 
 					opts->display = optarg;
@@ -122,7 +153,29 @@ enum aga_result aga_settings_new(
 				}
 			}
 		}
-		break2:;
+
+		/* Options which depend on the mode are only checked once it's known. */
+#ifdef AGA_DEVBUILD
+		if(opts->bench_file) {
+			if(opts->compile || jobs_set || runtime_set || file) {
+				help = AGA_TRUE;
+			}
+		}
+		else if(runs_set) help = AGA_TRUE;
+
+		if(opts->compile) {
+			if(runtime_set) help = AGA_TRUE;
+			if(file) opts->build_file = file;
+		}
+		else {
+			if(jobs_set) help = AGA_TRUE;
+			if(file) opts->respack = file;
+		}
+#else
+		if(file) opts->respack = file;
+#endif
+
+		if(help) aga_log(__FILE__, helpmsg, argv[0], argv[0], argv[0]);
 	}
 
 # ifdef AGA_HAVE_UNISTD
@@ -156,6 +209,9 @@ enum aga_result aga_settings_parse_config(
 	static const char* height[] = { "Display", "Height" };
 	static const char* mipmap[] = { "Graphics", "MipmapDefault" };
 	static const char* fov[] = { "Display", "FOV" };
+	static const char* budget[] = { "Resource", "CacheBudget" };
+	static const char* cell_size[] = { "Zone", "CellSize" };
+	static const char* radius[] = { "Zone", "Radius" };
 
 	if(!opts) return AGA_RESULT_BAD_PARAM;
 	if(!pack) return AGA_RESULT_BAD_PARAM;
@@ -227,6 +283,26 @@ enum aga_result aga_settings_parse_config(
 	aga_error_check_soft(__FILE__, "aga_config_lookup", result);
 	if(!result) opts->fov = (float) fv;
 
+	result = aga_config_lookup(
+			opts->config.children, budget, AGA_LEN(budget), &v,
+			AGA_INTEGER, AGA_TRUE);
+	aga_error_check_soft(__FILE__, "aga_config_lookup", result);
+	if(!result && v >= 0) opts->cache_budget = (aga_size_t) v;
+
+	result = aga_config_lookup(
+			opts->config.children, cell_size, AGA_LEN(cell_size), &fv,
+			AGA_FLOAT, AGA_TRUE);
+	aga_error_check_soft(__FILE__, "aga_config_lookup", result);
+	if(!result && fv > 0.0) opts->zone_cell_size = (float) fv;
+
+	result = aga_config_lookup(
+			opts->config.children, radius, AGA_LEN(radius), &v,
+			AGA_INTEGER, AGA_TRUE);
+	aga_error_check_soft(__FILE__, "aga_config_lookup", result);
+	if(!result && v >= 0) opts->zone_radius = (aga_size_t) v;
+
+	pack->budget = opts->cache_budget;
+
 	return AGA_RESULT_OK;
 }
 
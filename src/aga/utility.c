@@ -31,6 +31,18 @@ aga_size_t aga_strlen(const char* s) {
 	return strlen(s);
 }
 
+/* FNV-1a. */
+aga_size_t aga_strhash(const char* s) {
+	aga_size_t hash = 2166136261UL;
+
+	for(; *s; ++s) {
+		hash ^= (aga_uchar_t) *s;
+		hash *= 16777619UL;
+	}
+
+	return hash;
+}
+
 aga_slong_t aga_strtol(const char* s) {
 	aga_size_t i;
 	aga_size_t len = aga_strlen(s);
@@ -0,0 +1,238 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ * Copyright (C) 2024 Emily "TTG" Banerjee <prs.ttg+aga@pm.me>
+ */
+
+#include <aga/zone.h>
+#include <aga/pack.h>
+#include <aga/loader.h>
+#include <aga/log.h>
+#include <aga/error.h>
+#include <aga/utility.h>
+
+#define AGA_WANT_MATH
+#include <aga/std.h>
+
+static aga_sint_t aga_zone_coordinate(struct aga_zone* zone, float v) {
+	return (aga_sint_t) floor(v / zone->cell_size);
+}
+
+static aga_bool_t aga_zone_in_range(
+		struct aga_zone* zone, aga_sint_t x, aga_sint_t z) {
+
+	aga_slong_t dx = (aga_slong_t) x - zone->x;
+	aga_slong_t dz = (aga_slong_t) z - zone->z;
+
+	if(dx < 0) dx = -dx;
+	if(dz < 0) dz = -dz;
+
+	return (aga_size_t) dx <= zone->radius && (aga_size_t) dz <= zone->radius;
+}
+
+/* Keeps the load if the cell is still wanted and we don't already hold it. */
+static void aga_zone_loaded(
+		struct aga_resource* res, enum aga_result result, void* pass) {
+
+	struct aga_zone_cell* cell = pass;
+	struct aga_zone* zone = cell->zone;
+	aga_size_t i = (aga_size_t) (res - zone->pack->db);
+
+	--zone->pending;
+
+	if(result) {
+		aga_error_check_soft(__FILE__, "aga_resource_request", result);
+		return;
+	}
+
+	if(cell->wanted && !zone->held[i]) {
+		zone->held[i] = AGA_TRUE;
+		return;
+	}
+
+	aga_error_check_soft(
+			__FILE__, "aga_resource_release", aga_resource_release(res));
+}
+
+static enum aga_result aga_zone_load(
+		struct aga_zone* zone, struct aga_zone_cell* cell) {
+
+	enum aga_result result;
+
+	aga_size_t i;
+	aga_size_t end = cell->cell->first + cell->cell->count;
+
+	cell->wanted = AGA_TRUE;
+
+	for(i = cell->cell->first; i < end; ++i) {
+		if(zone->held[i]) continue;
+
+		++zone->pending;
+
+		result = aga_resource_request(
+				zone->loader, zone->pack->db[i].path, aga_zone_loaded, cell);
+		if(result) {
+			--zone->pending;
+			return result;
+		}
+	}
+
+	return AGA_RESULT_OK;
+}
+
+/* Loads still in flight for the cell are dropped as they come in. */
+static enum aga_result aga_zone_unload(
+		struct aga_zone* zone, struct aga_zone_cell* cell) {
+
+	enum aga_result result;
+
+	aga_size_t i;
+	aga_size_t end = cell->cell->first + cell->cell->count;
+
+	cell->wanted = AGA_FALSE;
+
+	for(i = cell->cell->first; i < end; ++i) {
+		if(!zone->held[i]) continue;
+
+		zone->held[i] = AGA_FALSE;
+
+		result = aga_resource_release(&zone->pack->db[i]);
+		if(result) return result;
+	}
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_zone_new(
+		struct aga_zone* zone, struct aga_resource_pack* pack,
+		struct aga_resource_loader* loader, float cell_size,
+		aga_size_t radius) {
+
+	aga_size_t i;
+
+	if(!zone) return AGA_RESULT_BAD_PARAM;
+	if(!pack) return AGA_RESULT_BAD_PARAM;
+	if(!loader) return AGA_RESULT_BAD_PARAM;
+	if(!(cell_size > 0.0f)) return AGA_RESULT_BAD_PARAM;
+
+	zone->pack = pack;
+	zone->loader = loader;
+	zone->cell_size = cell_size;
+	zone->radius = radius;
+	zone->placed = AGA_FALSE;
+	zone->x = 0;
+	zone->z = 0;
+	zone->cells = 0;
+	zone->held = 0;
+	zone->pending = 0;
+
+	if(!pack->cell_count) return AGA_RESULT_OK;
+
+	zone->cells = aga_calloc(pack->cell_count, sizeof(struct aga_zone_cell));
+	if(!zone->cells) return AGA_RESULT_OOM;
+
+	if(!(zone->held = aga_calloc(pack->len, sizeof(aga_bool_t)))) {
+		aga_free(zone->cells);
+		zone->cells = 0;
+
+		return AGA_RESULT_OOM;
+	}
+
+	for(i = 0; i < pack->cell_count; ++i) {
+		zone->cells[i].zone = zone;
+		zone->cells[i].cell = &pack->cells[i];
+	}
+
+	aga_log(
+			__FILE__, "Streaming `%zu' cells within `%zu' of the camera",
+			pack->cell_count, radius);
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_zone_delete(struct aga_zone* zone) {
+	enum aga_result result;
+
+	aga_size_t i;
+
+	if(!zone) return AGA_RESULT_BAD_PARAM;
+
+	/* Callbacks still hold pointers to our cells. */
+	if(zone->pending) {
+		for(i = 0; i < zone->pack->cell_count; ++i) {
+			zone->cells[i].wanted = AGA_FALSE;
+		}
+
+		if((result = aga_resource_loader_wait(zone->loader))) return result;
+	}
+
+	for(i = 0; i < zone->pack->cell_count; ++i) {
+		result = aga_zone_unload(zone, &zone->cells[i]);
+		if(result) return result;
+	}
+
+	aga_free(zone->cells);
+	aga_free(zone->held);
+
+	zone->cells = 0;
+	zone->held = 0;
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_zone_update(struct aga_zone* zone, float x, float z) {
+	enum aga_result result;
+
+	aga_size_t i;
+	aga_sint_t cx, cz;
+
+	if(!zone) return AGA_RESULT_BAD_PARAM;
+
+	cx = aga_zone_coordinate(zone, x);
+	cz = aga_zone_coordinate(zone, z);
+
+	if(zone->placed && cx == zone->x && cz == zone->z) return AGA_RESULT_OK;
+
+	zone->placed = AGA_TRUE;
+	zone->x = cx;
+	zone->z = cz;
+
+	/* Unload first so the budget has room before anything new comes in. */
+	for(i = 0; i < zone->pack->cell_count; ++i) {
+		struct aga_zone_cell* cell = &zone->cells[i];
+
+		if(!cell->wanted) continue;
+		if(aga_zone_in_range(zone, cell->cell->x, cell->cell->z)) continue;
+
+		if((result = aga_zone_unload(zone, cell))) return result;
+	}
+
+	for(i = 0; i < zone->pack->cell_count; ++i) {
+		struct aga_zone_cell* cell = &zone->cells[i];
+
+		if(cell->wanted) continue;
+		if(!aga_zone_in_range(zone, cell->cell->x, cell->cell->z)) continue;
+
+		if((result = aga_zone_load(zone, cell))) return result;
+	}
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result aga_zone_cell(
+		struct aga_zone* zone, float x, float z,
+		struct aga_resource_pack_cell** out) {
+
+	if(!zone) return AGA_RESULT_BAD_PARAM;
+	if(!out) return AGA_RESULT_BAD_PARAM;
+
+	return aga_resource_pack_cell(
+			zone->pack, aga_zone_coordinate(zone, x),
+			aga_zone_coordinate(zone, z), out);
+}
+
+aga_bool_t aga_zone_resident(struct aga_zone* zone, float x, float z) {
+	if(!zone || !zone->placed || !zone->pack->cell_count) return AGA_TRUE;
+
+	return aga_zone_in_range(
+			zone, aga_zone_coordinate(zone, x), aga_zone_coordinate(zone, z));
+}
@@ -88,9 +88,14 @@ enum aga_result aga_mkmod(struct py_env* env, void** dict) {
 			/* Miscellaneous */
 			aga_(getconf), aga_(log), aga_(die), aga_(dt),
 
+			/* Resources */
+			aga_(prefetch), aga_(fetched), aga_(unfetch), aga_(getcell),
+
 			/* Objects */
 			aga_(mkobj), aga_(inobj), aga_(putobj), aga_(killobj),
-			aga_(objind), aga_(objtrans), aga_(objconf),
+			aga_(objind), aga_(objtrans), aga_(objconf), aga_(mkbatch),
+			aga_(putbatch), aga_(killbatch), aga_(putvis), aga_(loadscene),
+			aga_(dropconf), aga_(mkprop), aga_(getprop), aga_(killprop),
 
 			/* Maths */
 			aga_(bitand), aga_(bitshl), aga_(randnorm), aga_(bitor),
@@ -197,11 +202,9 @@ struct py_object* agan_scriptconf(
 
 	enum aga_result result;
 
-	const char* str;
 	struct aga_config_node* out;
 	const char** names;
 	unsigned i, len = py_varobject_size(list);
-	struct py_object* retval;
 
 	if(!(names = malloc(len * sizeof(char*)))) return py_error_set_nomem();
 
@@ -222,14 +225,20 @@ struct py_object* agan_scriptconf(
 	free(names);
 	if(result) return py_object_incref(PY_NONE);
 
-	str = out->data.string ? out->data.string : "";
-	switch(out->type) {
+	return agan_scriptvalue(out);
+}
+
+struct py_object* agan_scriptvalue(struct aga_config_node* node) {
+	const char* str = node->data.string ? node->data.string : "";
+	struct py_object* retval;
+
+	switch(node->type) {
 		default:; AGA_FALLTHROUGH;
 		/* FALLTHROUGH */
 		case AGA_NONE: retval = py_object_incref(PY_NONE); break;
 		case AGA_STRING: retval = py_string_new(str); break;
-		case AGA_INTEGER: retval = py_int_new(out->data.integer); break;
-		case AGA_FLOAT: retval = py_float_new(out->data.flt); break;
+		case AGA_INTEGER: retval = py_int_new(node->data.integer); break;
+		case AGA_FLOAT: retval = py_float_new(node->data.flt); break;
 	}
 
 	if(!retval) py_error_set_nomem();
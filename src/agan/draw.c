@@ -13,6 +13,7 @@
 #include <aga/log.h>
 #include <aga/diagnostic.h>
 #include <aga/render.h>
+#include <aga/zone.h>
 
 #include <apro.h>
 
@@ -40,6 +41,33 @@ enum aga_result agan_draw_register(struct py_env* env) {
 	return AGA_RESULT_OK;
 }
 
+/*
+ * Recentres the zone on the eye. The view is `S * R * T' so the eye sits at
+ * `-(S * R)^-1 * t' -- with uniform scale the inverse is just the transpose
+ * Over the squared scale.
+ */
+static aga_bool_t agan_setcam_zone(struct aga_zone* zone) {
+	double mv[16];
+	double eye[3];
+	double s;
+	aga_size_t i;
+
+	glGetDoublev(GL_MODELVIEW_MATRIX, mv);
+	if(aga_script_gl_err("glGetDoublev")) return AGA_TRUE;
+
+	s = mv[0] * mv[0] + mv[1] * mv[1] + mv[2] * mv[2];
+	if(s == 0.0) return AGA_FALSE;
+
+	for(i = 0; i < 3; ++i) {
+		eye[i] = -(mv[4 * i] * mv[12] + mv[4 * i + 1] * mv[13] +
+				mv[4 * i + 2] * mv[14]) / s;
+	}
+
+	return aga_script_err(
+			"aga_zone_update",
+			aga_zone_update(zone, (float) eye[0], (float) eye[2]));
+}
+
 struct py_object* agan_setcam(
 		struct py_env* env, struct py_object* self, struct py_object* args) {
 
@@ -49,6 +77,7 @@ struct py_object* agan_setcam(
 	double ar;
 
 	struct aga_settings* opts = AGA_GET_USERDATA(env)->opts;
+	struct aga_zone* zone = AGA_GET_USERDATA(env)->zone;
 
 	(void) env;
 	(void) self;
@@ -87,6 +116,9 @@ struct py_object* agan_setcam(
 	if(aga_script_gl_err("glLoadIdentity")) return 0;
 	if(agan_settransmat(t, AGA_TRUE)) return 0;
 
+	/* Only a perspective camera is somewhere in the world. */
+	if(b && zone && agan_setcam_zone(zone)) return 0;
+
 	apro_stamp_end(APRO_SCRIPTGLUE_SETCAM);
 
 	return py_object_incref(PY_NONE);
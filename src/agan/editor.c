@@ -5,9 +5,12 @@
 
 #include <agan/editor.h>
 #include <agan/object.h>
+#include <agan/utility.h>
 
 #include <aga/script.h>
 #include <aga/pack.h>
+#include <aga/loader.h>
+#include <aga/zone.h>
 #include <aga/startup.h>
 #include <aga/config.h>
 #include <aga/error.h>
@@ -43,6 +46,14 @@
  * 		 An error or guaranteed safe return.
  */
 #ifdef AGA_DEVBUILD
+/*
+ * NOTE: `killpack' unhooks the loader and zone from userdata so nothing uses
+ * 		 Them while there's no pack -- their storage is kept here for `mkpack'
+ * 		 To rebuild into.
+ */
+static struct aga_resource_loader* agan_ed_loader = 0;
+static struct aga_zone* agan_ed_zone = 0;
+
 /*
  * TODO: Tear down and reload script land (or just user scripts) once we
  * 		 Consolidate Python state more to allow it.
@@ -54,13 +65,43 @@ static struct py_object* agan_killpack(
 		struct py_env* env, struct py_object* self, struct py_object* args) {
 
 	enum aga_result result;
-	struct aga_resource_pack* pack = AGA_GET_USERDATA(env)->resource_pack;
+	struct aga_script_userdata* userdata = AGA_GET_USERDATA(env);
+	struct aga_resource_pack* pack = userdata->resource_pack;
+	struct aga_resource_loader* loader = userdata->resource_loader;
+	struct aga_zone* zone = userdata->zone;
 
 	(void) env;
 	(void) self;
 
 	if(args) return aga_arg_error("killpack", "none");
 
+	/* Objects' conf would otherwise outlive the pack it was read from. */
+	result = agan_dropobjconfs();
+	if(aga_script_err("agan_dropobjconfs", result)) return 0;
+
+	if(zone) {
+		userdata->zone = 0;
+		agan_ed_zone = zone;
+
+		result = aga_zone_delete(zone);
+		if(aga_script_err("aga_zone_delete", result)) return 0;
+	}
+
+	/* The loader's requests and file handle are tied to the old pack. */
+	if(loader) {
+		result = aga_resource_loader_wait(loader);
+		if(aga_script_err("aga_resource_loader_wait", result)) return 0;
+
+		userdata->resource_loader = 0;
+		agan_ed_loader = loader;
+
+		result = aga_resource_loader_delete(loader);
+		if(aga_script_err("aga_resource_loader_delete", result)) return 0;
+	}
+
+	/* Any requests have been called back by now. */
+	agan_dropfetches();
+
 	/*
 	 * TODO: These should have extra safeties on them. Do they even need to
 	 * 		 Be separate or can we just have a "reload" function?
@@ -75,8 +116,9 @@ static struct py_object* agan_mkpack(
 		struct py_env* env, struct py_object* self, struct py_object* args) {
 
 	enum aga_result result;
-	struct aga_resource_pack* pack = AGA_GET_USERDATA(env)->resource_pack;
-	struct aga_settings* opts = AGA_GET_USERDATA(env)->opts;
+	struct aga_script_userdata* userdata = AGA_GET_USERDATA(env);
+	struct aga_resource_pack* pack = userdata->resource_pack;
+	struct aga_settings* opts = userdata->opts;
 
 	(void) env;
 	(void) self;
@@ -86,6 +128,27 @@ static struct py_object* agan_mkpack(
 	result = aga_resource_pack_new(opts->respack, pack);
 	if(aga_script_err("aga_resource_pack_new", result)) return 0;
 
+	pack->budget = opts->cache_budget;
+
+	if(agan_ed_loader) {
+		result = aga_resource_loader_new(agan_ed_loader, pack);
+		if(aga_script_err("aga_resource_loader_new", result)) return 0;
+
+		userdata->resource_loader = agan_ed_loader;
+		agan_ed_loader = 0;
+	}
+
+	/* Zones are only made where there's a loader to stream cells through. */
+	if(agan_ed_zone && userdata->resource_loader) {
+		result = aga_zone_new(
+				agan_ed_zone, pack, userdata->resource_loader,
+				opts->zone_cell_size, opts->zone_radius);
+		if(aga_script_err("aga_zone_new", result)) return 0;
+
+		userdata->zone = agan_ed_zone;
+		agan_ed_zone = 0;
+	}
+
 	return py_object_incref(PY_NONE);
 }
 
@@ -98,7 +161,7 @@ static struct py_object* agan_dumpobj(
 	struct py_object* pathp;
 
 	struct agan_object* obj;
-	struct aga_config_node node;
+	struct aga_config_node* node;
 	const char* path;
 
 	(void) env;
@@ -143,7 +206,7 @@ static struct py_object* agan_dumpobj(
 				elem[1] = agan_xyz[j];
 
 				result = aga_config_lookup_check(
-						node.children, elem, AGA_LEN(elem), &n);
+						node->children, elem, AGA_LEN(elem), &n);
 				if(aga_script_err("aga_config_lookup_check", result)) return 0;
 
 				if((o = py_list_get(l, j))->type != PY_TYPE_FLOAT) {
@@ -162,7 +225,7 @@ static struct py_object* agan_dumpobj(
 
 		struct aga_config_node* n;
 
-		result = aga_config_lookup_check(node.children, &model, 1, &n);
+		result = aga_config_lookup_check(node->children, &model, 1, &n);
 		if(aga_script_err("aga_config_lookup_check", result)) return 0;
 
 		aga_free(n->data.string);
@@ -177,7 +240,7 @@ static struct py_object* agan_dumpobj(
 		}
 
 		/* TODO: Leaky stream. */
-		result = aga_config_dump(node.children, f);
+		result = aga_config_dump(node->children, f);
 		if(aga_script_err("aga_config_dump", result)) return 0;
 
 		if(fclose(f) == EOF) {
@@ -186,10 +249,6 @@ static struct py_object* agan_dumpobj(
 		}
 	}
 
-	/* TODO: Leaky conf.. */
-	result = aga_config_delete(&node);
-	if(aga_script_err("aga_config_delete", result)) return 0;
-
 	return py_object_incref(PY_NONE);
 }
 
@@ -225,7 +284,7 @@ static struct py_object* agan_setobjmdl(
 
 	enum aga_result result;
 
-	struct aga_config_node root;
+	struct aga_config_node* root;
 	struct aga_config_node* node;
 
 	struct py_object* objp;
@@ -252,7 +311,7 @@ static struct py_object* agan_setobjmdl(
 	if(aga_script_err("agan_getobjconf", result)) return 0;
 
 	/* TODO: We really need to work out this whole root/non-root fiasco. */
-	result = aga_config_lookup_check(root.children, &model, 1, &node);
+	result = aga_config_lookup_check(root->children, &model, 1, &node);
 	if(aga_script_err("aga_config_lookup_check", result)) return 0;
 
 	/*
@@ -262,7 +321,7 @@ static struct py_object* agan_setobjmdl(
 	aga_free(node->data.string);
 	node->data.string = aga_strdup(path);
 
-	/* TODO: Soft reload object model here. Delete old drawlist etc. */
+	/* TODO: Soft reload object model here. Release old shared model etc. */
 
 	return py_object_incref(PY_NONE);
 }
@@ -13,9 +13,12 @@
 #include <aga/draw.h>
 #include <aga/script.h>
 #include <aga/pack.h>
+#include <aga/zone.h>
 #include <aga/io.h>
 #include <aga/error.h>
 #include <aga/diagnostic.h>
+#define AGA_WANT_MATH
+#include <aga/std.h>
 
 #include <apro.h>
 
@@ -80,13 +83,13 @@ static aga_bool_t agan_mkobj_trans(
 }
 
 static void agan_mkobj_extent(
-		struct agan_object* obj, struct aga_config_node* conf) {
+		struct agan_shared* model, struct aga_config_node* conf) {
 
 	static const char* min_attr[] = { "MinX", "MinY", "MinZ" };
 	static const char* max_attr[] = { "MaxX", "MaxY", "MaxZ" };
 
-	float (*min)[3] = &obj->min_extent;
-	float (*max)[3] = &obj->max_extent;
+	float (*min)[3] = &model->min_extent;
+	float (*max)[3] = &model->max_extent;
 
 	aga_size_t i;
 
@@ -105,469 +108,2079 @@ static void agan_mkobj_extent(
 	}
 }
 
-/*
- * TODO: Object models should be able to specify a billboard texture for auto
- * 		 LOD -- especially when we have our zoning/distance culling system.
- */
-static aga_bool_t agan_mkobj_model(
-		struct py_env* env, struct agan_object* obj,
-		struct aga_config_node* conf, struct aga_resource_pack* pack,
-		const char* objpath) {
+/* Expands version 4 quantised vertices back out to floats. */
+static struct aga_model_vertex* agan_mkobj_dequantise(
+		struct agan_shared* model, struct aga_config_node* resconf,
+		const struct aga_packed_vertex* packed, aga_size_t len) {
 
-	static const char* model = "Model";
-	static const char* texture = "Texture";
-	static const char* filter = "Filter";
-	static const char* mipmap = "Mipmap";
+	static const char* uv_attr[] = { "MinU", "MinV", "MaxU", "MaxV" };
 
-	struct aga_settings* settings = AGA_GET_USERDATA(env)->opts;
+	struct aga_model_vertex* verts;
+	float uv[4];
+	float scale[5];
+	aga_size_t i, j;
 
-	enum aga_result result;
+	for(i = 0; i < AGA_LEN(uv_attr); ++i) {
+		double v;
 
-	struct aga_resource* res;
-	unsigned mode = GL_COMPILE;
-	const char* path;
+		if(aga_config_lookup(
+				resconf, &uv_attr[i], 1, &v, AGA_FLOAT, AGA_FALSE)) {
 
-	/* TODO: Delete lists in error conditions. */
-	obj->drawlist = glGenLists(1);
-	if(aga_script_gl_err("glGenLists")) return 0;
+			uv[i] = 0.0f;
+		}
+		else uv[i] = (float) v;
+	}
 
-#ifndef NDEBUG
-	mode = GL_COMPILE_AND_EXECUTE;
-#endif
+	for(i = 0; i < 3; ++i) {
+		scale[i] = (model->max_extent[i] - model->min_extent[i]) / 65535.0f;
+	}
 
-	/*
-	 * TODO: We could batch chunks of static scene geometry together into one
-	 * 		 Large list during scene build once we have a more cohesive system
-	 * 		 In-place.
-	 */
-	/*
-	 * TODO: Advice appears to be to keep a list per-model rather than
-	 * 		 Per-object and to retexture/material as necessary for instances.
-	 * 		 We can probably balance this between instanced and non-instanced
-	 * 		 Draw.
-	 */
-	glNewList(obj->drawlist, mode);
-	if(aga_script_gl_err("glNewList")) return 0;
+	scale[3] = (uv[2] - uv[0]) / 65535.0f;
+	scale[4] = (uv[3] - uv[1]) / 65535.0f;
 
-	{
-		aga_bool_t do_mips, tex_filter;
-		aga_slong_t v;
+	if(!(verts = aga_malloc((len + 1) * sizeof(struct aga_model_vertex)))) {
+		return 0;
+	}
 
-		result = aga_config_lookup(
-				conf->children, &filter, 1, &v, AGA_INTEGER, AGA_FALSE);
-		if(result) v = 1;
-		tex_filter = !!v;
+	for(i = 0; i < len; ++i) {
+		const struct aga_packed_vertex* p = &packed[i];
+		struct aga_model_vertex* v = &verts[i];
 
-		result = aga_config_lookup(
-				conf->children, &mipmap, 1, &v, AGA_INTEGER, AGA_FALSE);
-		if(result) v = settings->mipmap_default;
-		do_mips = !!v;
+		for(j = 0; j < 3; ++j) {
+			v->pos[j] = model->min_extent[j] + (float) p->pos[j] * scale[j];
+			v->norm[j] = (float) p->norm[j] / 127.0f;
+		}
 
-		result = aga_config_lookup(
-				conf->children, &texture, 1, &path, AGA_STRING, AGA_FALSE);
-		if(result) {
-			/* TODO: Does this handle this case gracefully. */
-			aga_log(
-					__FILE__, "warn: Object `%s' is missing a texture entry",
-					objpath);
+		for(j = 0; j < 2; ++j) {
+			v->uv[j] = uv[j] + (float) p->uv[j] * scale[3 + j];
 		}
-		else {
-			static const char* width = "Width";
+	}
 
-			aga_slong_t w, h;
+	return verts;
+}
 
-			/*
-			 * TODO: "Just trusting" that this make/release pattern is safe to
-			 * 		 Avoid leaks is unclear and unfriendly to non-maintainers.
-			 * 		 We probably need better lifetime/cleanup etiquette and
-			 * 		 Helper code.
-			 */
+/* Copies out of resident data (i.e. from a scene) before going to the pack. */
+static enum aga_result agan_resource_read(
+		struct aga_resource* res, void* data, aga_size_t size) {
 
-			/*
-			 * TODO: Handle missing textures etc. gracefully - default/
-			 *       Procedural resources?
-			 */
-			result = aga_resource_new(pack, path, &res);
-			if(aga_script_err("aga_resource_new", result)) return AGA_TRUE;
+	if(res->data) {
+		if(size > res->size) return AGA_RESULT_EOF;
 
-			result = aga_resource_release(res);
-			if(aga_script_err("aga_resource_release", result)) return AGA_TRUE;
+		aga_memcpy(data, res->data, size);
+		return AGA_RESULT_OK;
+	}
 
-			result = aga_config_lookup(
-					res->conf, &width, 1, &w, AGA_INTEGER, AGA_FALSE);
-			if(result) {
-				/* TODO: Default conf values as part of the API. */
-				aga_log(__FILE__, "warn: Texture `%s' is missing dimensions");
-				w = 0;
-				h = 0;
-			}
-			else h = (int) (res->size / (aga_size_t) (4 * w));
-
-			/*
-			 * TODO: Non-alpha textures for more effective use of GPU memory
-			 * 		 And turning off transparency auto-disables alpha channel.
-			 * 		 `glPolygonStipple' can be used for fake transparency.
-			 */
-			if(do_mips) {
-				gluBuild2DMipmaps(
-						GL_TEXTURE_2D, 4, (int) w, (int) h, GL_RGBA,
-						GL_UNSIGNED_BYTE, res->data);
-				/*
-				 * TODO: Script land can probably handle lots of GL errors like
-				 * 		 This relatively gracefully (i.e. allow the user code
-				 * 		 To go further without needing try-catch hell).
-				 * 		 Especially in functions like this which aren't
-				 * 		 Supposed to be run every frame.
-				 */
-				if(aga_script_gl_err("gluBuild2DMipmaps")) return AGA_TRUE;
-			}
-			else {
-				glTexImage2D(
-						GL_TEXTURE_2D, 0, 4, (int) w, (int) h, 0, GL_RGBA,
-						GL_UNSIGNED_BYTE, res->data);
+	return aga_resource_read(res, 0, data, size);
+}
 
-				if(aga_script_gl_err("glTexImage2D")) return AGA_TRUE;
-			}
+/* A version 3 and up model read into memory. */
+struct agan_model_data {
+	aga_uchar_t* data;
 
-			{
-				int mag = tex_filter ? GL_LINEAR : GL_NEAREST;
-				int min;
+	struct aga_model_vertex* verts;
+	aga_uchar_t* inds;
 
-				if(do_mips) {
-					min = tex_filter ?
-							GL_LINEAR_MIPMAP_LINEAR :
-							GL_NEAREST_MIPMAP_NEAREST;
-				}
-				else min = mag;
+	aga_size_t nverts;
+	aga_size_t ninds;
+	aga_size_t isize;
+};
 
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min);
-				if(aga_script_gl_err("glTexParameteri")) return AGA_TRUE;
+static void agan_model_free(struct agan_model_data* out) {
+	if((void*) out->verts != (void*) out->data) aga_free(out->verts);
+	aga_free(out->data);
+}
 
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag);
-				if(aga_script_gl_err("glTexParameteri")) return AGA_TRUE;
-			}
-		}
+static aga_uint_t agan_model_index(
+		const struct agan_model_data* in, aga_size_t i) {
 
-		result = aga_config_lookup(
-				conf->children, &model, 1, &path, AGA_STRING, AGA_FALSE);
-		if(result) {
-			aga_log(
-					__FILE__, "warn: Object `%s' is missing a model entry",
-					objpath);
-		}
-		else {
-			static const char* version = "Version";
+	if(in->isize == 2) return ((aga_ushort_t*) in->inds)[i];
+	else return ((aga_uint_t*) in->inds)[i];
+}
 
-			struct aga_vertex vert;
-			void* fp;
-			aga_size_t i, len;
-			aga_slong_t ver;
+/*
+ * Version 3 and up models are a welded vertex buffer followed by an index
+ * Buffer and then one for each LOD level -- read them in at once, keep the
+ * Indices for `lod' and check they're sane.
+ */
+static aga_bool_t agan_model_read(
+		struct agan_shared* model, struct aga_resource* res,
+		struct aga_config_node* resconf, aga_slong_t ver, aga_uint_t lod,
+		struct agan_model_data* out) {
 
-			aga_free(obj->modelpath);
-			if(!(obj->modelpath = aga_strdup(path))) {
-				py_error_set_nomem();
-				return 0;
-			}
+	static const char* vertices = "Vertices";
+	static const char* indices = "Indices";
+	static const char* index_size = "IndexSize";
+	static const char* lods = "Lods";
+	static const char* lod_indices[] = { "Lod1Indices", "Lod2Indices" };
 
-			result = aga_resource_pack_lookup(pack, path, &res);
-			if(aga_script_err("aga_resource_pack_lookup", result)) {
-				aga_log(__FILE__, "err: Failed to find resource `%s'", path);
-				return AGA_TRUE;
-			}
+	enum aga_result result;
 
-			agan_mkobj_extent(obj, res->conf);
+	aga_slong_t nverts, ninds, isize, nlods;
+	aga_slong_t counts[AGA_MODEL_LODS + 1];
+	aga_size_t i, size, stride, total = 0, offset = 0;
 
-			result = aga_config_lookup(
-					res->conf, &version, 1, &ver, AGA_INTEGER, AGA_FALSE);
-			if(result) ver = 1;
-
-			result = aga_resource_seek(res, &fp);
-			/* TODO: We can't return during list build! */
-			if(aga_script_err("aga_resource_stream", result)) return AGA_TRUE;
-			len = res->size;
-
-			glBegin(GL_TRIANGLES);
-			/* if(aga_script_gl_err("glBegin")) return 0; */
-
-			for(i = 0; i < len; i += sizeof(vert)) {
-				result = aga_file_read(&vert, sizeof(vert), pack->fp);
-				if(aga_script_err("aga_file_read", result)) return AGA_TRUE;
-
-				/*
-				 * Models from v2.1.0 and below respected model vertex
-				 * Colouration.
-				 */
-				if(ver == 2) {
-					aga_uchar_t r = (obj->ind >> (2 * 8)) & 0xFF;
-					aga_uchar_t g = (obj->ind >> (1 * 8)) & 0xFF;
-					aga_uchar_t b = (obj->ind >> (0 * 8)) & 0xFF;
-					glColor3ub(r, g, b);
-				}
-				else {
-					AGA_DEPRECATED_IMPL(
-							"Loading Version 1 model data is deprecated");
-					glColor4fv(vert.col);
-				}
+	result = aga_config_lookup(
+			resconf, &vertices, 1, &nverts, AGA_INTEGER, AGA_FALSE);
+	if(result) nverts = 0;
 
-				glTexCoord2fv(vert.uv);
-				/* if(aga_script_gl_err("glTexCoord2fv")) return AGA_TRUE; */
-				glNormal3fv(vert.norm);
-				/* if(aga_script_gl_err("glNormal3fv")) return AGA_TRUE; */
-				glVertex3fv(vert.pos);
-				/* if(aga_script_gl_err("glVertex3fv")) return AGA_TRUE; */
-			}
+	result = aga_config_lookup(
+			resconf, &indices, 1, &ninds, AGA_INTEGER, AGA_FALSE);
+	if(result) ninds = 0;
 
-			glEnd();
-			if(aga_script_gl_err("glEnd")) return 0;
-		}
-	}
+	result = aga_config_lookup(
+			resconf, &index_size, 1, &isize, AGA_INTEGER, AGA_FALSE);
+	if(result) isize = 0;
 
-	glEndList();
-	if(aga_script_gl_err("glEndList")) return 0;
+	result = aga_config_lookup(
+			resconf, &lods, 1, &nlods, AGA_INTEGER, AGA_FALSE);
+	if(result || nlods < 0) nlods = 0;
+	if(nlods > AGA_MODEL_LODS) nlods = AGA_MODEL_LODS;
 
-	return AGA_FALSE;
-}
+	counts[0] = ninds;
+	for(i = 0; i < AGA_MODEL_LODS; ++i) {
+		result = aga_config_lookup(
+				resconf, &lod_indices[i], 1, &counts[i + 1], AGA_INTEGER,
+				AGA_FALSE);
+		if(result || (aga_slong_t) i >= nlods) counts[i + 1] = 0;
+	}
 
-static aga_bool_t agan_mkobj_light(
-		struct agan_object* obj, struct aga_config_node* conf) {
+	for(i = 0; i <= (aga_size_t) nlods; ++i) {
+		if(i < lod) offset += (aga_size_t) counts[i];
+		total += (aga_size_t) counts[i];
+	}
 
-	static const char* light = "Light";
+	if(ver >= 4) stride = sizeof(struct aga_packed_vertex);
+	else stride = sizeof(struct aga_model_vertex);
 
-	enum aga_result result;
+	size = (aga_size_t) nverts * stride;
+	size += total * (aga_size_t) isize;
 
-	struct aga_config_node* node = conf->children;
-	struct agan_lightdata* data;
+	if((isize != 2 && isize != 4) || size != res->size ||
+		lod > (aga_uint_t) nlods) {
 
-	aga_slong_t scr;
-	aga_size_t i, j;
+		aga_log(__FILE__, "err: Malformed model `%s'", model->path);
+		aga_script_err("agan_model_read", AGA_RESULT_BAD_PARAM);
+		return AGA_TRUE;
+	}
 
-	double v;
+	out->nverts = (aga_size_t) nverts;
+	out->ninds = (aga_size_t) counts[lod];
+	out->isize = (aga_size_t) isize;
 
-	if(aga_config_lookup_raw(node, &light, 1, &node)) return AGA_FALSE;
+	if(!(out->data = aga_malloc(size + 1))) {
+		py_error_set_nomem();
+		return AGA_TRUE;
+	}
 
-	if(!(obj->light_data = calloc(1, sizeof(struct agan_lightdata)))) {
+	result = agan_resource_read(res, out->data, size);
+	if(aga_script_err("aga_resource_read", result)) {
+		aga_free(out->data);
 		return AGA_TRUE;
 	}
-	data = obj->light_data;
 
-	for(i = 0; i < node->len; ++i) {
-		aga_slong_t index;
-		struct aga_config_node* child = &node->children[i];
+	out->inds = out->data + out->nverts * stride;
 
-		if(aga_config_variable("Index", child, AGA_INTEGER, &index)) {
-			if(index > 7 || index < 0) {
-				aga_log(
-						__FILE__, "warn: Light index `%u' out of range 0-7",
-						data->index);
-				free(data);
-				obj->light_data = 0;
-				return AGA_TRUE;
-			}
+	if(ver >= 4) {
+		const struct aga_packed_vertex* packed = (void*) out->data;
 
-			data->index = (aga_uchar_t) index;
-		}
-		else if(aga_config_variable("Directional", child, AGA_INTEGER, &scr)) {
-			data->directional = !!scr;
-		}
-		else if(aga_config_variable("Exponent", child, AGA_FLOAT, &v)) {
-			data->exponent = (float) v;
-		}
-		else if(aga_config_variable("Angle", child, AGA_FLOAT, &v)) {
-			data->angle = (float) v;
+		out->verts = agan_mkobj_dequantise(
+				model, resconf, packed, out->nverts);
+		if(!out->verts) {
+			aga_free(out->data);
+			py_error_set_nomem();
+			return AGA_TRUE;
 		}
-		else if(aga_streql("Direction", child->name)) {
-			for(j = 0; j < 3; ++j) {
-				const char* comp = agan_xyz[j];
-				float (*dir)[3] = &data->direction;
 
-				result = aga_config_lookup(
-						child, &comp, 1, &v, AGA_FLOAT, AGA_FALSE);
-				(*dir)[j] = result ? 0.0f : (float) v;
-			}
-		}
-		/* TODO: General API for getting multiple components from conf node. */
-		else if(aga_streql("Ambient", child->name)) {
-			float (*col)[4] = &data->ambient;
+		/*
+		 * Packed vertices don't keep the indices aligned -- they can have
+		 * The whole buffer now the vertices have moved out.
+		 */
+		memmove(out->data, out->inds, total * out->isize);
+		out->inds = out->data;
+	}
+	else out->verts = (struct aga_model_vertex*) out->data;
 
-			for(j = 0; j < 3; ++j) {
-				const char* comp = agan_rgb[j];
+	out->inds += offset * out->isize;
 
-				result = aga_config_lookup(
-						child, &comp, 1, &v, AGA_FLOAT, AGA_FALSE);
-				if(result) (*col)[j] = 1.0f;
-				else (*col)[j] = (float) v;
-			}
+	for(i = 0; i < out->ninds; ++i) {
+		if(agan_model_index(out, i) >= out->nverts) {
+			aga_log(__FILE__, "err: Malformed model `%s'", model->path);
+			aga_script_err("agan_model_read", AGA_RESULT_BAD_PARAM);
 
-			(*col)[3] = 1.0f;
+			agan_model_free(out);
+
+			return AGA_TRUE;
 		}
-		else if(aga_streql("Diffuse", child->name)) {
-			float (*col)[4] = &data->diffuse;
+	}
 
-			for(j = 0; j < 3; ++j) {
-				const char* comp = agan_rgb[j];
+	return AGA_FALSE;
+}
 
-				result = aga_config_lookup(
-						child, &comp, 1, &v, AGA_FLOAT, AGA_FALSE);
-				(*col)[j] = result ? 1.0f : (float) v;
-			}
+/* Draws a version 3 and up model into the list being built. */
+static aga_bool_t agan_mkobj_indexed(
+		struct agan_shared* model, struct aga_resource* res,
+		struct aga_config_node* resconf, aga_slong_t ver, aga_uint_t lod) {
 
-			(*col)[3] = 1.0f;
-		}
-		else if(aga_streql("Specular", child->name)) {
-			float (*col)[4] = &data->specular;
+	struct agan_model_data in;
+	aga_size_t i;
 
-			for(j = 0; j < 3; ++j) {
-				const char* comp = agan_rgb[j];
+	if(agan_model_read(model, res, resconf, ver, lod, &in)) return AGA_TRUE;
 
-				result = aga_config_lookup(
-						child, &comp, 1, &v, AGA_FLOAT, AGA_FALSE);
-				(*col)[j] = result ? 1.0f : (float) v;
-			}
+	if(aga_draw_have_gl11()) {
+		GLenum type = in.isize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 
-			(*col)[3] = 1.0f;
-		}
-		else if(aga_streql("Attenuation", child->name)) {
-			static const char* attenuation[] = {
-					"Constant", "Linear", "Quadratic"
-			};
+		/* `aga_model_vertex' is laid out to match. */
+		glInterleavedArrays(GL_T2F_N3F_V3F, 0, in.verts);
+		glDrawElements(GL_TRIANGLES, (GLsizei) in.ninds, type, in.inds);
 
-			float* at[AGA_LEN(attenuation)];
-			at[0] = &data->constant_attenuation;
-			at[1] = &data->linear_attenuation;
-			at[2] = &data->quadratic_attenuation;
-			for(j = 0; j < AGA_LEN(at); ++j) {
-				const char* comp = attenuation[j];
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_NORMAL_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
 
-				result = aga_config_lookup(
-						child, &comp, 1, &v, AGA_FLOAT, AGA_FALSE);
-				*at[j] = result ? 0.0f : (float) v;
-			}
+		if(aga_script_gl_err("glDrawElements")) goto cleanup;
+	}
+	else {
+		glBegin(GL_TRIANGLES);
+
+		for(i = 0; i < in.ninds; ++i) {
+			const struct aga_model_vertex* v;
+
+			v = &in.verts[agan_model_index(&in, i)];
+
+			glTexCoord2fv(v->uv);
+			glNormal3fv(v->norm);
+			glVertex3fv(v->pos);
 		}
+
+		glEnd();
+
+		if(aga_script_gl_err("glEnd")) goto cleanup;
 	}
 
-	/*aga_log(
-			__FILE__,
-			"\nambient: [ %f, %f, %f, %f ]\n"
-			"diffuse: [ %f, %f, %f, %f ]\n"
-			"specular: [ %f, %f, %f, %f ]\n"
-			"attenuation: {\n"
-			"\tconstant: %f\n"
-			"\tlinear: %f\n"
-			"\tquadratic: %f\n"
-			"}\n"
-			"direction: [ %f, %f, %f ]\n"
-			"exponent: %f\n"
-			"angle: %f\n"
-			"directional: %s\n"
-			"index: %u",
-			data->ambient[0], data->ambient[1], data->ambient[2],
-				data->ambient[3],
-			data->diffuse[0], data->diffuse[1], data->diffuse[2],
-				data->diffuse[3],
-			data->specular[0], data->specular[1], data->specular[2],
-				data->specular[3],
-			data->constant_attenuation, data->linear_attenuation,
-				data->quadratic_attenuation,
-			data->direction[0], data->direction[1], data->direction[2],
-			data->exponent, data->angle, data->directional ? "true" : "false",
-			(unsigned) data->index);
-	 */
+	agan_model_free(&in);
 
 	return AGA_FALSE;
+
+	cleanup: {
+		agan_model_free(&in);
+
+		return AGA_TRUE;
+	}
 }
 
-struct py_object* agan_mkobj(
-		struct py_env* env, struct py_object* self, struct py_object* args) {
+/* Version 1 and 2 models are unindexed triangle soup. */
+static aga_bool_t agan_mkobj_soup(struct aga_resource* res, aga_slong_t ver) {
 
 	enum aga_result result;
 
-	struct agan_object* obj;
-	struct py_int* v;
-	struct py_object* retval;
-	struct aga_config_node conf;
-	aga_bool_t c = AGA_FALSE;
-	aga_bool_t m = AGA_FALSE;
+	struct aga_vertex* verts;
+	aga_size_t i, len = res->size / sizeof(struct aga_vertex);
 
-	const char* path;
-	struct aga_resource_pack* pack = AGA_GET_USERDATA(env)->resource_pack;
+	if(!(verts = aga_malloc(res->size + 1))) {
+		py_error_set_nomem();
+		return AGA_TRUE;
+	}
+
+	result = agan_resource_read(res, verts, len * sizeof(struct aga_vertex));
+	if(aga_script_err("aga_resource_read", result)) {
+		aga_free(verts);
+		return AGA_TRUE;
+	}
 
 	/*
-	 * TODO: This is horrible (but only exists until we have an object registry
-	 * 		 To get small unique handle IDs for colour picking.
+	 * Models from v2.1.0 and below respected model vertex
+	 * Colouration -- newer ones take the object's colour.
 	 */
-	static aga_uint_t objn = 0;
+	if(ver != 2) {
+		AGA_DEPRECATED_IMPL("Loading Version 1 model data is deprecated");
+	}
 
-	(void) env;
-	(void) self;
+	if(aga_draw_have_gl11()) {
+		GLsizei stride = sizeof(struct aga_vertex);
 
-	apro_stamp_start(APRO_SCRIPTGLUE_MKOBJ);
+		if(ver != 2) {
+			glEnableClientState(GL_COLOR_ARRAY);
+			glColorPointer(4, GL_FLOAT, stride, verts->col);
+		}
 
-	if(!aga_arg_list(args, PY_TYPE_STRING)) {
-		return aga_arg_error("mkobj", "string");
-	}
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(2, GL_FLOAT, stride, verts->uv);
+		glEnableClientState(GL_NORMAL_ARRAY);
+		glNormalPointer(GL_FLOAT, stride, verts->norm);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3, GL_FLOAT, stride, verts->pos);
 
-	if(!(obj = aga_calloc(1, sizeof(struct agan_object)))) {
-		return py_error_set_nomem();
-	}
+		glDrawArrays(GL_TRIANGLES, 0, (GLsizei) len);
 
-	retval = aga_script_pointer_new(obj);
-	v = (struct py_int*) retval;
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_NORMAL_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
 
-	obj->ind = objn++;
-	obj->light_data = 0;
-	if(!(obj->transform = agan_mktrans(env, 0, 0))) goto cleanup;
+		aga_free(verts);
 
-	{
-		void* fp;
+		if(aga_script_gl_err("glDrawArrays")) return AGA_TRUE;
 
-		path = py_string_get(args);
+		return AGA_FALSE;
+	}
 
-		result = aga_resource_pack_lookup(pack, path, &obj->res);
-		if(aga_script_err("aga_resource_pack_lookup", result)) goto cleanup;
+	glBegin(GL_TRIANGLES);
 
-		result = aga_resource_seek(obj->res, &fp);
-		if(aga_script_err("aga_resource_seek", result)) goto cleanup;
+	for(i = 0; i < len; ++i) {
+		const struct aga_vertex* v = &verts[i];
 
-		result = aga_config_new(fp, obj->res->size, &conf);
-		if(aga_script_err("aga_resource_stream", result)) goto cleanup;
+		if(ver != 2) glColor4fv(v->col);
 
-		c = AGA_TRUE;
+		glTexCoord2fv(v->uv);
+		glNormal3fv(v->norm);
+		glVertex3fv(v->pos);
 	}
 
-	if(agan_mkobj_trans(obj, &conf)) goto cleanup;
-	if(agan_mkobj_model(env, obj, &conf, pack, path)) goto cleanup;
-	if(agan_mkobj_light(obj, &conf)) goto cleanup;
-
-	m = AGA_TRUE;
+	glEnd();
 
-	result = aga_config_delete(&conf);
-	if(aga_script_err("aga_config_delete", result)) goto cleanup;
+	aga_free(verts);
 
-	apro_stamp_end(APRO_SCRIPTGLUE_MKOBJ);
+	if(aga_script_gl_err("glEnd")) return AGA_TRUE;
+
+	return AGA_FALSE;
+}
+
+#define AGAN_SHARED_BUCKETS (64)
+
+static struct agan_shared* agan_shared_models[AGAN_SHARED_BUCKETS];
+static struct agan_shared* agan_shared_textures[AGAN_SHARED_BUCKETS];
+
+/*
+ * The texture last bound by `agan_putobj' so runs of objects sharing one
+ * Don't rebind it -- or on GL 1.0 re-specify it. Nothing else in the engine
+ * Touches texture state, anything which does needs to clear this.
+ */
+static struct agan_shared* agan_bound_texture = 0;
+
+/* Takes a reference on an existing entry if there is one. */
+static struct agan_shared* agan_shared_acquire(
+		struct agan_shared** table, const char* path, aga_uint_t flags) {
+
+	struct agan_shared* shared = table[aga_strhash(path) % AGAN_SHARED_BUCKETS];
+
+	for(; shared; shared = shared->next) {
+		if(shared->flags == flags && aga_streql(shared->path, path)) {
+			shared->refcount++;
+			return shared;
+		}
+	}
+
+	return 0;
+}
+
+static struct agan_shared* agan_shared_new(const char* path, aga_uint_t flags) {
+	struct agan_shared* shared;
+
+	if(!(shared = aga_calloc(1, sizeof(struct agan_shared)))) return 0;
+
+	if(!(shared->path = aga_strdup(path))) {
+		aga_free(shared);
+		return 0;
+	}
+
+	shared->flags = flags;
+	shared->refcount = 1;
+
+	return shared;
+}
+
+static void agan_shared_insert(
+		struct agan_shared** table, struct agan_shared* shared) {
+
+	aga_size_t bucket = aga_strhash(shared->path) % AGAN_SHARED_BUCKETS;
+
+	shared->next = table[bucket];
+	table[bucket] = shared;
+}
+
+static void agan_shared_delete(struct agan_shared* shared) {
+	aga_free(shared->path);
+	aga_free(shared);
+}
+
+/* Drops a reference, freeing the GL name with the last one. */
+static void agan_shared_release(
+		struct agan_shared** table, struct agan_shared* shared) {
+
+	struct agan_shared** link;
+
+	if(!shared || --shared->refcount) return;
+
+	link = &table[aga_strhash(shared->path) % AGAN_SHARED_BUCKETS];
+	while(*link != shared) link = &(*link)->next;
+	*link = shared->next;
+
+	if(shared == agan_bound_texture) agan_bound_texture = 0;
+
+	if(table == agan_shared_textures && aga_draw_have_gl11()) {
+		GLuint name = shared->name;
+
+		glDeleteTextures(1, &name);
+		(void) aga_error_gl(__FILE__, "glDeleteTextures");
+	}
+	else {
+		glDeleteLists(shared->name, 1);
+		(void) aga_error_gl(__FILE__, "glDeleteLists");
+	}
+
+	agan_shared_delete(shared);
+}
+
+const char* aga_texture_formats[AGA_FORMAT_PALETTED + 1] = {
+		"Auto", "RGBA8888", "RGB888", "RGB565", "RGBA4444", "Luminance",
+		"Paletted"
+};
+
+aga_size_t aga_texture_format_size(enum aga_texture_format format) {
+	switch(format) {
+		default: return 4;
+
+		case AGA_FORMAT_RGB888: return 3;
+		case AGA_FORMAT_RGB565: return 2;
+		case AGA_FORMAT_RGBA4444: return 2;
+		case AGA_FORMAT_LUMINANCE: return 1;
+		case AGA_FORMAT_PALETTED: return 1;
+	}
+}
+
+/*
+ * Gets a level into something `glTexImage2D' takes -- packed formats are
+ * Widened into `buf' as GL 1.1 has no packed pixel types.
+ */
+static const void* agan_mkobj_texels(
+		enum aga_texture_format format, const aga_uchar_t* palette,
+		const aga_uchar_t* src, aga_slong_t w, aga_slong_t h, aga_uchar_t* buf,
+		GLenum* gl_format) {
+
+	aga_size_t count = (aga_size_t) (w * h);
+	aga_size_t i;
+
+	switch(format) {
+		default: {
+			*gl_format = GL_RGBA;
+			return src;
+		}
+
+		case AGA_FORMAT_RGB888: {
+			*gl_format = GL_RGB;
+			return src;
+		}
+
+		case AGA_FORMAT_LUMINANCE: {
+			*gl_format = GL_LUMINANCE;
+			return src;
+		}
+
+		case AGA_FORMAT_RGB565: {
+			*gl_format = GL_RGB;
+
+			for(i = 0; i < count; ++i) {
+				aga_ushort_t v;
+				aga_memcpy(&v, &src[2 * i], sizeof(v));
+
+				buf[3 * i + 0] = (aga_uchar_t) (((v >> 11) & 0x1F) * 255 / 31);
+				buf[3 * i + 1] = (aga_uchar_t) (((v >> 5) & 0x3F) * 255 / 63);
+				buf[3 * i + 2] = (aga_uchar_t) ((v & 0x1F) * 255 / 31);
+			}
+
+			return buf;
+		}
+
+		case AGA_FORMAT_RGBA4444: {
+			*gl_format = GL_RGBA;
+
+			for(i = 0; i < count; ++i) {
+				aga_ushort_t v;
+				aga_memcpy(&v, &src[2 * i], sizeof(v));
+
+				buf[4 * i + 0] = (aga_uchar_t) (((v >> 12) & 0xF) * 17);
+				buf[4 * i + 1] = (aga_uchar_t) (((v >> 8) & 0xF) * 17);
+				buf[4 * i + 2] = (aga_uchar_t) (((v >> 4) & 0xF) * 17);
+				buf[4 * i + 3] = (aga_uchar_t) ((v & 0xF) * 17);
+			}
+
+			return buf;
+		}
+
+		case AGA_FORMAT_PALETTED: {
+			*gl_format = GL_RGBA;
+
+			for(i = 0; i < count; ++i) {
+				aga_memcpy(&buf[4 * i], &palette[4 * src[i]], 4);
+			}
+
+			return buf;
+		}
+	}
+}
+
+/* Uploads the texture at `path' into whichever GL name is bound or open. */
+static aga_bool_t agan_mkobj_upload(
+		struct aga_resource_pack* pack, const char* path, aga_bool_t filter,
+		aga_bool_t mips) {
+
+	static const char* width = "Width";
+	static const char* height = "Height";
+	static const char* levels = "Levels";
+	static const char* format_name = "Format";
+
+	/* Sized internal formats so the driver keeps the precision we ask for. */
+	static const GLint internal_formats[] = {
+			GL_RGBA8, /* AGA_FORMAT_AUTO */
+			GL_RGBA8, /* AGA_FORMAT_RGBA8888 */
+			GL_RGB8, /* AGA_FORMAT_RGB888 */
+			GL_RGB5, /* AGA_FORMAT_RGB565 */
+			GL_RGBA4, /* AGA_FORMAT_RGBA4444 */
+			GL_LUMINANCE8, /* AGA_FORMAT_LUMINANCE */
+			GL_RGBA8 /* AGA_FORMAT_PALETTED */
+	};
+
+	enum aga_result result;
+
+	struct aga_resource* res;
+	struct aga_config_node* resconf;
+	aga_slong_t w, h, n;
+
+	enum aga_texture_format format = AGA_FORMAT_RGBA8888;
+	const char* str;
+	aga_size_t bpp;
+	const aga_uchar_t* palette = 0;
+	const aga_uchar_t* texels;
+	aga_uchar_t* buf = 0;
+	GLint internal;
+	GLenum gl_format;
+
+	int mag = filter ? GL_LINEAR : GL_NEAREST;
+	int min;
+
+	/*
+	 * TODO: Handle missing textures etc. gracefully - default/
+	 *       Procedural resources?
+	 */
+	result = aga_resource_new(pack, path, &res);
+	if(aga_script_err("aga_resource_new", result)) return AGA_TRUE;
+
+	result = aga_resource_conf(res, &resconf);
+	if(aga_script_err("aga_resource_conf", result)) goto cleanup;
+
+	result = aga_config_lookup(
+			resconf, &format_name, 1, &str, AGA_STRING, AGA_FALSE);
+	if(!result) {
+		aga_uint_t i;
+
+		for(i = AGA_FORMAT_RGBA8888; i <= AGA_FORMAT_PALETTED; ++i) {
+			if(aga_streql(str, aga_texture_formats[i])) {
+				format = (enum aga_texture_format) i;
+			}
+		}
+	}
+
+	bpp = aga_texture_format_size(format);
+	texels = res->data;
+
+	if(format == AGA_FORMAT_PALETTED) {
+		if(res->size < AGA_PALETTE_SIZE) {
+			aga_log(__FILE__, "warn: Texture `%s' has no palette", path);
+			format = AGA_FORMAT_LUMINANCE;
+		}
+		else {
+			palette = texels;
+			texels += AGA_PALETTE_SIZE;
+		}
+	}
+
+	result = aga_config_lookup(
+			resconf, &width, 1, &w, AGA_INTEGER, AGA_FALSE);
+	if(result) {
+		/* TODO: Default conf values as part of the API. */
+		aga_log(__FILE__, "warn: Texture `%s' is missing dimensions", path);
+		w = 0;
+		h = 0;
+	}
+	else {
+		result = aga_config_lookup(
+				resconf, &height, 1, &h, AGA_INTEGER, AGA_FALSE);
+		if(result) h = w > 0 ? (int) (res->size / (bpp * (aga_size_t) w)) : 0;
+	}
+
+	result = aga_config_lookup(
+			resconf, &levels, 1, &n, AGA_INTEGER, AGA_FALSE);
+	if(result) n = 1;
+
+	{
+		aga_slong_t i, lw = w, lh = h;
+		aga_size_t size = palette ? AGA_PALETTE_SIZE : 0;
+
+		for(i = 0; i < n; ++i) {
+			size += bpp * (aga_size_t) (lw * lh);
+			if(lw > 1) lw /= 2;
+			if(lh > 1) lh /= 2;
+		}
+
+		if(size > res->size) {
+			aga_log(__FILE__, "warn: Texture `%s' has a bad mip chain", path);
+			n = 1;
+		}
+	}
+
+	/* Even the base level has to be there to hand over to GL. */
+	{
+		aga_size_t size = palette ? AGA_PALETTE_SIZE : 0;
+
+		if(w >= 0 && h >= 0) size += bpp * (aga_size_t) w * (aga_size_t) h;
+
+		if(w < 0 || h < 0 || size > res->size) {
+			aga_log(__FILE__, "err: Malformed texture `%s'", path);
+			aga_script_err("agan_mkobj_upload", AGA_RESULT_BAD_PARAM);
+			goto cleanup;
+		}
+	}
+
+	/*
+	 * TODO: Turning off transparency could auto-disable the alpha channel.
+	 * 		 `glPolygonStipple' can be used for fake transparency.
+	 */
+	if(aga_draw_have_gl11()) internal = internal_formats[format];
+	else if(format == AGA_FORMAT_LUMINANCE) internal = 1;
+	else if(format == AGA_FORMAT_RGB888 || format == AGA_FORMAT_RGB565) {
+		internal = 3;
+	}
+	else internal = 4;
+
+	if(bpp < 3) {
+		if(!(buf = aga_malloc(4 * (aga_size_t) (w * h)))) {
+			py_error_set_nomem();
+			goto cleanup;
+		}
+	}
+
+	/* Rows of narrower formats aren't padded out to 4 bytes. */
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if(aga_script_gl_err("glPixelStorei")) goto cleanup;
+
+	if(mips && n > 1) {
+		const aga_uchar_t* level = texels;
+		aga_slong_t i;
+
+		/* The pack has the whole chain -- just hand each level over. */
+		for(i = 0; i < n; ++i) {
+			const void* data = agan_mkobj_texels(
+					format, palette, level, w, h, buf, &gl_format);
+
+			glTexImage2D(
+					GL_TEXTURE_2D, (int) i, internal, (int) w, (int) h, 0,
+					gl_format, GL_UNSIGNED_BYTE, data);
+
+			if(aga_script_gl_err("glTexImage2D")) goto cleanup;
+
+			level += bpp * (aga_size_t) (w * h);
+			if(w > 1) w /= 2;
+			if(h > 1) h /= 2;
+		}
+	}
+	else if(mips) {
+		const void* data = agan_mkobj_texels(
+				format, palette, texels, w, h, buf, &gl_format);
+
+		gluBuild2DMipmaps(
+				GL_TEXTURE_2D, internal, (int) w, (int) h, gl_format,
+				GL_UNSIGNED_BYTE, data);
+		/*
+		 * TODO: Script land can probably handle lots of GL errors like
+		 * 		 This relatively gracefully (i.e. allow the user code
+		 * 		 To go further without needing try-catch hell).
+		 * 		 Especially in functions like this which aren't
+		 * 		 Supposed to be run every frame.
+		 */
+		if(aga_script_gl_err("gluBuild2DMipmaps")) goto cleanup;
+	}
+	else {
+		const void* data = agan_mkobj_texels(
+				format, palette, texels, w, h, buf, &gl_format);
+
+		glTexImage2D(
+				GL_TEXTURE_2D, 0, internal, (int) w, (int) h, 0, gl_format,
+				GL_UNSIGNED_BYTE, data);
+
+		if(aga_script_gl_err("glTexImage2D")) goto cleanup;
+	}
+
+	aga_free(buf);
+	buf = 0;
+
+	if(mips) {
+		min = filter ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+	}
+	else min = mag;
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min);
+	if(aga_script_gl_err("glTexParameteri")) goto cleanup;
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag);
+	if(aga_script_gl_err("glTexParameteri")) goto cleanup;
+
+	/* The upload is the only copy we need -- let the cache have it. */
+	result = aga_resource_release(res);
+	if(aga_script_err("aga_resource_release", result)) return AGA_TRUE;
+
+	return AGA_FALSE;
+
+	cleanup: {
+		aga_free(buf);
+
+		aga_error_check_soft(
+				__FILE__, "aga_resource_release", aga_resource_release(res));
+
+		return AGA_TRUE;
+	}
+}
+
+static aga_bool_t agan_mkobj_texture(
+		struct agan_shared** out, struct aga_resource_pack* pack,
+		const char* path, aga_bool_t filter, aga_bool_t mips) {
+
+	aga_uint_t flags = (filter ? 1 : 0) | (mips ? 2 : 0);
+	struct agan_shared* tex;
+
+	if((*out = agan_shared_acquire(agan_shared_textures, path, flags))) {
+		return AGA_FALSE;
+	}
+
+	if(!(tex = agan_shared_new(path, flags))) {
+		py_error_set_nomem();
+		return AGA_TRUE;
+	}
+
+	if(aga_draw_have_gl11()) {
+		GLuint name;
+
+		glGenTextures(1, &name);
+		if(aga_script_gl_err("glGenTextures")) goto cleanup;
+
+		tex->name = name;
+
+		agan_bound_texture = 0;
+
+		glBindTexture(GL_TEXTURE_2D, name);
+		if(aga_script_gl_err("glBindTexture")) goto cleanup;
+
+		if(agan_mkobj_upload(pack, path, filter, mips)) goto cleanup;
+	}
+	else {
+		aga_bool_t failed;
+
+		/* Where we don't have texture objects a list can stand in for one. */
+		tex->name = glGenLists(1);
+		if(aga_script_gl_err("glGenLists")) goto cleanup;
+
+		glNewList(tex->name, GL_COMPILE);
+		if(aga_script_gl_err("glNewList")) goto cleanup;
+
+		failed = agan_mkobj_upload(pack, path, filter, mips);
+
+		glEndList();
+		if(aga_script_gl_err("glEndList") || failed) goto cleanup;
+	}
+
+	agan_shared_insert(agan_shared_textures, tex);
+	*out = tex;
+
+	return AGA_FALSE;
+
+	cleanup: {
+		if(tex->name && aga_draw_have_gl11()) {
+			GLuint name = tex->name;
+
+			glDeleteTextures(1, &name);
+			(void) aga_error_gl(__FILE__, "glDeleteTextures");
+		}
+		else if(tex->name) {
+			glDeleteLists(tex->name, 1);
+			(void) aga_error_gl(__FILE__, "glDeleteLists");
+		}
+
+		agan_shared_delete(tex);
+
+		return AGA_TRUE;
+	}
+}
+
+/*
+ * Models are shared per LOD level -- asking for a level the model wasn't
+ * Built with gives back no model rather than an error.
+ */
+static aga_bool_t agan_mkobj_geometry(
+		struct agan_shared** out, struct aga_resource_pack* pack,
+		const char* path, aga_uint_t lod) {
+
+	static const char* version = "Version";
+	static const char* lods = "Lods";
+
+	enum aga_result result;
+
+	struct agan_shared* model;
+	struct aga_resource* res;
+	struct aga_config_node* resconf;
+	aga_slong_t ver, nlods;
+	aga_bool_t failed;
+
+	if((*out = agan_shared_acquire(agan_shared_models, path, lod))) {
+		return AGA_FALSE;
+	}
+
+	result = aga_resource_pack_lookup(pack, path, &res);
+	if(aga_script_err("aga_resource_pack_lookup", result)) {
+		aga_log(__FILE__, "err: Failed to find resource `%s'", path);
+		return AGA_TRUE;
+	}
+
+	result = aga_resource_conf(res, &resconf);
+	if(aga_script_err("aga_resource_conf", result)) return AGA_TRUE;
+
+	if(!(model = agan_shared_new(path, lod))) {
+		py_error_set_nomem();
+		return AGA_TRUE;
+	}
+
+	agan_mkobj_extent(model, resconf);
+
+	result = aga_config_lookup(
+			resconf, &version, 1, &ver, AGA_INTEGER, AGA_FALSE);
+	if(result) ver = 1;
+
+	result = aga_config_lookup(
+			resconf, &lods, 1, &nlods, AGA_INTEGER, AGA_FALSE);
+	if(result || ver < 3) nlods = 0;
+
+	if(lod > (aga_uint_t) nlods) {
+		agan_shared_delete(model);
+		return AGA_FALSE;
+	}
+
+	/* Static scenery can be merged further with `agan_mkbatch'. */
+	model->name = glGenLists(1);
+	if(aga_script_gl_err("glGenLists")) goto cleanup;
+
+	glNewList(model->name, GL_COMPILE);
+	if(aga_script_gl_err("glNewList")) goto cleanup;
+
+	if(ver >= 3) failed = agan_mkobj_indexed(model, res, resconf, ver, lod);
+	else failed = agan_mkobj_soup(res, ver);
+
+	glEndList();
+	if(aga_script_gl_err("glEndList") || failed) goto cleanup;
+
+	agan_shared_insert(agan_shared_models, model);
+	*out = model;
+
+	return AGA_FALSE;
+
+	cleanup: {
+		if(model->name) {
+			glDeleteLists(model->name, 1);
+			(void) aga_error_gl(__FILE__, "glDeleteLists");
+		}
+
+		agan_shared_delete(model);
+
+		return AGA_TRUE;
+	}
+}
+
+/*
+ * Past each distance an object draws `ModelLod1', `ModelLod2' and finally a
+ * `Billboard' in place of its model. LOD levels built into the model itself
+ * Stand in where no `ModelLodN' is given. Distances which aren't given are
+ * Scaled off the model's size.
+ */
+static aga_bool_t agan_mkobj_lods(
+		struct agan_object* obj, struct aga_config_node* conf,
+		struct aga_resource_pack* pack, aga_bool_t filter, aga_bool_t mips) {
+
+	static const char* lod_models[] = { "ModelLod1", "ModelLod2" };
+	static const char* lod_distances[] = { "LodDistance1", "LodDistance2" };
+	static const float lod_scales[] = { 16.0f, 32.0f };
+	static const char* billboard = "Billboard";
+	static const char* billboard_distance = "BillboardDistance";
+
+	enum aga_result result;
+
+	const char* path;
+	float radius = 0.0f;
+	double f;
+	aga_size_t i;
+
+	for(i = 0; i < 3; ++i) {
+		float d = (obj->max_extent[i] - obj->min_extent[i]) / 2.0f;
+		radius += d * d;
+	}
+
+	radius = (float) sqrt(radius);
+
+	for(i = 0; i < AGA_MODEL_LODS; ++i) {
+		result = aga_config_lookup(
+				conf->children, &lod_models[i], 1, &path, AGA_STRING,
+				AGA_FALSE);
+
+		if(!result) {
+			if(agan_mkobj_geometry(&obj->lods[i], pack, path, 0)) {
+				return AGA_TRUE;
+			}
+		}
+		else if(obj->model) {
+			result = agan_mkobj_geometry(
+					&obj->lods[i], pack, obj->model->path,
+					(aga_uint_t) i + 1);
+			if(result) return AGA_TRUE;
+		}
+
+		result = aga_config_lookup(
+				conf->children, &lod_distances[i], 1, &f, AGA_FLOAT,
+				AGA_FALSE);
+		if(result) f = lod_scales[i] * radius;
+
+		obj->lod_distance[i] = (float) f;
+	}
+
+	result = aga_config_lookup(
+			conf->children, &billboard, 1, &path, AGA_STRING, AGA_FALSE);
+	if(!result) {
+		if(agan_mkobj_texture(&obj->billboard, pack, path, filter, mips)) {
+			return AGA_TRUE;
+		}
+
+		result = aga_config_lookup(
+				conf->children, &billboard_distance, 1, &f, AGA_FLOAT,
+				AGA_FALSE);
+		if(result) f = 64.0f * radius;
+
+		obj->billboard_distance = (float) f;
+	}
+
+	return AGA_FALSE;
+}
+
+static aga_bool_t agan_mkobj_model(
+		struct py_env* env, struct agan_object* obj,
+		struct aga_config_node* conf, struct aga_resource_pack* pack,
+		const char* objpath) {
+
+	static const char* model = "Model";
+	static const char* texture = "Texture";
+	static const char* filter = "Filter";
+	static const char* mipmap = "Mipmap";
+
+	struct aga_settings* settings = AGA_GET_USERDATA(env)->opts;
+
+	enum aga_result result;
+
+	const char* path;
+
+	aga_bool_t do_mips, tex_filter;
+	aga_slong_t v;
+
+	result = aga_config_lookup(
+			conf->children, &filter, 1, &v, AGA_INTEGER, AGA_FALSE);
+	if(result) v = 1;
+	tex_filter = !!v;
+
+	result = aga_config_lookup(
+			conf->children, &mipmap, 1, &v, AGA_INTEGER, AGA_FALSE);
+	if(result) v = settings->mipmap_default;
+	do_mips = !!v;
+
+	result = aga_config_lookup(
+			conf->children, &texture, 1, &path, AGA_STRING, AGA_FALSE);
+	if(result) {
+		/* TODO: Does this handle this case gracefully. */
+		aga_log(
+				__FILE__, "warn: Object `%s' is missing a texture entry",
+				objpath);
+	}
+	else if(agan_mkobj_texture(
+			&obj->texture, pack, path, tex_filter, do_mips)) {
+
+		return AGA_TRUE;
+	}
+
+	result = aga_config_lookup(
+			conf->children, &model, 1, &path, AGA_STRING, AGA_FALSE);
+	if(result) {
+		aga_log(
+				__FILE__, "warn: Object `%s' is missing a model entry",
+				objpath);
+	}
+	else {
+		aga_free(obj->modelpath);
+		if(!(obj->modelpath = aga_strdup(path))) {
+			py_error_set_nomem();
+			return AGA_TRUE;
+		}
+
+		if(agan_mkobj_geometry(&obj->model, pack, path, 0)) return AGA_TRUE;
+
+		aga_memcpy(
+				obj->min_extent, obj->model->min_extent,
+				sizeof(obj->min_extent));
+		aga_memcpy(
+				obj->max_extent, obj->model->max_extent,
+				sizeof(obj->max_extent));
+	}
+
+	return agan_mkobj_lods(obj, conf, pack, tex_filter, do_mips);
+}
+
+/* Gives up the object's references on shared models and textures. */
+static void agan_obj_release(struct agan_object* obj) {
+	aga_size_t i;
+
+	agan_shared_release(agan_shared_models, obj->model);
+	agan_shared_release(agan_shared_textures, obj->texture);
+	agan_shared_release(agan_shared_textures, obj->billboard);
+
+	for(i = 0; i < AGA_MODEL_LODS; ++i) {
+		agan_shared_release(agan_shared_models, obj->lods[i]);
+		obj->lods[i] = 0;
+	}
+
+	obj->model = 0;
+	obj->texture = 0;
+	obj->billboard = 0;
+}
+
+/*
+ * NOTE: The registry is an intrusive list of every live object, the
+ * 		 Visibility tree over it is rebuilt lazily whenever it changes.
+ */
+static struct agan_object* agan_objects = 0;
+static aga_size_t agan_object_count = 0;
+static aga_bool_t agan_vis_dirty = AGA_TRUE;
+
+static void agan_obj_link(struct agan_object* obj) {
+	obj->prev = 0;
+	obj->next = agan_objects;
+
+	if(agan_objects) agan_objects->prev = obj;
+	agan_objects = obj;
+
+	agan_object_count++;
+	agan_vis_dirty = AGA_TRUE;
+}
+
+static void agan_obj_unlink(struct agan_object* obj) {
+	if(obj->prev) obj->prev->next = obj->next;
+	else agan_objects = obj->next;
+
+	if(obj->next) obj->next->prev = obj->prev;
+
+	agan_object_count--;
+	agan_vis_dirty = AGA_TRUE;
+}
+
+static aga_bool_t agan_mkobj_light(
+		struct agan_object* obj, struct aga_config_node* conf) {
+
+	static const char* light = "Light";
+
+	enum aga_result result;
+
+	struct aga_config_node* node = conf->children;
+	struct agan_lightdata* data;
+
+	aga_slong_t scr;
+	aga_size_t i, j;
+
+	double v;
+
+	if(aga_config_lookup_raw(node, &light, 1, &node)) return AGA_FALSE;
+
+	if(!(obj->light_data = calloc(1, sizeof(struct agan_lightdata)))) {
+		return AGA_TRUE;
+	}
+	data = obj->light_data;
+
+	for(i = 0; i < node->len; ++i) {
+		aga_slong_t index;
+		struct aga_config_node* child = &node->children[i];
+
+		if(aga_config_variable("Index", child, AGA_INTEGER, &index)) {
+			if(index > 7 || index < 0) {
+				aga_log(
+						__FILE__, "warn: Light index `%u' out of range 0-7",
+						data->index);
+				free(data);
+				obj->light_data = 0;
+				return AGA_TRUE;
+			}
+
+			data->index = (aga_uchar_t) index;
+		}
+		else if(aga_config_variable("Directional", child, AGA_INTEGER, &scr)) {
+			data->directional = !!scr;
+		}
+		else if(aga_config_variable("Exponent", child, AGA_FLOAT, &v)) {
+			data->exponent = (float) v;
+		}
+		else if(aga_config_variable("Angle", child, AGA_FLOAT, &v)) {
+			data->angle = (float) v;
+		}
+		else if(aga_streql("Direction", child->name)) {
+			for(j = 0; j < 3; ++j) {
+				const char* comp = agan_xyz[j];
+				float (*dir)[3] = &data->direction;
+
+				result = aga_config_lookup(
+						child, &comp, 1, &v, AGA_FLOAT, AGA_FALSE);
+				(*dir)[j] = result ? 0.0f : (float) v;
+			}
+		}
+		/* TODO: General API for getting multiple components from conf node. */
+		else if(aga_streql("Ambient", child->name)) {
+			float (*col)[4] = &data->ambient;
+
+			for(j = 0; j < 3; ++j) {
+				const char* comp = agan_rgb[j];
+
+				result = aga_config_lookup(
+						child, &comp, 1, &v, AGA_FLOAT, AGA_FALSE);
+				if(result) (*col)[j] = 1.0f;
+				else (*col)[j] = (float) v;
+			}
+
+			(*col)[3] = 1.0f;
+		}
+		else if(aga_streql("Diffuse", child->name)) {
+			float (*col)[4] = &data->diffuse;
+
+			for(j = 0; j < 3; ++j) {
+				const char* comp = agan_rgb[j];
+
+				result = aga_config_lookup(
+						child, &comp, 1, &v, AGA_FLOAT, AGA_FALSE);
+				(*col)[j] = result ? 1.0f : (float) v;
+			}
+
+			(*col)[3] = 1.0f;
+		}
+		else if(aga_streql("Specular", child->name)) {
+			float (*col)[4] = &data->specular;
+
+			for(j = 0; j < 3; ++j) {
+				const char* comp = agan_rgb[j];
+
+				result = aga_config_lookup(
+						child, &comp, 1, &v, AGA_FLOAT, AGA_FALSE);
+				(*col)[j] = result ? 1.0f : (float) v;
+			}
+
+			(*col)[3] = 1.0f;
+		}
+		else if(aga_streql("Attenuation", child->name)) {
+			static const char* attenuation[] = {
+					"Constant", "Linear", "Quadratic"
+			};
+
+			float* at[AGA_LEN(attenuation)];
+			at[0] = &data->constant_attenuation;
+			at[1] = &data->linear_attenuation;
+			at[2] = &data->quadratic_attenuation;
+			for(j = 0; j < AGA_LEN(at); ++j) {
+				const char* comp = attenuation[j];
+
+				result = aga_config_lookup(
+						child, &comp, 1, &v, AGA_FLOAT, AGA_FALSE);
+				*at[j] = result ? 0.0f : (float) v;
+			}
+		}
+	}
+
+	/*aga_log(
+			__FILE__,
+			"\nambient: [ %f, %f, %f, %f ]\n"
+			"diffuse: [ %f, %f, %f, %f ]\n"
+			"specular: [ %f, %f, %f, %f ]\n"
+			"attenuation: {\n"
+			"\tconstant: %f\n"
+			"\tlinear: %f\n"
+			"\tquadratic: %f\n"
+			"}\n"
+			"direction: [ %f, %f, %f ]\n"
+			"exponent: %f\n"
+			"angle: %f\n"
+			"directional: %s\n"
+			"index: %u",
+			data->ambient[0], data->ambient[1], data->ambient[2],
+				data->ambient[3],
+			data->diffuse[0], data->diffuse[1], data->diffuse[2],
+				data->diffuse[3],
+			data->specular[0], data->specular[1], data->specular[2],
+				data->specular[3],
+			data->constant_attenuation, data->linear_attenuation,
+				data->quadratic_attenuation,
+			data->direction[0], data->direction[1], data->direction[2],
+			data->exponent, data->angle, data->directional ? "true" : "false",
+			(unsigned) data->index);
+	 */
+
+	return AGA_FALSE;
+}
+
+/* The body of `agan_mkobj' -- also used to make a scene's objects. */
+static struct py_object* agan_mkobj_path(
+		struct py_env* env, const char* path) {
+
+	enum aga_result result;
+
+	struct agan_object* obj;
+	struct py_int* v;
+	struct py_object* retval;
+	struct aga_config_node conf;
+	aga_bool_t c = AGA_FALSE;
+
+	struct aga_resource_pack* pack = AGA_GET_USERDATA(env)->resource_pack;
+
+	/*
+	 * TODO: Picking IDs are never reused as the registry is just a list --
+	 * 		 Have it hand these out with the handles it should distribute
+	 * 		 (See `struct agan_object') so they stay within 24 bits.
+	 */
+	static aga_uint_t objn = 0;
+
+	if(!(obj = aga_calloc(1, sizeof(struct agan_object)))) {
+		return py_error_set_nomem();
+	}
+
+	retval = aga_script_pointer_new(obj);
+	v = (struct py_int*) retval;
+
+	obj->ind = objn++;
+	obj->light_data = 0;
+	if(!(obj->transform = agan_mktrans(env, 0, 0))) goto cleanup;
+
+	{
+		void* fp;
+
+		result = aga_resource_pack_lookup(pack, path, &obj->res);
+		if(aga_script_err("aga_resource_pack_lookup", result)) goto cleanup;
+
+		/* Objects brought in with a scene needn't go back to the pack. */
+		if(obj->res->data) {
+			result = aga_config_new_buffer(
+					obj->res->data, obj->res->size, &conf);
+		}
+		else {
+			result = aga_resource_seek(obj->res, &fp);
+			if(aga_script_err("aga_resource_seek", result)) goto cleanup;
+
+			result = aga_config_new(fp, obj->res->size, &conf);
+		}
+		if(aga_script_err("aga_config_new", result)) goto cleanup;
+
+		c = AGA_TRUE;
+	}
+
+	if(agan_mkobj_trans(obj, &conf)) goto cleanup;
+	if(agan_mkobj_model(env, obj, &conf, pack, path)) goto cleanup;
+	if(agan_mkobj_light(obj, &conf)) goto cleanup;
+
+	result = aga_config_delete(&conf);
+	if(aga_script_err("aga_config_delete", result)) goto cleanup;
+
+	agan_obj_link(obj);
 
 	return (struct py_object*) retval;
 
-	cleanup: {
-		if(c) {
-			aga_error_check_soft(
-					__FILE__, "aga_config_delete", aga_config_delete(&conf));
-		}
+	cleanup: {
+		if(c) {
+			aga_error_check_soft(
+					__FILE__, "aga_config_delete", aga_config_delete(&conf));
+		}
+
+		agan_obj_release(obj);
+
+		aga_free(obj->modelpath);
+		aga_free(obj->light_data);
+		py_object_decref(obj->transform);
+		aga_free(aga_script_pointer_get(v));
+		py_object_decref(retval);
+
+		return 0;
+	}
+}
+
+struct py_object* agan_mkobj(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	struct py_object* retval;
+
+	(void) self;
+
+	apro_stamp_start(APRO_SCRIPTGLUE_MKOBJ);
+
+	if(!aga_arg_list(args, PY_TYPE_STRING)) {
+		return aga_arg_error("mkobj", "string");
+	}
+
+	if(!(retval = agan_mkobj_path(env, py_string_get(args)))) return 0;
+
+	apro_stamp_end(APRO_SCRIPTGLUE_MKOBJ);
+
+	return retval;
+}
+
+static void agan_obj_delete(struct agan_object* obj) {
+	agan_obj_unlink(obj);
+	agan_obj_release(obj);
+
+	aga_error_check_soft(
+			__FILE__, "agan_dropobjconf", agan_dropobjconf(obj));
+
+	py_object_decref(obj->transform);
+
+	aga_free(obj->modelpath);
+	aga_free(obj->light_data);
+
+	aga_free(obj);
+}
+
+struct py_object* agan_killobj(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	(void) env;
+	(void) self;
+
+	apro_stamp_start(APRO_SCRIPTGLUE_KILLOBJ);
+
+	if(!aga_arg_list(args, PY_TYPE_INT)) {
+		return aga_arg_error("killobj", "int");
+	}
+
+	agan_obj_delete(aga_script_pointer_get(args));
+
+	apro_stamp_end(APRO_SCRIPTGLUE_KILLOBJ);
+
+	return py_object_incref(PY_NONE);
+}
+
+struct py_object* agan_loadscene(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	enum aga_result result;
+
+	struct aga_resource_pack* pack = AGA_GET_USERDATA(env)->resource_pack;
+	struct aga_resource* res;
+	const struct aga_scene_header* hdr;
+	const struct aga_scene_entry* entries;
+	const char* strings;
+	struct py_object* retval;
+	struct py_object* o;
+	aga_size_t i;
+
+	(void) self;
+
+	apro_stamp_start(APRO_SCRIPTGLUE_LOADSCENE);
+
+	if(!aga_arg_list(args, PY_TYPE_STRING)) {
+		return aga_arg_error("loadscene", "string");
+	}
+
+	/* The one read -- everything after is from memory. */
+	result = aga_resource_new(pack, py_string_get(args), &res);
+	if(aga_script_err("aga_resource_new", result)) return 0;
+
+	result = aga_resource_scene(res);
+	if(aga_script_err("aga_resource_scene", result)) goto cleanup;
+
+	hdr = res->data;
+	entries = (const void*) (hdr + 1);
+	strings = (const char*) (entries + hdr->len);
+
+	if(!(retval = py_list_new(hdr->objects))) {
+		py_error_set_nomem();
+		goto cleanup;
+	}
+
+	for(i = 0; i < hdr->objects; ++i) {
+		if(!(o = agan_mkobj_path(env, strings + entries[i].name))) {
+			/* Nobody else has seen these yet. */
+			while(i--) {
+				agan_obj_delete(
+						aga_script_pointer_get(py_list_get(retval, i)));
+			}
+
+			py_object_decref(retval);
+			goto cleanup;
+		}
+
+		py_list_set(retval, i, o);
+	}
+
+	result = aga_resource_release(res);
+	if(aga_script_err("aga_resource_release", result)) return 0;
+
+	apro_stamp_end(APRO_SCRIPTGLUE_LOADSCENE);
+
+	return retval;
+
+	cleanup: {
+		aga_error_check_soft(
+				__FILE__, "aga_resource_release", aga_resource_release(res));
+
+		return 0;
+	}
+}
+
+struct py_object* agan_inobj(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	struct py_object* retval = PY_FALSE;
+	struct aga_zone* zone = AGA_GET_USERDATA(env)->zone;
+
+	struct py_object* objp;
+	struct py_object* planarp;
+	struct py_object* dbgp;
+	struct py_object* pointp;
+	struct py_object* tolerancep;
+
+	struct py_object* pos;
+	struct py_object* rot;
+	struct py_object* scale;
+
+	double point[3];
+	float min[3];
+	float max[3];
+	double rotation[3];
+	double x, z;
+
+	aga_bool_t planar;
+	unsigned i;
+	struct agan_object* obj;
+	double tolerance = AGA_TRANSFORM_TOLERANCE;
+
+	(void) env;
+	(void) self;
+
+	apro_stamp_start(APRO_SCRIPTGLUE_INOBJ);
+
+	if(!aga_vararg_list(args, PY_TYPE_TUPLE, 4) ||
+		!aga_arg(&objp, args, 0, PY_TYPE_INT) ||
+		!aga_vararg_typed(&pointp, args, 1, PY_TYPE_LIST, 3, PY_TYPE_FLOAT) ||
+		!aga_arg(&planarp, args, 2, PY_TYPE_INT) ||
+		!aga_arg(&dbgp, args, 3, PY_TYPE_INT)) {
+
+		if(!aga_vararg_list(args, PY_TYPE_TUPLE, 5) ||
+			!aga_arg(&objp, args, 0, PY_TYPE_INT) ||
+			!aga_vararg_typed(
+					&pointp, args, 1, PY_TYPE_LIST, 3, PY_TYPE_FLOAT) ||
+			!aga_arg(&planarp, args, 2, PY_TYPE_INT) ||
+			!aga_arg(&dbgp, args, 3, PY_TYPE_INT) ||
+			!aga_arg(&tolerancep, args, 4, PY_TYPE_FLOAT)) {
+
+			return aga_arg_error(
+					"inobj", "int, float[3], int, int [and float]");
+		}
+
+		tolerance = py_float_get(tolerancep);
+	}
+
+	planar = !!py_int_get(planarp);
+
+	obj = aga_script_pointer_get(objp);
+	memcpy(min, obj->min_extent, sizeof(min));
+	memcpy(max, obj->max_extent, sizeof(max));
+
+	if(!(pos = py_dict_lookup(obj->transform, "pos"))) return 0;
+	if(!(rot = py_dict_lookup(obj->transform, "rot"))) return 0;
+	if(!(scale = py_dict_lookup(obj->transform, "scale"))) return 0;
+
+	for(i = 0; i < AGA_LEN(min); ++i) {
+		float f;
+
+		/* TODO: Static "get N items into buffer" to make noverify easier. */
+
+		point[i] = py_float_get(py_list_get(pointp, i));
+
+		f = (float) py_float_get(py_list_get(scale, i));
+
+		min[i] *= f;
+		max[i] *= f;
+
+		rotation[i] = py_float_get(py_list_get(rot, i));
+	}
+
+	/* TODO: This only handles Y-plane rotations. */
+	/* TODO: This doesn't handle lopsided objects correctly. */
+
+	/* rot[Y] ~= 90 */
+	/* rot[Y] ~= -90 */
+	if(fabs(fabs(rotation[1]) - 90.0) < AGA_TRANSFORM_TOLERANCE) {
+		AGA_SWAP_FLOAT(min[0], min[2]);
+		AGA_SWAP_FLOAT(max[0], max[2]);
+	}
+
+	for(i = 0; i < AGA_LEN(min); ++i) {
+		double f = py_float_get(py_list_get(pos, i));
+
+		min[i] += (float) (f - tolerance);
+		max[i] += (float) (f + tolerance);
+	}
+
+	/* Objects out in cells we've let go of aren't part of the world. */
+	x = py_float_get(py_list_get(pos, 0));
+	z = py_float_get(py_list_get(pos, 2));
+
+	if(!aga_zone_resident(zone, (float) x, (float) z)) retval = PY_FALSE;
+	else if(planar || point[1] > min[1]) {
+		if(point[0] > min[0] && point[2] > min[2]) {
+
+			if(planar || point[1] < max[1]) {
+				if(point[0] < max[0] && point[2] < max[2]) {
+					retval = PY_TRUE;
+				}
+			}
+		}
+	}
+
+	/*
+	 * TODO: `glPolygonMode' can provide wireframes if we want a model
+	 * 		 Wireframe rather than a box outline.
+	 */
+	if(py_int_get(dbgp)) {
+		enum aga_draw_flags fl = aga_draw_get();
+
+		if(aga_script_err("aga_draw_set", aga_draw_set(AGA_DRAW_NONE))) return 0;
+
+		glLineWidth(1.0f);
+		if(aga_script_gl_err("glLineWidth")) return 0;
+
+		glBegin(GL_LINE_STRIP);
+			glColor3f(0.0f, 1.0f, 0.0f);
+			glVertex3f(min[0], max[1], max[2]);
+			glVertex3f(max[0], max[1], max[2]);
+			glVertex3f(min[0], min[1], max[2]);
+			glVertex3f(max[0], min[1], max[2]);
+			glVertex3f(max[0], min[1], min[2]);
+			glVertex3f(max[0], max[1], max[2]);
+			glVertex3f(max[0], max[1], min[2]);
+			glVertex3f(min[0], max[1], max[2]);
+			glVertex3f(min[0], max[1], min[2]);
+			glVertex3f(min[0], min[1], max[2]);
+			glVertex3f(min[0], min[1], min[2]);
+			glVertex3f(max[0], min[1], min[2]);
+			glVertex3f(min[0], max[1], min[2]);
+			glVertex3f(max[0], max[1], min[2]);
+		glEnd();
+		if(aga_script_gl_err("glEnd")) return 0;
+
+		if(aga_script_err("aga_draw_set", aga_draw_set(fl))) return 0;
+	}
+
+	apro_stamp_end(APRO_SCRIPTGLUE_INOBJ);
+
+	return py_object_incref(retval);
+}
+
+/*
+ * NOTE: We don't hold onto conf from `mkobj' as most objects are never asked
+ * 		 For it again -- it's parsed on first use and held for the load/save
+ * 		 Period until dropped (by script or on pack reload).
+ */
+enum aga_result agan_getobjconf(
+		struct agan_object* obj, struct aga_config_node** out) {
+
+	enum aga_result result;
+
+	if(!obj) return AGA_RESULT_BAD_PARAM;
+
+	if(!obj->conf_valid) {
+		aga_config_debug_file = obj->res->path;
+
+		if(obj->res->data) {
+			result = aga_config_new_buffer(
+					obj->res->data, obj->res->size, &obj->conf);
+		}
+		else {
+			void* fp;
+
+			result = aga_resource_seek(obj->res, &fp);
+			if(result) return result;
+
+			result = aga_config_new(fp, obj->res->size, &obj->conf);
+		}
+		if(result) return result;
+
+		obj->conf_valid = AGA_TRUE;
+	}
+
+	*out = &obj->conf;
+
+	return AGA_RESULT_OK;
+}
+
+enum aga_result agan_dropobjconf(struct agan_object* obj) {
+	if(!obj) return AGA_RESULT_BAD_PARAM;
+
+	if(!obj->conf_valid) return AGA_RESULT_OK;
+
+	obj->conf_valid = AGA_FALSE;
+	obj->conf_generation++;
+
+	return aga_config_delete(&obj->conf);
+}
+
+enum aga_result agan_dropobjconfs(void) {
+	enum aga_result result = AGA_RESULT_OK;
+	struct agan_object* obj;
+
+	for(obj = agan_objects; obj; obj = obj->next) {
+		enum aga_result err = agan_dropobjconf(obj);
+		if(err) result = err;
+	}
+
+	return result;
+}
+
+struct py_object* agan_objconf(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	enum aga_result result;
+
+	struct py_object* o;
+	struct py_object* l;
+	struct py_object* retval;
+
+	struct aga_config_node* conf;
+	struct agan_object* obj;
+
+	(void) env;
+	(void) self;
+
+	apro_stamp_start(APRO_SCRIPTGLUE_OBJCONF);
+
+	if(!aga_arg_list(args, PY_TYPE_TUPLE) ||
+	   !aga_arg(&o, args, 0, PY_TYPE_INT) ||
+	   !aga_arg(&l, args, 1, PY_TYPE_LIST)) {
+
+		return aga_arg_error("objconf", "int and list");
+	}
+
+	obj = aga_script_pointer_get(o);
+
+	result = agan_getobjconf(obj, &conf);
+	if(aga_script_err("agan_getobjconf", result)) return 0;
+
+	retval = agan_scriptconf(conf, AGA_TRUE, l);
+
+	apro_stamp_end(APRO_SCRIPTGLUE_OBJCONF);
+
+	return retval ? retval : py_object_incref(PY_NONE);
+}
+
+struct py_object* agan_dropconf(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	enum aga_result result;
+
+	(void) env;
+	(void) self;
+
+	if(!aga_arg_list(args, PY_TYPE_INT)) {
+		return aga_arg_error("dropconf", "int");
+	}
+
+	result = agan_dropobjconf(aga_script_pointer_get(args));
+	if(aga_script_err("agan_dropobjconf", result)) return 0;
+
+	return py_object_incref(PY_NONE);
+}
+
+struct agan_prop {
+	struct agan_object* obj;
+
+	char** names;
+	aga_size_t len;
+
+	/* Null if the lookup missed -- valid while `generation' matches. */
+	struct aga_config_node* node;
+	aga_uint_t generation;
+	aga_bool_t resolved;
+};
+
+static void agan_prop_delete(struct agan_prop* prop) {
+	aga_size_t i;
+
+	for(i = 0; i < prop->len; ++i) aga_free(prop->names[i]);
+
+	aga_free(prop->names);
+	aga_free(prop);
+}
+
+static enum aga_result agan_prop_resolve(struct agan_prop* prop) {
+	enum aga_result result;
+
+	struct aga_config_node* conf;
+
+	if(prop->resolved && prop->obj->conf_valid &&
+		prop->generation == prop->obj->conf_generation) {
+
+		return AGA_RESULT_OK;
+	}
+
+	result = agan_getobjconf(prop->obj, &conf);
+	if(result) return result;
+
+	result = aga_config_lookup_check(
+			conf->children, (const char**) prop->names, prop->len,
+			&prop->node);
+	if(result) prop->node = 0;
+
+	prop->generation = prop->obj->conf_generation;
+	prop->resolved = AGA_TRUE;
+
+	return AGA_RESULT_OK;
+}
+
+struct py_object* agan_mkprop(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	enum aga_result result;
+
+	struct py_object* o;
+	struct py_object* l;
+	struct py_object* retval;
+
+	struct agan_prop* prop;
+	aga_size_t i;
+
+	(void) env;
+	(void) self;
+
+	if(!aga_arg_list(args, PY_TYPE_TUPLE) ||
+	   !aga_arg(&o, args, 0, PY_TYPE_INT) ||
+	   !aga_arg(&l, args, 1, PY_TYPE_LIST)) {
+
+		return aga_arg_error("mkprop", "int and list");
+	}
+
+	/* There's no value at the root to give back. */
+	if(!py_varobject_size(l)) {
+		py_error_set_badarg();
+		return 0;
+	}
+
+	if(!(prop = aga_calloc(1, sizeof(struct agan_prop)))) {
+		return py_error_set_nomem();
+	}
+
+	prop->obj = aga_script_pointer_get(o);
+	prop->len = py_varobject_size(l);
+
+	if(!(prop->names = aga_calloc(prop->len, sizeof(char*)))) {
+		py_error_set_nomem();
+		goto cleanup;
+	}
+
+	for(i = 0; i < prop->len; ++i) {
+		struct py_object* op = py_list_get(l, i);
+
+		if(op->type != PY_TYPE_STRING) {
+			py_error_set_badarg();
+			goto cleanup;
+		}
+
+		if(!(prop->names[i] = aga_strdup(py_string_get(op)))) {
+			py_error_set_nomem();
+			goto cleanup;
+		}
+	}
+
+	result = agan_prop_resolve(prop);
+	if(aga_script_err("agan_prop_resolve", result)) goto cleanup;
+
+	if(!(retval = aga_script_pointer_new(prop))) goto cleanup;
+
+	return retval;
+
+	cleanup: {
+		agan_prop_delete(prop);
+
+		return 0;
+	}
+}
+
+struct py_object* agan_getprop(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	enum aga_result result;
+
+	struct agan_prop* prop;
+	struct py_object* retval;
+
+	(void) env;
+	(void) self;
+
+	apro_stamp_start(APRO_SCRIPTGLUE_GETPROP);
+
+	if(!aga_arg_list(args, PY_TYPE_INT)) {
+		return aga_arg_error("getprop", "int");
+	}
+
+	prop = aga_script_pointer_get(args);
+
+	result = agan_prop_resolve(prop);
+	if(aga_script_err("agan_prop_resolve", result)) return 0;
+
+	if(prop->node) retval = agan_scriptvalue(prop->node);
+	else retval = py_object_incref(PY_NONE);
+
+	apro_stamp_end(APRO_SCRIPTGLUE_GETPROP);
+
+	return retval;
+}
+
+struct py_object* agan_killprop(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	(void) env;
+	(void) self;
+
+	if(!aga_arg_list(args, PY_TYPE_INT)) {
+		return aga_arg_error("killprop", "int");
+	}
+
+	agan_prop_delete(aga_script_pointer_get(args));
+
+	return py_object_incref(PY_NONE);
+}
+
+static aga_bool_t agan_putobj_light(struct agan_lightdata* data) {
+	unsigned ind = GL_LIGHT0 + data->index;
+	float pos[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	pos[3] = data->directional ? 0.0f : 1.0f;
+
+	glEnable(ind);
+	if(aga_script_gl_err("glEnable")) return AGA_TRUE;
+
+	glLightfv(ind, GL_POSITION, pos);
+	if(aga_script_gl_err("glLightfv")) return AGA_TRUE;
+
+	glLightfv(ind, GL_AMBIENT, data->ambient);
+	if(aga_script_gl_err("glLightfv")) return AGA_TRUE;
+
+	glLightfv(ind, GL_DIFFUSE, data->diffuse);
+	if(aga_script_gl_err("glLightfv")) return AGA_TRUE;
+
+	glLightfv(ind, GL_SPECULAR, data->specular);
+	if(aga_script_gl_err("glLightfv")) return AGA_TRUE;
+
+	glLightf(ind, GL_CONSTANT_ATTENUATION, data->constant_attenuation);
+	if(aga_script_gl_err("glLightf")) return AGA_TRUE;
+
+	glLightf(ind, GL_LINEAR_ATTENUATION, data->linear_attenuation);
+	if(aga_script_gl_err("glLightf")) return AGA_TRUE;
+
+	glLightf(ind, GL_QUADRATIC_ATTENUATION, data->quadratic_attenuation);
+	if(aga_script_gl_err("glLightf")) return AGA_TRUE;
+
+	glLightf(ind, GL_SPOT_EXPONENT, data->exponent);
+	if(aga_script_gl_err("glLightf")) return AGA_TRUE;
+
+	glLightf(ind, GL_SPOT_CUTOFF, data->angle);
+	if(aga_script_gl_err("glLightf")) return AGA_TRUE;
+
+	glLightfv(ind, GL_SPOT_DIRECTION, data->direction);
+	if(aga_script_gl_err("glLightfv")) return AGA_TRUE;
+
+	return AGA_FALSE;
+}
+
+/* Skips the bind if `texture' is already current. */
+static aga_bool_t agan_bind_texture(struct agan_shared* texture) {
+	if(!texture || texture == agan_bound_texture) return AGA_FALSE;
+
+	if(aga_draw_have_gl11()) {
+		glBindTexture(GL_TEXTURE_2D, texture->name);
+		if(aga_script_gl_err("glBindTexture")) return AGA_TRUE;
+	}
+	else {
+		glCallList(texture->name);
+		if(aga_script_gl_err("glCallList")) return AGA_TRUE;
+	}
+
+	agan_bound_texture = texture;
+
+	return AGA_FALSE;
+}
+
+/*
+ * Draws a camera-facing quad the size of the object in its place. Expects
+ * The object's transform to be on top of the modelview stack, which it
+ * Replaces with one which only keeps where the object is relative to the eye.
+ */
+static aga_bool_t agan_putobj_billboard(
+		struct agan_object* obj, const double* mv, const double* eye) {
+
+	double half[3];
+	double w, h;
+	aga_size_t i;
+
+	for(i = 0; i < 3; ++i) {
+		const double* col = &mv[4 * i];
+		double scale;
+
+		scale = sqrt(col[0] * col[0] + col[1] * col[1] + col[2] * col[2]);
+		half[i] = scale * (obj->max_extent[i] - obj->min_extent[i]) / 2.0;
+	}
+
+	w = half[0] > half[2] ? half[0] : half[2];
+	h = half[1];
+
+	if(agan_bind_texture(obj->billboard)) return AGA_TRUE;
+
+	glLoadIdentity();
+	if(aga_script_gl_err("glLoadIdentity")) return AGA_TRUE;
+	glTranslated(eye[0], eye[1], eye[2]);
+	if(aga_script_gl_err("glTranslated")) return AGA_TRUE;
+
+	/* Impostor textures are expected to be cut out with alpha. */
+	glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT);
+	if(aga_script_gl_err("glPushAttrib")) return AGA_TRUE;
+
+	glEnable(GL_ALPHA_TEST);
+	glAlphaFunc(GL_GREATER, 0.5f);
+
+	glBegin(GL_QUADS);
+		glNormal3f(0.0f, 0.0f, 1.0f);
+		glTexCoord2f(0.0f, 0.0f);
+		glVertex3d(-w, -h, 0.0);
+		glTexCoord2f(1.0f, 0.0f);
+		glVertex3d(w, -h, 0.0);
+		glTexCoord2f(1.0f, 1.0f);
+		glVertex3d(w, h, 0.0);
+		glTexCoord2f(0.0f, 1.0f);
+		glVertex3d(-w, h, 0.0);
+	glEnd();
+	if(aga_script_gl_err("glEnd")) return AGA_TRUE;
+
+	glPopAttrib();
+	if(aga_script_gl_err("glPopAttrib")) return AGA_TRUE;
+
+	return AGA_FALSE;
+}
+
+/*
+ * Picks what to draw for the object by how far its centre is from the eye.
+ * Objects without LODs skip the matrix read.
+ */
+static aga_bool_t agan_putobj_geometry(struct agan_object* obj) {
+	struct agan_shared* model = obj->model;
+	aga_bool_t lods = !!obj->billboard;
+	double mv[16];
+	double centre[3];
+	double eye[3];
+	double dist;
+	aga_size_t i;
+
+	for(i = 0; i < AGA_MODEL_LODS; ++i) if(obj->lods[i]) lods = AGA_TRUE;
+
+	if(lods) {
+		glGetDoublev(GL_MODELVIEW_MATRIX, mv);
+		if(aga_script_gl_err("glGetDoublev")) return AGA_TRUE;
+
+		for(i = 0; i < 3; ++i) {
+			centre[i] = (obj->min_extent[i] + obj->max_extent[i]) / 2.0;
+		}
+
+		for(i = 0; i < 3; ++i) {
+			eye[i] = mv[i] * centre[0] + mv[4 + i] * centre[1] +
+					mv[8 + i] * centre[2] + mv[12 + i];
+		}
+
+		dist = sqrt(eye[0] * eye[0] + eye[1] * eye[1] + eye[2] * eye[2]);
+
+		if(obj->billboard && dist >= obj->billboard_distance) {
+			return agan_putobj_billboard(obj, mv, eye);
+		}
+
+		for(i = 0; i < AGA_MODEL_LODS; ++i) {
+			if(obj->lods[i] && dist >= obj->lod_distance[i]) {
+				model = obj->lods[i];
+			}
+		}
+	}
+
+	if(agan_bind_texture(obj->texture)) return AGA_TRUE;
+	if(!model) return AGA_FALSE;
+
+	glCallList(model->name);
+	return aga_script_gl_err("glCallList");
+}
+
+/* Draws the object under its transform -- the body of `agan_putobj'. */
+static aga_bool_t agan_putobj_draw(struct agan_object* obj) {
+	apro_stamp_start(APRO_PUTOBJ_RISING);
+
+	glMatrixMode(GL_MODELVIEW);
+	if(aga_script_gl_err("glMatrixMode")) return AGA_TRUE;
+	glPushMatrix();
+	if(aga_script_gl_err("glPushMatrix")) return AGA_TRUE;
+	if(agan_settransmat(obj->transform, AGA_FALSE)) return AGA_TRUE;
+
+	apro_stamp_end(APRO_PUTOBJ_RISING);
+
+	apro_stamp_start(APRO_PUTOBJ_LIGHT);
+
+	if(obj->light_data && agan_putobj_light(obj->light_data)) return AGA_TRUE;
+
+	apro_stamp_end(APRO_PUTOBJ_LIGHT);
+
+	apro_stamp_start(APRO_PUTOBJ_CALL);
+
+	glColor3ub(
+			(obj->ind >> (2 * 8)) & 0xFF, (obj->ind >> (1 * 8)) & 0xFF,
+			(obj->ind >> (0 * 8)) & 0xFF);
+
+	if(agan_putobj_geometry(obj)) return AGA_TRUE;
+
+	apro_stamp_end(APRO_PUTOBJ_CALL);
 
-		if(m) {
-			glDeleteLists(obj->drawlist, 1);
-			(void) aga_error_gl(__FILE__, "glDeleteLists");
-		}
+	apro_stamp_start(APRO_PUTOBJ_FALLING);
 
-		aga_free(obj->light_data);
-		py_object_decref(obj->transform);
-		aga_free(aga_script_pointer_get(v));
-		py_object_decref(retval);
+	glMatrixMode(GL_MODELVIEW);
+	if(aga_script_gl_err("glMatrixMode")) return AGA_TRUE;
+	glPopMatrix();
+	if(aga_script_gl_err("glPopMatrix")) return AGA_TRUE;
 
-		return 0;
+	apro_stamp_end(APRO_PUTOBJ_FALLING);
+
+	return AGA_FALSE;
+}
+
+struct py_object* agan_putobj(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	(void) env;
+	(void) self;
+
+	apro_stamp_start(APRO_SCRIPTGLUE_PUTOBJ);
+
+	if(!aga_arg_list(args, PY_TYPE_INT)) {
+		return aga_arg_error("putobj", "int");
 	}
+
+	if(agan_putobj_draw(aga_script_pointer_get(args))) return 0;
+
+	apro_stamp_end(APRO_SCRIPTGLUE_PUTOBJ);
+
+	return py_object_incref(PY_NONE);
 }
 
-struct py_object* agan_killobj(
+struct py_object* agan_objtrans(
 		struct py_env* env, struct py_object* self, struct py_object* args) {
 
 	struct agan_object* obj;
@@ -575,369 +2188,869 @@ struct py_object* agan_killobj(
 	(void) env;
 	(void) self;
 
-	apro_stamp_start(APRO_SCRIPTGLUE_KILLOBJ);
+	apro_stamp_start(APRO_SCRIPTGLUE_OBJTRANS);
 
 	if(!aga_arg_list(args, PY_TYPE_INT)) {
-		return aga_arg_error("killobj", "int");
+		return aga_arg_error("objtrans", "int");
 	}
 
 	obj = aga_script_pointer_get(args);
 
-	glDeleteLists(obj->drawlist, 1);
-	if(aga_script_gl_err("glDeleteLists")) return 0;
+	apro_stamp_end(APRO_SCRIPTGLUE_OBJTRANS);
 
-	py_object_decref(obj->transform);
+	return obj->transform;
+}
 
-	aga_free(obj->modelpath);
+struct py_object* agan_objind(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
 
-	aga_free(obj);
+	struct agan_object* obj;
 
-	apro_stamp_end(APRO_SCRIPTGLUE_KILLOBJ);
+	(void) env;
+	(void) self;
 
-	return py_object_incref(PY_NONE);
+	apro_stamp_start(APRO_SCRIPTGLUE_OBJTRANS);
+
+	if(!aga_arg_list(args, PY_TYPE_INT)) {
+		return aga_arg_error("agan_objind", "int");
+	}
+
+	obj = aga_script_pointer_get(args);
+
+	apro_stamp_end(APRO_SCRIPTGLUE_OBJTRANS);
+
+	return py_int_new(obj->ind);
 }
 
-struct py_object* agan_inobj(
-		struct py_env* env, struct py_object* self, struct py_object* args) {
+/* Gets the object's transform as a matrix without disturbing the stack. */
+static aga_bool_t agan_batch_matrix(struct agan_object* obj, double* mat) {
+	glMatrixMode(GL_MODELVIEW);
+	if(aga_script_gl_err("glMatrixMode")) return AGA_TRUE;
+	glPushMatrix();
+	if(aga_script_gl_err("glPushMatrix")) return AGA_TRUE;
+	glLoadIdentity();
+	if(aga_script_gl_err("glLoadIdentity")) return AGA_TRUE;
 
-	struct py_object* retval = PY_FALSE;
+	if(agan_settransmat(obj->transform, AGA_FALSE)) return AGA_TRUE;
 
-	struct py_object* objp;
-	struct py_object* planarp;
-	struct py_object* dbgp;
-	struct py_object* pointp;
-	struct py_object* tolerancep;
+	glGetDoublev(GL_MODELVIEW_MATRIX, mat);
+	if(aga_script_gl_err("glGetDoublev")) return AGA_TRUE;
 
-	struct py_object* pos;
-	struct py_object* rot;
-	struct py_object* scale;
+	glPopMatrix();
+	if(aga_script_gl_err("glPopMatrix")) return AGA_TRUE;
 
-	double point[3];
-	float min[3];
-	float max[3];
-	double rotation[3];
+	return AGA_FALSE;
+}
 
-	aga_bool_t planar;
-	unsigned i;
-	struct agan_object* obj;
-	double tolerance = AGA_TRANSFORM_TOLERANCE;
+static void agan_batch_point(
+		struct agan_batch* batch, const double* mat, const float* in,
+		float* out) {
+
+	aga_size_t i;
+
+	for(i = 0; i < 3; ++i) {
+		out[i] = (float) (
+				mat[i] * in[0] + mat[4 + i] * in[1] + mat[8 + i] * in[2] +
+				mat[12 + i]);
+
+		if(out[i] < batch->min_extent[i]) batch->min_extent[i] = out[i];
+		if(out[i] > batch->max_extent[i]) batch->max_extent[i] = out[i];
+	}
+}
+
+/*
+ * Normals go through the inverse transpose so scaled objects stay lit
+ * Correctly -- the cofactors give us that up to scale.
+ */
+static void agan_batch_normal(const double* mat, const float* in, float* out) {
+	double cof[9];
+	double n[3];
+	double det, len;
+	aga_size_t i;
+
+	cof[0] = mat[5] * mat[10] - mat[6] * mat[9];
+	cof[1] = mat[6] * mat[8] - mat[4] * mat[10];
+	cof[2] = mat[4] * mat[9] - mat[5] * mat[8];
+	cof[3] = mat[9] * mat[2] - mat[10] * mat[1];
+	cof[4] = mat[10] * mat[0] - mat[8] * mat[2];
+	cof[5] = mat[8] * mat[1] - mat[9] * mat[0];
+	cof[6] = mat[1] * mat[6] - mat[2] * mat[5];
+	cof[7] = mat[2] * mat[4] - mat[0] * mat[6];
+	cof[8] = mat[0] * mat[5] - mat[1] * mat[4];
+
+	det = mat[0] * cof[0] + mat[1] * cof[1] + mat[2] * cof[2];
+
+	for(i = 0; i < 3; ++i) {
+		n[i] = cof[i] * in[0] + cof[3 + i] * in[1] + cof[6 + i] * in[2];
+		if(det < 0.0) n[i] = -n[i];
+	}
+
+	len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+	if(len == 0.0) len = 1.0;
+
+	for(i = 0; i < 3; ++i) out[i] = (float) (n[i] / len);
+}
+
+/* The merged geometry for one texture's worth of objects. */
+struct agan_batch_geometry {
+	struct aga_model_vertex* verts;
+	aga_uchar_t* cols;
+	aga_uint_t* inds;
+
+	aga_size_t nverts;
+	aga_size_t ninds;
+};
+
+/*
+ * Appends the object's model to `geom' in world space. Models from before
+ * Version 3 aren't kept around indexed so they're left for the caller.
+ */
+static aga_bool_t agan_batch_bake(
+		struct agan_batch* batch, struct agan_batch_geometry* geom,
+		struct agan_object* obj, const double* mat,
+		struct aga_resource_pack* pack, aga_bool_t* baked) {
+
+	static const char* version = "Version";
+
+	enum aga_result result;
+
+	struct aga_resource* res;
+	struct aga_config_node* resconf;
+	struct agan_model_data in;
+	aga_slong_t ver;
+	aga_size_t i;
+
+	result = aga_resource_pack_lookup(pack, obj->model->path, &res);
+	if(aga_script_err("aga_resource_pack_lookup", result)) return AGA_TRUE;
+
+	result = aga_resource_conf(res, &resconf);
+	if(aga_script_err("aga_resource_conf", result)) return AGA_TRUE;
+
+	result = aga_config_lookup(
+			resconf, &version, 1, &ver, AGA_INTEGER, AGA_FALSE);
+	if(result) ver = 1;
+
+	if(!(*baked = ver >= 3)) return AGA_FALSE;
+
+	if(agan_model_read(obj->model, res, resconf, ver, 0, &in)) {
+		return AGA_TRUE;
+	}
+
+	geom->verts = aga_realloc(
+			geom->verts,
+			(geom->nverts + in.nverts) * sizeof(struct aga_model_vertex));
+	if(!geom->verts) goto oom;
+
+	geom->cols = aga_realloc(geom->cols, 3 * (geom->nverts + in.nverts));
+	if(!geom->cols) goto oom;
+
+	geom->inds = aga_realloc(
+			geom->inds, (geom->ninds + in.ninds) * sizeof(aga_uint_t));
+	if(!geom->inds) goto oom;
+
+	for(i = 0; i < in.nverts; ++i) {
+		const struct aga_model_vertex* v = &in.verts[i];
+		struct aga_model_vertex* out = &geom->verts[geom->nverts + i];
+		aga_uchar_t* col = &geom->cols[3 * (geom->nverts + i)];
+
+		out->uv[0] = v->uv[0];
+		out->uv[1] = v->uv[1];
+
+		agan_batch_normal(mat, v->norm, out->norm);
+		agan_batch_point(batch, mat, v->pos, out->pos);
+
+		/* Keeps colour picking working on batched objects. */
+		col[0] = (obj->ind >> (2 * 8)) & 0xFF;
+		col[1] = (obj->ind >> (1 * 8)) & 0xFF;
+		col[2] = (obj->ind >> (0 * 8)) & 0xFF;
+	}
+
+	for(i = 0; i < in.ninds; ++i) {
+		aga_uint_t ind = agan_model_index(&in, i);
+		geom->inds[geom->ninds + i] = (aga_uint_t) geom->nverts + ind;
+	}
+
+	geom->nverts += in.nverts;
+	geom->ninds += in.ninds;
+
+	agan_model_free(&in);
+
+	return AGA_FALSE;
+
+	oom: {
+		agan_model_free(&in);
+		py_error_set_nomem();
+
+		return AGA_TRUE;
+	}
+}
+
+/* Compiles every object in `objs' using the part's texture into its list. */
+static aga_bool_t agan_mkbatch_part(
+		struct agan_batch* batch, struct agan_batch_part* part,
+		struct agan_object** objs, const double* mats, aga_size_t len,
+		struct aga_resource_pack* pack) {
+
+	struct agan_batch_geometry geom = { 0 };
+	aga_bool_t* baked;
+	aga_size_t i, j;
+
+	if(!(baked = aga_calloc(len, sizeof(aga_bool_t)))) {
+		py_error_set_nomem();
+		return AGA_TRUE;
+	}
+
+	for(i = 0; i < len; ++i) {
+		struct agan_object* obj = objs[i];
+		const double* mat = &mats[16 * i];
+
+		if(obj->texture != part->texture || !obj->model) continue;
+
+		if(agan_batch_bake(batch, &geom, obj, mat, pack, &baked[i])) {
+			goto cleanup;
+		}
+
+		if(!baked[i]) {
+			const float* min = obj->model->min_extent;
+			const float* max = obj->model->max_extent;
+
+			for(j = 0; j < 8; ++j) {
+				float corner[3];
+				float out[3];
+
+				corner[0] = j & 1 ? max[0] : min[0];
+				corner[1] = j & 2 ? max[1] : min[1];
+				corner[2] = j & 4 ? max[2] : min[2];
+
+				agan_batch_point(batch, mat, corner, out);
+			}
+		}
+	}
+
+	part->name = glGenLists(1);
+	if(aga_script_gl_err("glGenLists")) goto cleanup;
+
+	glNewList(part->name, GL_COMPILE);
+	if(aga_script_gl_err("glNewList")) goto cleanup;
+
+	if(geom.ninds && aga_draw_have_gl11()) {
+		glInterleavedArrays(GL_T2F_N3F_V3F, 0, geom.verts);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glColorPointer(3, GL_UNSIGNED_BYTE, 0, geom.cols);
+
+		glDrawElements(
+				GL_TRIANGLES, (GLsizei) geom.ninds, GL_UNSIGNED_INT,
+				geom.inds);
+
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_NORMAL_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+	}
+	else if(geom.ninds) {
+		glBegin(GL_TRIANGLES);
+
+		for(i = 0; i < geom.ninds; ++i) {
+			aga_uint_t ind = geom.inds[i];
+			const struct aga_model_vertex* v = &geom.verts[ind];
+
+			glColor3ubv(&geom.cols[3 * ind]);
+			glTexCoord2fv(v->uv);
+			glNormal3fv(v->norm);
+			glVertex3fv(v->pos);
+		}
+
+		glEnd();
+	}
+
+	/* Anything we couldn't bake keeps its transform in the list instead. */
+	for(i = 0; i < len; ++i) {
+		struct agan_object* obj = objs[i];
+
+		if(obj->texture != part->texture || !obj->model || baked[i]) {
+			continue;
+		}
+
+		glColor3ub(
+				(obj->ind >> (2 * 8)) & 0xFF, (obj->ind >> (1 * 8)) & 0xFF,
+				(obj->ind >> (0 * 8)) & 0xFF);
+
+		glPushMatrix();
+		glMultMatrixd(&mats[16 * i]);
+		glCallList(obj->model->name);
+		glPopMatrix();
+	}
+
+	glEndList();
+	if(aga_script_gl_err("glEndList")) goto cleanup;
+
+	aga_free(geom.verts);
+	aga_free(geom.cols);
+	aga_free(geom.inds);
+	aga_free(baked);
+
+	return AGA_FALSE;
+
+	cleanup: {
+		aga_free(geom.verts);
+		aga_free(geom.cols);
+		aga_free(geom.inds);
+		aga_free(baked);
+
+		return AGA_TRUE;
+	}
+}
+
+static void agan_batch_delete(struct agan_batch* batch) {
+	aga_size_t i;
+
+	for(i = 0; i < batch->len; ++i) {
+		struct agan_batch_part* part = &batch->parts[i];
+
+		if(part->name) {
+			glDeleteLists(part->name, 1);
+			(void) aga_error_gl(__FILE__, "glDeleteLists");
+		}
+
+		agan_shared_release(agan_shared_textures, part->texture);
+	}
+
+	for(i = 0; i < batch->model_count; ++i) {
+		agan_shared_release(agan_shared_models, batch->models[i]);
+	}
+
+	aga_free(batch->parts);
+	aga_free(batch->models);
+	aga_free(batch);
+}
+
+struct py_object* agan_mkbatch(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	struct aga_resource_pack* pack = AGA_GET_USERDATA(env)->resource_pack;
+
+	struct agan_batch* batch;
+	struct py_object* retval;
+	struct agan_object** objs = 0;
+	double* mats = 0;
+	aga_size_t i, j, len;
 
-	(void) env;
 	(void) self;
 
-	apro_stamp_start(APRO_SCRIPTGLUE_INOBJ);
+	apro_stamp_start(APRO_SCRIPTGLUE_MKBATCH);
 
-	if(!aga_vararg_list(args, PY_TYPE_TUPLE, 4) ||
-		!aga_arg(&objp, args, 0, PY_TYPE_INT) ||
-		!aga_vararg_typed(&pointp, args, 1, PY_TYPE_LIST, 3, PY_TYPE_FLOAT) ||
-		!aga_arg(&planarp, args, 2, PY_TYPE_INT) ||
-		!aga_arg(&dbgp, args, 3, PY_TYPE_INT)) {
+	/* mkbatch(int...) */
+	if(!aga_arg_list(args, PY_TYPE_LIST)) {
+		return aga_arg_error("mkbatch", "int...");
+	}
 
-		if(!aga_vararg_list(args, PY_TYPE_TUPLE, 5) ||
-			!aga_arg(&objp, args, 0, PY_TYPE_INT) ||
-			!aga_vararg_typed(
-					&pointp, args, 1, PY_TYPE_LIST, 3, PY_TYPE_FLOAT) ||
-			!aga_arg(&planarp, args, 2, PY_TYPE_INT) ||
-			!aga_arg(&dbgp, args, 3, PY_TYPE_INT) ||
-			!aga_arg(&tolerancep, args, 4, PY_TYPE_FLOAT)) {
+	len = py_varobject_size(args);
 
-			return aga_arg_error(
-					"inobj", "int, float[3], int, int [and float]");
+	if(!(batch = aga_calloc(1, sizeof(struct agan_batch)))) {
+		return py_error_set_nomem();
+	}
+
+	for(i = 0; i < 3; ++i) {
+		batch->min_extent[i] = 3.4e38f;
+		batch->max_extent[i] = -3.4e38f;
+	}
+
+	if(!(objs = aga_calloc(len + 1, sizeof(struct agan_object*)))) goto oom;
+	if(!(mats = aga_calloc(16 * len + 1, sizeof(double)))) goto oom;
+
+	if(!(batch->parts = aga_calloc(len + 1, sizeof(struct agan_batch_part)))) {
+		goto oom;
+	}
+
+	if(!(batch->models = aga_calloc(len + 1, sizeof(struct agan_shared*)))) {
+		goto oom;
+	}
+
+	for(i = 0; i < len; ++i) {
+		struct py_object* op = py_list_get(args, i);
+
+		if(op->type != PY_TYPE_INT) {
+			py_error_set_badarg();
+			goto cleanup;
 		}
 
-		tolerance = py_float_get(tolerancep);
+		objs[i] = aga_script_pointer_get(op);
+
+		if(objs[i]->light_data) {
+			aga_log(
+					__FILE__,
+					"warn: Object `%s' has a light which won't be batched",
+					objs[i]->modelpath ? objs[i]->modelpath : "<none>");
+		}
+
+		if(agan_batch_matrix(objs[i], &mats[16 * i])) goto cleanup;
+
+		/* The batch outlives its objects so it needs its own references. */
+		if(objs[i]->model) {
+			objs[i]->model->refcount++;
+			batch->models[batch->model_count++] = objs[i]->model;
+		}
 	}
 
-	planar = !!py_int_get(planarp);
+	/* One part per distinct texture, in first-seen order. */
+	for(i = 0; i < len; ++i) {
+		struct agan_batch_part* part;
 
-	obj = aga_script_pointer_get(objp);
-	memcpy(min, obj->min_extent, sizeof(min));
-	memcpy(max, obj->max_extent, sizeof(max));
+		if(!objs[i]->model) continue;
+
+		for(j = 0; j < batch->len; ++j) {
+			if(batch->parts[j].texture == objs[i]->texture) break;
+		}
+
+		if(j < batch->len) continue;
+
+		part = &batch->parts[batch->len++];
+		part->texture = objs[i]->texture;
+		if(part->texture) part->texture->refcount++;
+
+		if(agan_mkbatch_part(batch, part, objs, mats, len, pack)) {
+			goto cleanup;
+		}
+	}
 
-	if(!(pos = py_dict_lookup(obj->transform, "pos"))) return 0;
-	if(!(rot = py_dict_lookup(obj->transform, "rot"))) return 0;
-	if(!(scale = py_dict_lookup(obj->transform, "scale"))) return 0;
+	aga_free(objs);
+	aga_free(mats);
 
-	for(i = 0; i < AGA_LEN(min); ++i) {
-		float f;
+	if(!(retval = aga_script_pointer_new(batch))) {
+		agan_batch_delete(batch);
+		return 0;
+	}
 
-		/* TODO: Static "get N items into buffer" to make noverify easier. */
+	apro_stamp_end(APRO_SCRIPTGLUE_MKBATCH);
 
-		point[i] = py_float_get(py_list_get(pointp, i));
+	return retval;
 
-		f = (float) py_float_get(py_list_get(scale, i));
+	oom: py_error_set_nomem();
+	cleanup: {
+		aga_free(objs);
+		aga_free(mats);
 
-		min[i] *= f;
-		max[i] *= f;
+		agan_batch_delete(batch);
 
-		rotation[i] = py_float_get(py_list_get(rot, i));
+		return 0;
 	}
+}
 
-	/* TODO: This only handles Y-plane rotations. */
-	/* TODO: This doesn't handle lopsided objects correctly. */
+struct py_object* agan_putbatch(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
 
-	/* rot[Y] ~= 90 */
-	/* rot[Y] ~= -90 */
-	if(fabs(fabs(rotation[1]) - 90.0) < AGA_TRANSFORM_TOLERANCE) {
-		AGA_SWAP_FLOAT(min[0], min[2]);
-		AGA_SWAP_FLOAT(max[0], max[2]);
-	}
+	struct agan_batch* batch;
+	aga_size_t i;
 
-	for(i = 0; i < AGA_LEN(min); ++i) {
-		double f = py_float_get(py_list_get(pos, i));
+	(void) env;
+	(void) self;
 
-		min[i] += (float) (f - tolerance);
-		max[i] += (float) (f + tolerance);
+	apro_stamp_start(APRO_SCRIPTGLUE_PUTBATCH);
+
+	if(!aga_arg_list(args, PY_TYPE_INT)) {
+		return aga_arg_error("putbatch", "int");
 	}
 
-	/* TODO: Once cells are implemented check against current cell rad. */
+	batch = aga_script_pointer_get(args);
 
-	if(planar || point[1] > min[1]) {
-		if(point[0] > min[0] && point[2] > min[2]) {
+	for(i = 0; i < batch->len; ++i) {
+		if(agan_bind_texture(batch->parts[i].texture)) return 0;
 
-			if(planar || point[1] < max[1]) {
-				if(point[0] < max[0] && point[2] < max[2]) {
-					retval = PY_TRUE;
-				}
-			}
-		}
+		glCallList(batch->parts[i].name);
+		if(aga_script_gl_err("glCallList")) return 0;
 	}
 
-	/*
-	 * TODO: `glPolygonMode' can provide wireframes if we want a model
-	 * 		 Wireframe rather than a box outline.
-	 */
-	if(py_int_get(dbgp)) {
-		enum aga_draw_flags fl = aga_draw_get();
+	apro_stamp_end(APRO_SCRIPTGLUE_PUTBATCH);
 
-		if(aga_script_err("aga_draw_set", aga_draw_set(AGA_DRAW_NONE))) return 0;
+	return py_object_incref(PY_NONE);
+}
 
-		glLineWidth(1.0f);
-		if(aga_script_gl_err("glLineWidth")) return 0;
+struct py_object* agan_killbatch(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
 
-		glBegin(GL_LINE_STRIP);
-			glColor3f(0.0f, 1.0f, 0.0f);
-			glVertex3f(min[0], max[1], max[2]);
-			glVertex3f(max[0], max[1], max[2]);
-			glVertex3f(min[0], min[1], max[2]);
-			glVertex3f(max[0], min[1], max[2]);
-			glVertex3f(max[0], min[1], min[2]);
-			glVertex3f(max[0], max[1], max[2]);
-			glVertex3f(max[0], max[1], min[2]);
-			glVertex3f(min[0], max[1], max[2]);
-			glVertex3f(min[0], max[1], min[2]);
-			glVertex3f(min[0], min[1], max[2]);
-			glVertex3f(min[0], min[1], min[2]);
-			glVertex3f(max[0], min[1], min[2]);
-			glVertex3f(min[0], max[1], min[2]);
-			glVertex3f(max[0], max[1], min[2]);
-		glEnd();
-		if(aga_script_gl_err("glEnd")) return 0;
+	(void) env;
+	(void) self;
 
-		if(aga_script_err("aga_draw_set", aga_draw_set(fl))) return 0;
+	if(!aga_arg_list(args, PY_TYPE_INT)) {
+		return aga_arg_error("killbatch", "int");
 	}
 
-	apro_stamp_end(APRO_SCRIPTGLUE_INOBJ);
+	agan_batch_delete(aga_script_pointer_get(args));
 
-	return py_object_incref(retval);
+	return py_object_incref(PY_NONE);
 }
 
 /*
- * TODO: Avoid reloading conf for every call. We shouldn't permanently cache
- * 		 The config tree but it would be wise to selectively hold it for a
- * 		 Load/save period.
+ * NOTE: Objects drawn by `agan_putvis' are kept in a BVH over their world
+ * 		 Bounds. The tree's shape is only rebuilt when objects come or go,
+ * 		 Moving objects just get their bounds refit every call -- which can
+ * 		 Leave it a little loose but never wrong.
  */
-enum aga_result agan_getobjconf(
-		struct agan_object* obj, struct aga_config_node* node) {
+#define AGAN_VIS_LEAF (4)
 
-	void* fp;
-	enum aga_result result;
+struct agan_vis_node {
+	float min[3];
+	float max[3];
 
-	result = aga_resource_seek(obj->res, &fp);
-	if(aga_script_err("aga_resource_seek", result)) return 0;
+	/* Leaves have `count' objects from `first', nodes have children. */
+	aga_size_t first;
+	aga_size_t count;
+
+	/* The left child always follows its parent. */
+	aga_size_t right;
+};
+
+static struct agan_vis_node* agan_vis_nodes = 0;
+static aga_size_t agan_vis_node_count = 0;
+
+static struct agan_object** agan_vis_order = 0;
+static aga_size_t agan_vis_order_count = 0;
+
+/* Bakes the transform's rotations into a matrix as `agan_settransmat' does. */
+static void agan_vis_rotation(const double* rot, double* out) {
+	double deg = M_PI / 180.0;
+	double cx = cos(rot[0] * deg), sx = sin(rot[0] * deg);
+	double cy = cos(rot[1] * deg), sy = sin(rot[1] * deg);
+	double cz = cos(rot[2] * deg), sz = sin(rot[2] * deg);
+
+	/* Row-major `Rx * Ry * Rz'. */
+	out[0] = cy * cz;
+	out[1] = -cy * sz;
+	out[2] = sy;
+	out[3] = sx * sy * cz + cx * sz;
+	out[4] = -sx * sy * sz + cx * cz;
+	out[5] = -sx * cy;
+	out[6] = -cx * sy * cz + sx * sz;
+	out[7] = cx * sy * sz + sx * cz;
+	out[8] = cx * cy;
+}
 
-	/*
-	 * TODO: We can't currently set `aga_config_debug_file' to anything sensible
-	 * 		 Here as we don't cache object conf paths in the object
-	 * 		 (Rightfully so).
-	 */
-	result = aga_config_new(fp, obj->res->size, node);
-	if(aga_script_err("aga_config_new", result)) return 0;
+/* Refreshes the object's world bounds if its transform has changed. */
+static aga_bool_t agan_vis_bounds(struct agan_object* obj) {
+	double trans[9];
+	double mat[9];
+	aga_size_t i, j;
 
-	return AGA_RESULT_OK;
-}
+	for(i = 0; i < 3; ++i) {
+		struct py_object* comp;
 
-struct py_object* agan_objconf(
-		struct py_env* env, struct py_object* self, struct py_object* args) {
+		comp = py_dict_lookup(obj->transform, agan_trans_components[i]);
+		if(!comp) {
+			py_error_set_key();
+			return AGA_TRUE;
+		}
 
-	enum aga_result result;
+		for(j = 0; j < 3; ++j) {
+			struct py_object* o = py_list_get(comp, j);
 
-	struct py_object* o;
-	struct py_object* l;
-	struct py_object* retval;
+			if(o->type != PY_TYPE_FLOAT) {
+				py_error_set_badarg();
+				return AGA_TRUE;
+			}
 
-	struct aga_config_node conf;
-	struct agan_object* obj;
+			trans[3 * i + j] = py_float_get(o);
+		}
+	}
 
-	(void) env;
-	(void) self;
+	if(obj->vis_valid && !memcmp(trans, obj->vis_trans, sizeof(trans))) {
+		return AGA_FALSE;
+	}
 
-	apro_stamp_start(APRO_SCRIPTGLUE_OBJCONF);
+	aga_memcpy(obj->vis_trans, trans, sizeof(trans));
+	obj->vis_valid = AGA_TRUE;
 
-	if(!aga_arg_list(args, PY_TYPE_TUPLE) ||
-	   !aga_arg(&o, args, 0, PY_TYPE_INT) ||
-	   !aga_arg(&l, args, 1, PY_TYPE_LIST)) {
+	agan_vis_rotation(&trans[3], mat);
 
-		return aga_arg_error("objconf", "int and list");
-	}
+	/* Transform the box's centre and sum up its rotated half-extents. */
+	for(i = 0; i < 3; ++i) {
+		double centre = trans[i];
+		double extent = 0.0;
 
-	obj = aga_script_pointer_get(o);
+		for(j = 0; j < 3; ++j) {
+			double m = mat[3 * i + j] * trans[6 + j];
+			double c = (obj->max_extent[j] + obj->min_extent[j]) / 2.0;
+			double e = (obj->max_extent[j] - obj->min_extent[j]) / 2.0;
 
-	result = agan_getobjconf(obj, &conf);
-	if(aga_script_err("agan_getobjconf", result)) return 0;
+			centre += m * c;
+			extent += fabs(m) * e;
+		}
 
-	retval = agan_scriptconf(&conf, AGA_TRUE, l);
+		obj->world_min[i] = (float) (centre - extent);
+		obj->world_max[i] = (float) (centre + extent);
+	}
 
-	result = aga_config_delete(&conf);
-	if(aga_script_err("aga_config_delete", result)) return 0;
+	return AGA_FALSE;
+}
 
-	apro_stamp_end(APRO_SCRIPTGLUE_OBJCONF);
+static int agan_vis_axis;
 
-	return retval ? retval : py_object_incref(PY_NONE);
+static int agan_vis_cmp(const void* a, const void* b) {
+	const struct agan_object* oa = *(struct agan_object* const*) a;
+	const struct agan_object* ob = *(struct agan_object* const*) b;
+	float ca = oa->world_min[agan_vis_axis] + oa->world_max[agan_vis_axis];
+	float cb = ob->world_min[agan_vis_axis] + ob->world_max[agan_vis_axis];
+
+	return ca < cb ? -1 : ca > cb;
 }
 
-static aga_bool_t agan_putobj_light(struct agan_lightdata* data) {
-	unsigned ind = GL_LIGHT0 + data->index;
-	float pos[] = { 0.0f, 0.0f, 0.0f, 0.0f };
-	pos[3] = data->directional ? 0.0f : 1.0f;
+/* Median splits on the widest axis of the objects' centres. */
+static aga_size_t agan_vis_build(aga_size_t first, aga_size_t count) {
+	aga_size_t ind = agan_vis_node_count++;
+	struct agan_vis_node* node = &agan_vis_nodes[ind];
+	float lo[3], hi[3];
+	float widest = -1.0f;
+	aga_size_t i, j;
 
-	glEnable(ind);
-	if(aga_script_gl_err("glEnable")) return AGA_TRUE;
+	node->first = first;
+	node->count = count;
 
-	glLightfv(ind, GL_POSITION, pos);
-	if(aga_script_gl_err("glLightfv")) return AGA_TRUE;
+	if(count <= AGAN_VIS_LEAF) return ind;
 
-	glLightfv(ind, GL_AMBIENT, data->ambient);
-	if(aga_script_gl_err("glLightfv")) return AGA_TRUE;
+	for(i = 0; i < 3; ++i) {
+		lo[i] = agan_vis_order[first]->world_min[i];
+		hi[i] = lo[i];
+	}
 
-	glLightfv(ind, GL_DIFFUSE, data->diffuse);
-	if(aga_script_gl_err("glLightfv")) return AGA_TRUE;
+	for(i = first; i < first + count; ++i) {
+		const struct agan_object* obj = agan_vis_order[i];
 
-	glLightfv(ind, GL_SPECULAR, data->specular);
-	if(aga_script_gl_err("glLightfv")) return AGA_TRUE;
+		for(j = 0; j < 3; ++j) {
+			float c = (obj->world_min[j] + obj->world_max[j]) / 2.0f;
 
-	glLightf(ind, GL_CONSTANT_ATTENUATION, data->constant_attenuation);
-	if(aga_script_gl_err("glLightf")) return AGA_TRUE;
+			if(c < lo[j]) lo[j] = c;
+			if(c > hi[j]) hi[j] = c;
+		}
+	}
 
-	glLightf(ind, GL_LINEAR_ATTENUATION, data->linear_attenuation);
-	if(aga_script_gl_err("glLightf")) return AGA_TRUE;
+	for(i = 0; i < 3; ++i) {
+		if(hi[i] - lo[i] > widest) {
+			widest = hi[i] - lo[i];
+			agan_vis_axis = (int) i;
+		}
+	}
 
-	glLightf(ind, GL_QUADRATIC_ATTENUATION, data->quadratic_attenuation);
-	if(aga_script_gl_err("glLightf")) return AGA_TRUE;
+	qsort(
+			&agan_vis_order[first], count, sizeof(struct agan_object*),
+			agan_vis_cmp);
 
-	glLightf(ind, GL_SPOT_EXPONENT, data->exponent);
-	if(aga_script_gl_err("glLightf")) return AGA_TRUE;
+	node->count = 0;
 
-	glLightf(ind, GL_SPOT_CUTOFF, data->angle);
-	if(aga_script_gl_err("glLightf")) return AGA_TRUE;
+	(void) agan_vis_build(first, count / 2);
+	node->right = agan_vis_build(first + count / 2, count - count / 2);
 
-	glLightfv(ind, GL_SPOT_DIRECTION, data->direction);
-	if(aga_script_gl_err("glLightfv")) return AGA_TRUE;
+	return ind;
+}
+
+static aga_bool_t agan_vis_rebuild(void) {
+	struct agan_object* obj;
+	aga_size_t len = 0;
+	aga_size_t sz;
+	void* p;
+
+	/* Either array left as it was on failure still matches its count. */
+	sz = (agan_object_count + 1) * sizeof(void*);
+	if(!(p = aga_realloc(agan_vis_order, sz))) {
+		py_error_set_nomem();
+		return AGA_TRUE;
+	}
+	agan_vis_order = p;
+
+	sz = (2 * agan_object_count + 1) * sizeof(struct agan_vis_node);
+	if(!(p = aga_realloc(agan_vis_nodes, sz))) {
+		py_error_set_nomem();
+		return AGA_TRUE;
+	}
+	agan_vis_nodes = p;
+
+	agan_vis_order_count = 0;
+	agan_vis_node_count = 0;
+
+	/* Lights can't be culled on their bounds so they stay out of the tree. */
+	for(obj = agan_objects; obj; obj = obj->next) {
+		if(obj->model && !obj->light_data) agan_vis_order[len++] = obj;
+	}
+
+	agan_vis_order_count = len;
+
+	if(len) (void) agan_vis_build(0, len);
+
+	agan_vis_dirty = AGA_FALSE;
 
 	return AGA_FALSE;
 }
 
-struct py_object* agan_putobj(
-		struct py_env* env, struct py_object* self, struct py_object* args) {
+/* Children always follow their parents so this can run back to front. */
+static void agan_vis_refit(void) {
+	aga_size_t i, j, k;
 
-	struct agan_object* obj;
+	for(i = agan_vis_node_count; i-- > 0;) {
+		struct agan_vis_node* node = &agan_vis_nodes[i];
 
-	(void) env;
-	(void) self;
+		if(node->count) {
+			const struct agan_object* obj = agan_vis_order[node->first];
 
-	apro_stamp_start(APRO_SCRIPTGLUE_PUTOBJ);
+			aga_memcpy(node->min, obj->world_min, sizeof(node->min));
+			aga_memcpy(node->max, obj->world_max, sizeof(node->max));
 
-	apro_stamp_start(APRO_PUTOBJ_RISING);
+			for(j = node->first + 1; j < node->first + node->count; ++j) {
+				obj = agan_vis_order[j];
 
-	if(!aga_arg_list(args, PY_TYPE_INT)) {
-		return aga_arg_error("putobj", "int");
+				for(k = 0; k < 3; ++k) {
+					if(obj->world_min[k] < node->min[k]) {
+						node->min[k] = obj->world_min[k];
+					}
+
+					if(obj->world_max[k] > node->max[k]) {
+						node->max[k] = obj->world_max[k];
+					}
+				}
+			}
+		}
+		else {
+			const struct agan_vis_node* l = &agan_vis_nodes[i + 1];
+			const struct agan_vis_node* r = &agan_vis_nodes[node->right];
+
+			for(k = 0; k < 3; ++k) {
+				node->min[k] = l->min[k] < r->min[k] ? l->min[k] : r->min[k];
+				node->max[k] = l->max[k] > r->max[k] ? l->max[k] : r->max[k];
+			}
+		}
 	}
+}
 
-	obj = aga_script_pointer_get(args);
+/*
+ * Tests a box against the planes still in `mask' -- planes the box is
+ * Wholly inside of are dropped so children needn't test them again.
+ */
+static aga_bool_t agan_vis_test(
+		double (*planes)[4], const float* min, const float* max,
+		unsigned* mask) {
 
-	glMatrixMode(GL_MODELVIEW);
-	if(aga_script_gl_err("glMatrixMode")) return 0;
-	glPushMatrix();
-	if(aga_script_gl_err("glPushMatrix")) return 0;
-	if(agan_settransmat(obj->transform, AGA_FALSE)) return 0;
+	aga_size_t i, j;
 
-	apro_stamp_end(APRO_PUTOBJ_RISING);
+	for(i = 0; i < 6; ++i) {
+		double d, r;
 
-	apro_stamp_start(APRO_PUTOBJ_LIGHT);
+		if(!(*mask & (1U << i))) continue;
 
-	if(obj->light_data && agan_putobj_light(obj->light_data)) return 0;
+		d = planes[i][3];
+		r = 0.0;
 
-	apro_stamp_end(APRO_PUTOBJ_LIGHT);
+		for(j = 0; j < 3; ++j) {
+			d += planes[i][j] * (min[j] + max[j]) / 2.0;
+			r += fabs(planes[i][j]) * (max[j] - min[j]) / 2.0;
+		}
 
-	apro_stamp_start(APRO_PUTOBJ_CALL);
+		if(d + r < 0.0) return AGA_FALSE;
+		if(d - r >= 0.0) *mask &= ~(1U << i);
+	}
 
-	glCallList(obj->drawlist);
-	if(aga_script_gl_err("glCallList")) return 0;
+	return AGA_TRUE;
+}
 
-	apro_stamp_end(APRO_PUTOBJ_CALL);
+static aga_bool_t agan_vis_draw(
+		double (*planes)[4], aga_size_t ind, unsigned mask,
+		aga_size_t* drawn) {
 
-	apro_stamp_start(APRO_PUTOBJ_FALLING);
+	const struct agan_vis_node* node = &agan_vis_nodes[ind];
+	aga_size_t i;
 
-	glMatrixMode(GL_MODELVIEW);
-	if(aga_script_gl_err("glMatrixMode")) return 0;
-	glPopMatrix();
-	if(aga_script_gl_err("glPopMatrix")) return 0;
+	if(!agan_vis_test(planes, node->min, node->max, &mask)) return AGA_FALSE;
 
-	apro_stamp_end(APRO_PUTOBJ_FALLING);
+	if(!node->count) {
+		if(agan_vis_draw(planes, ind + 1, mask, drawn)) return AGA_TRUE;
 
-	apro_stamp_end(APRO_SCRIPTGLUE_PUTOBJ);
+		return agan_vis_draw(planes, node->right, mask, drawn);
+	}
 
-	return py_object_incref(PY_NONE);
+	for(i = node->first; i < node->first + node->count; ++i) {
+		struct agan_object* obj = agan_vis_order[i];
+		unsigned obj_mask = mask;
+
+		if(!agan_vis_test(planes, obj->world_min, obj->world_max, &obj_mask)) {
+			continue;
+		}
+
+		if(agan_putobj_draw(obj)) return AGA_TRUE;
+
+		++*drawn;
+	}
+
+	return AGA_FALSE;
 }
 
-struct py_object* agan_objtrans(
-		struct py_env* env, struct py_object* self, struct py_object* args) {
+/* Pulls the frustum out of the current camera (see `agan_setcam'). */
+static aga_bool_t agan_vis_frustum(double (*planes)[4]) {
+	double proj[16];
+	double view[16];
+	double clip[16];
+	aga_size_t i, j, k;
 
-	struct agan_object* obj;
+	glGetDoublev(GL_PROJECTION_MATRIX, proj);
+	if(aga_script_gl_err("glGetDoublev")) return AGA_TRUE;
 
-	(void) env;
-	(void) self;
+	glGetDoublev(GL_MODELVIEW_MATRIX, view);
+	if(aga_script_gl_err("glGetDoublev")) return AGA_TRUE;
 
-	apro_stamp_start(APRO_SCRIPTGLUE_OBJTRANS);
+	for(i = 0; i < 4; ++i) {
+		for(j = 0; j < 4; ++j) {
+			clip[4 * i + j] = 0.0;
 
-	if(!aga_arg_list(args, PY_TYPE_INT)) {
-		return aga_arg_error("objtrans", "int");
+			for(k = 0; k < 4; ++k) {
+				clip[4 * i + j] += proj[4 * k + j] * view[4 * i + k];
+			}
+		}
 	}
 
-	obj = aga_script_pointer_get(args);
+	/* Each plane is the last row of the clip matrix plus or minus another. */
+	for(i = 0; i < 6; ++i) {
+		double sign = i & 1 ? -1.0 : 1.0;
 
-	apro_stamp_end(APRO_SCRIPTGLUE_OBJTRANS);
+		for(j = 0; j < 4; ++j) {
+			planes[i][j] = clip[4 * j + 3] + sign * clip[4 * j + i / 2];
+		}
+	}
 
-	return obj->transform;
+	return AGA_FALSE;
 }
 
-struct py_object* agan_objind(
+struct py_object* agan_putvis(
 		struct py_env* env, struct py_object* self, struct py_object* args) {
 
 	struct agan_object* obj;
+	double planes[6][4];
+	aga_size_t drawn = 0;
 
 	(void) env;
 	(void) self;
 
-	apro_stamp_start(APRO_SCRIPTGLUE_OBJTRANS);
+	apro_stamp_start(APRO_SCRIPTGLUE_PUTVIS);
 
-	if(!aga_arg_list(args, PY_TYPE_INT)) {
-		return aga_arg_error("agan_objind", "int");
+	if(args) return aga_arg_error("putvis", "none");
+
+	for(obj = agan_objects; obj; obj = obj->next) {
+		if(agan_vis_bounds(obj)) return 0;
 	}
 
-	obj = aga_script_pointer_get(args);
+	if(agan_vis_dirty && agan_vis_rebuild()) return 0;
 
-	apro_stamp_end(APRO_SCRIPTGLUE_OBJTRANS);
+	/* Lights go first so they apply to everything drawn after them. */
+	for(obj = agan_objects; obj; obj = obj->next) {
+		if(!obj->light_data) continue;
 
-	return py_int_new(obj->ind);
+		if(agan_putobj_draw(obj)) return 0;
+
+		++drawn;
+	}
+
+	if(agan_vis_node_count) {
+		agan_vis_refit();
+
+		if(agan_vis_frustum(planes)) return 0;
+		if(agan_vis_draw(planes, 0, 0x3F, &drawn)) return 0;
+	}
+
+	apro_stamp_end(APRO_SCRIPTGLUE_PUTVIS);
+
+	return py_int_new((py_value_t) drawn);
 }
@@ -7,7 +7,12 @@
 
 #include <aga/startup.h>
 #include <aga/log.h>
+#include <aga/error.h>
+#include <aga/utility.h>
 #include <aga/script.h>
+#include <aga/pack.h>
+#include <aga/loader.h>
+#include <aga/zone.h>
 
 #include <apro.h>
 
@@ -158,3 +163,254 @@ struct py_object* agan_dt(
 
 	return py_int_new(*AGA_GET_USERDATA(env)->dt);
 }
+
+/*
+ * NOTE: References taken by `prefetch' are counted apart from the resource's
+ * 		 Own refcount so `unfetch' can never give up one held by an object or
+ * 		 The zone.
+ */
+struct agan_fetch {
+	struct aga_resource* res;
+
+	aga_size_t held; /* Completed prefetches yet to be unfetched. */
+	aga_size_t pending; /* Prefetches still with the loader. */
+	aga_size_t cancelled; /* Pending ones unfetched too late to withdraw. */
+
+	struct agan_fetch* next;
+};
+
+static struct agan_fetch* agan_fetches = 0;
+
+static struct agan_fetch* agan_fetch_find(struct aga_resource* res) {
+	struct agan_fetch* fetch;
+
+	for(fetch = agan_fetches; fetch; fetch = fetch->next) {
+		if(fetch->res == res) return fetch;
+	}
+
+	return 0;
+}
+
+/* Forgets the record once nothing is held or in flight. */
+static void agan_fetch_tidy(struct agan_fetch* fetch) {
+	struct agan_fetch** p;
+
+	if(fetch->held || fetch->pending) return;
+
+	for(p = &agan_fetches; *p; p = &(*p)->next) {
+		if(*p != fetch) continue;
+
+		*p = fetch->next;
+		aga_free(fetch);
+
+		return;
+	}
+}
+
+static void agan_fetch_done(
+		struct aga_resource* res, enum aga_result result, void* pass) {
+
+	struct agan_fetch* fetch = pass;
+
+	fetch->pending--;
+
+	if(fetch->cancelled) {
+		fetch->cancelled--;
+
+		if(!result) {
+			aga_error_check_soft(
+					__FILE__, "aga_resource_release",
+					aga_resource_release(res));
+		}
+	}
+	else if(!result) fetch->held++;
+	else aga_error_check_soft(__FILE__, "aga_resource_request", result);
+
+	agan_fetch_tidy(fetch);
+}
+
+void agan_dropfetches(void) {
+	while(agan_fetches) {
+		struct agan_fetch* next = agan_fetches->next;
+
+		aga_free(agan_fetches);
+		agan_fetches = next;
+	}
+}
+
+struct py_object* agan_prefetch(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	enum aga_result result;
+	struct aga_resource_pack* pack = AGA_GET_USERDATA(env)->resource_pack;
+	struct aga_resource_loader* loader;
+	struct aga_resource* res;
+	struct agan_fetch* fetch;
+
+	(void) self;
+
+	apro_stamp_start(APRO_SCRIPTGLUE_PREFETCH);
+
+	/* prefetch(string) */
+	if(!aga_arg_list(args, PY_TYPE_STRING)) {
+		return aga_arg_error("prefetch", "string");
+	}
+
+	if(!(loader = AGA_GET_USERDATA(env)->resource_loader)) {
+		aga_script_err("aga_resource_request", AGA_RESULT_BAD_OP);
+		return 0;
+	}
+
+	result = aga_resource_pack_lookup(pack, py_string_get(args), &res);
+	if(aga_script_err("aga_resource_pack_lookup", result)) return 0;
+
+	if(!(fetch = agan_fetch_find(res))) {
+		if(!(fetch = aga_calloc(1, sizeof(struct agan_fetch)))) {
+			return py_error_set_nomem();
+		}
+
+		fetch->res = res;
+		fetch->next = agan_fetches;
+		agan_fetches = fetch;
+	}
+
+	/* Resident resources are called back before this returns. */
+	fetch->pending++;
+
+	result = aga_resource_request(
+			loader, py_string_get(args), agan_fetch_done, fetch);
+	if(result) {
+		fetch->pending--;
+		agan_fetch_tidy(fetch);
+
+		aga_script_err("aga_resource_request", result);
+		return 0;
+	}
+
+	apro_stamp_end(APRO_SCRIPTGLUE_PREFETCH);
+
+	return py_object_incref(PY_NONE);
+}
+
+struct py_object* agan_fetched(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	enum aga_result result;
+	struct aga_resource_pack* pack = AGA_GET_USERDATA(env)->resource_pack;
+	struct aga_resource* res;
+
+	(void) self;
+
+	apro_stamp_start(APRO_SCRIPTGLUE_FETCHED);
+
+	/* fetched(string) */
+	if(!aga_arg_list(args, PY_TYPE_STRING)) {
+		return aga_arg_error("fetched", "string");
+	}
+
+	result = aga_resource_pack_lookup(pack, py_string_get(args), &res);
+	if(aga_script_err("aga_resource_pack_lookup", result)) return 0;
+
+	apro_stamp_end(APRO_SCRIPTGLUE_FETCHED);
+
+	return py_object_incref(res->data ? PY_TRUE : PY_FALSE);
+}
+
+struct py_object* agan_unfetch(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	enum aga_result result;
+	struct aga_resource_pack* pack = AGA_GET_USERDATA(env)->resource_pack;
+	struct aga_resource_loader* loader = AGA_GET_USERDATA(env)->resource_loader;
+	struct aga_resource* res;
+	struct agan_fetch* fetch;
+
+	(void) self;
+
+	apro_stamp_start(APRO_SCRIPTGLUE_UNFETCH);
+
+	/* unfetch(string) */
+	if(!aga_arg_list(args, PY_TYPE_STRING)) {
+		return aga_arg_error("unfetch", "string");
+	}
+
+	result = aga_resource_pack_lookup(pack, py_string_get(args), &res);
+	if(aga_script_err("aga_resource_pack_lookup", result)) return 0;
+
+	if(!(fetch = agan_fetch_find(res))) {
+		aga_script_err("agan_unfetch", AGA_RESULT_BAD_OP);
+		return 0;
+	}
+
+	if(fetch->held) {
+		fetch->held--;
+
+		result = aga_resource_release(res);
+		if(aga_script_err("aga_resource_release", result)) return 0;
+	}
+	else if(loader && fetch->pending > fetch->cancelled) {
+		result = aga_resource_cancel(loader, agan_fetch_done, fetch);
+
+		/* It's with the worker -- let go of it once it lands. */
+		if(result == AGA_RESULT_MISSING_KEY) fetch->cancelled++;
+		else if(aga_script_err("aga_resource_cancel", result)) return 0;
+		else fetch->pending--;
+	}
+	else {
+		aga_script_err("agan_unfetch", AGA_RESULT_BAD_OP);
+		return 0;
+	}
+
+	agan_fetch_tidy(fetch);
+
+	apro_stamp_end(APRO_SCRIPTGLUE_UNFETCH);
+
+	return py_object_incref(PY_NONE);
+}
+
+struct py_object* agan_getcell(
+		struct py_env* env, struct py_object* self, struct py_object* args) {
+
+	enum aga_result result;
+	struct aga_zone* zone = AGA_GET_USERDATA(env)->zone;
+	struct aga_resource_pack_cell* cell;
+	struct py_object* retval;
+	struct py_object* o;
+	float x, z;
+	aga_size_t i;
+
+	(void) self;
+
+	apro_stamp_start(APRO_SCRIPTGLUE_GETCELL);
+
+	/* getcell(float[2]) */
+	if(!aga_vararg_list_typed(args, PY_TYPE_LIST, 2, PY_TYPE_FLOAT)) {
+		return aga_arg_error("getcell", "float[2]");
+	}
+
+	if(!zone) {
+		aga_script_err("aga_zone_cell", AGA_RESULT_BAD_OP);
+		return 0;
+	}
+
+	x = (float) py_float_get(py_list_get(args, 0));
+	z = (float) py_float_get(py_list_get(args, 1));
+
+	result = aga_zone_cell(zone, x, z, &cell);
+	if(result == AGA_RESULT_MISSING_KEY) return py_list_new(0);
+	if(aga_script_err("aga_zone_cell", result)) return 0;
+
+	if(!(retval = py_list_new(cell->count))) return py_error_set_nomem();
+
+	for(i = 0; i < cell->count; ++i) {
+		const char* path = zone->pack->db[cell->first + i].path;
+
+		if(!(o = py_string_new(path))) return py_error_set_nomem();
+
+		py_list_set(retval, i, o);
+	}
+
+	apro_stamp_end(APRO_SCRIPTGLUE_GETCELL);
+
+	return retval;
+}